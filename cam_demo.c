@@ -143,6 +143,7 @@ void example_labeling()
     camLoadPGM(&source,"resources/small_ulp.pgm");
     
     // Label the image
+    camBlobsAllocate(&results,CAM_LABEL_MAX_BLOBS);
     camRLEAllocate(&encoded,10000);
     camRLEEncode(&source,&encoded);
     printf("Number of runs : %d\n",encoded.nbRuns);
@@ -157,6 +158,7 @@ void example_labeling()
     }
 
     camRLEDeallocate(&encoded);
+    camBlobsDeallocate(&results);
     camDeallocateImage(&source);
 }
 
@@ -311,6 +313,7 @@ void example_labeling_benchmark()
     camDilate5x5(&source,&dilated,&mm_params);
     camSavePGM(&dilated,"output/chess_dilated3.pgm");
 
+    camBlobsAllocate(&analysis,CAM_LABEL_MAX_BLOBS);
     camRLEAllocate(&encoded,(source.width*source.height)/4);
     for (i=0;i<128;i++) LUT.t[i]=0;
     for (;i<256;i++) LUT.t[i]=255;
@@ -380,6 +383,7 @@ void example_labeling_benchmark()
     camDeallocateImage(&thresholded);
     camDeallocateImage(&labelled);
     camRLEDeallocate(&encoded);
+    camBlobsDeallocate(&analysis);
 }
 
 // Binary image processing example
@@ -429,6 +433,7 @@ void example_binary()
     camSavePGM(&or,"output/chess_binary_or.pgm");
 
     // Label the image
+    camBlobsAllocate(&results,CAM_LABEL_MAX_BLOBS);
     camRLEAllocate(&encoded,100000);
     camRLEEncode(&dilated,&encoded);
     printf("Number of runs : %d\n",encoded.nbRuns);
@@ -443,6 +448,7 @@ void example_binary()
     }
 
     camRLEDeallocate(&encoded);
+    camBlobsDeallocate(&results);
     camDeallocateImage(&source);
     camDeallocateImage(&binary);
     camDeallocateImage(&dilated);
@@ -667,6 +673,7 @@ void example_watershed2()
     camSavePGM(&watershed,"output/watershed_regions.pgm");
 
     // Labelling
+    camBlobsAllocate(&results,CAM_LABEL_MAX_BLOBS);
     camRLEAllocate(&encoded, 10000);
     camRLEEncode(&watershed,&encoded);
     camRLELabelling(&encoded,&results);
@@ -682,6 +689,7 @@ void example_watershed2()
     }
 
     camRLEDeallocate(&encoded);
+    camBlobsDeallocate(&results);
     
     camFreeTableOfBasins(&tob);
     camDeallocateImage(&source);
@@ -885,6 +893,7 @@ void example_color_labeling()
     camRGB2YUV(&source,&YUV);
 
     // Label the image
+    camBlobsAllocate(&results,CAM_LABEL_MAX_BLOBS);
     camRLEAllocate(&encoded,10000);
     clusters.size=3*6;
     for (i=0;i<3*6;i++) clusters.t[i]=limits[i];
@@ -907,6 +916,7 @@ void example_color_labeling()
     camSaveBMP(&source,"output/alfa156_color_labeling.bmp");
 
     camRLEDeallocate(&encoded);
+    camBlobsDeallocate(&results);
     camDeallocateImage(&source);
     camDeallocateImage(&YUV);
 }
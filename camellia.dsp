@@ -175,6 +175,10 @@ SOURCE=.\src\cam_keypoints_matching.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\cam_keypoints_matching_avx2.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\cam_keypoints_sectors_code.c
 # PROP Exclude_From_Build 1
 # End Source File
@@ -188,6 +192,10 @@ SOURCE=.\src\cam_linear_filtering.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\cam_linear_filtering_avx2.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\cam_linear_filtering_code.c
 # PROP Exclude_From_Build 1
 # End Source File
@@ -219,6 +227,10 @@ SOURCE=.\src\cam_median_filtering.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\cam_median_filtering_avx2.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\cam_median_filtering_code.c
 # PROP Exclude_From_Build 1
 # End Source File
@@ -253,10 +265,27 @@ SOURCE=.\src\cam_morphomaths_code_square3.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\cam_morphomaths_rect.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\cam_morphomaths_rect_code.c
+# PROP Exclude_From_Build 1
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\cam_parallel.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\cam_RLE_labelling.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\cam_RLE_labelling_avx2.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\cam_RLE_labelling_code.c
 # PROP Exclude_From_Build 1
 # End Source File
@@ -289,6 +318,10 @@ SOURCE=.\src\cam_separable_filter_code.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\cam_simd.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\cam_utils.c
 # End Source File
 # Begin Source File
@@ -24,6 +24,14 @@ extern "C" void Init_camcapture();
 %rename("morpho_gradient_square3!") CamImage::morpho_gradient_square3();
 %rename("morpho_gradient_circle5!") CamImage::morpho_gradient_circle5();
 %rename("morpho_gradient_circle7!") CamImage::morpho_gradient_circle7();
+%rename("erode_rect!") CamImage::erode_rect(int width, int height);
+%rename("dilate_rect!") CamImage::dilate_rect(int width, int height);
+%rename("morpho_gradient_rect!") CamImage::morpho_gradient_rect(int width, int height);
+%rename("open_rect!") CamImage::open_rect(int width, int height);
+%rename("close_rect!") CamImage::close_rect(int width, int height);
+%rename("top_hat_rect!") CamImage::top_hat_rect(int width, int height);
+%rename("black_top_hat_rect!") CamImage::black_top_hat_rect(int width, int height);
+%rename("alternating_sequential_filter_rect!") CamImage::alternating_sequential_filter_rect(int order, int closingFirst);
 %rename("morpho_maths!") CamImage::morpho_maths(const CamMorphoMathsKernel &ker);
 %rename("erode_3x3!") CamImage::erode_3x3(const CamMorphoMathsKernel &ker);
 %rename("dilate_3x3!") CamImage::dilate_3x3(const CamMorphoMathsKernel &ker);
@@ -51,6 +59,9 @@ extern "C" void Init_camcapture();
 %rename("sobel_v_abs!") CamImage::sobel_v_abs();
 %rename("sobel_h_abs!") CamImage::sobel_h_abs();
 %rename("fixed_filter!") CamImage::fixed_filter(int filter);
+%rename("median_filter_3x3!") CamImage::median_filter_3x3();
+%rename("median_filter_5x5!") CamImage::median_filter_5x5();
+%rename("median_filter!") CamImage::median_filter(int size);
 %rename("hierarchical_watershed_regions!") CamImage::hierarchical_watershed_regions(const CamTableOfBasins &tob);
 
 %rename("arithm!") CamImage::arithm(int operation, int c1=0, int c2=0, int c3=0);
@@ -73,6 +84,7 @@ extern "C" void Init_camcapture();
 %rename("cam_set_viewer") camSetImageViewer;
 %rename("nb_runs") CamRLEImage::nbRuns;
 %rename("nb_blobs") CamBlobs::nbBlobs;
+%rename("nb_blobs") CamRLELabelingStream::nbBlobs;
 %rename("nb_matches") CamKeypointsMatches::nbMatches;
 %rename("nb_outliers") CamKeypointsMatches::nbOutliers;
 %rename("nb_points") CamKeypoints::nbPoints;
@@ -95,14 +107,21 @@ extern "C" void Init_camcapture();
 %newobject CamImage::encode_threshold_inv;
 %newobject CamImage::encode_threshold_lut;
 %newobject CamImage::labeling;
+%newobject CamImage::labeling_threshold;
+%newobject CamImage::labeling_lut;
 %newobject CamImage::to_yuv;
 %newobject CamImage::to_y;
 %newobject CamImage::to_rgb;
 %newobject CamImage::to_hls;
 %newobject CamImage::integral_image;
+%newobject CamRLEImage::arithm;
 %newobject CamRLEImage::erode_cross;
 %newobject CamRLEImage::erode_3x3;
 %newobject CamRLEImage::erode_3x2;
+%newobject CamRLEImage::erode_rect;
+%newobject CamRLEImage::dilate_rect;
+%newobject CamRLEImage::open_rect;
+%newobject CamRLEImage::close_rect;
 
 // Garbage collection
 %markfunc CamImage "mark_CamImage";
@@ -210,6 +229,11 @@ extern "C" void Init_camcapture();
 #define CAM_CHANNELSEQ_YUV  3
 #define CAM_CHANNELSEQ_BGR  4
 #define CAM_CHANNELSEQ_BGRA 5
+#define CAM_RLE_AND         8
+#define CAM_RLE_OR          14
+#define CAM_RLE_XOR         6
+#define CAM_RLE_ANDNOT      4
+#define CAM_RLE_DIFF        4
 
 %mixin CamTable "Enumerable";
 
@@ -273,12 +297,32 @@ struct CamRLEImage {
     bool decode_blobs(CamImage &dest) const;                        ///< C++ wrapping for CamRLEDecodeBlobs() function            
     bool decode_blobs(CamImage &dest, const CamTable &LUT) const;   ///< C++ wrapping for CamRLEDecodeBlos() function
     bool inverse();                                                 ///< C++ wrapping for CamRLEInverse() function
+    bool arithm(const CamRLEImage &source2, CamRLEImage &dest, int operation) const; ///< C++ wrapping for CamRLEDyadicArithm() function
+    CamRLEImage *arithm(const CamRLEImage &source2, int operation) const;           ///< C++ wrapping for CamRLEDyadicArithm() function
+    int population_count() const;                                   ///< C++ wrapping for CamRLEPopulationCount() function
+    int bounding_box(CamROI &box) const;                            ///< C++ wrapping for CamRLEBoundingBox() function
     bool erode_cross(CamRLEImage &dest) const;                      ///< C++ wrapping for CamRLEErodeCross() function 
     CamRLEImage *erode_cross() const;                               ///< C++ wrapping for CamRLEErodeCross() function 
     bool erode_3x3(CamRLEImage &dest) const;                        ///< C++ wrapping for CamRLEErode3x3() function 
     CamRLEImage *erode_3x3() const;                                 ///< C++ wrapping for CamRLEErode3x3() function 
     bool erode_3x2(CamRLEImage &dest) const;                        ///< C++ wrapping for CamRLEErode3x2() function 
     CamRLEImage *erode_3x2() const;                                 ///< C++ wrapping for CamRLEErode3x2() function 
+    bool erode_rect(CamRLEImage &dest, int width, int height) const;   ///< C++ wrapping for CamRLEErodeRect() function
+    CamRLEImage *erode_rect(int width, int height) const;               ///< C++ wrapping for CamRLEErodeRect() function
+    bool dilate_rect(CamRLEImage &dest, int width, int height) const;   ///< C++ wrapping for CamRLEDilateRect() function
+    CamRLEImage *dilate_rect(int width, int height) const;               ///< C++ wrapping for CamRLEDilateRect() function
+    bool open_rect(CamRLEImage &dest, int width, int height) const;   ///< C++ wrapping for CamRLEOpenRect() function
+    CamRLEImage *open_rect(int width, int height) const;               ///< C++ wrapping for CamRLEOpenRect() function
+    bool close_rect(CamRLEImage &dest, int width, int height) const;   ///< C++ wrapping for CamRLECloseRect() function
+    CamRLEImage *close_rect(int width, int height) const;               ///< C++ wrapping for CamRLECloseRect() function
+};
+
+%extend CamRLEImage {
+    CamRun __getitem__(int n) {
+        if ((n>=0)&&(n<self->nbRuns)) return self->runs[n];
+        else camError("CamRLEImage","Index out of range");
+        return self->runs[0];
+    };
 };
 
 %immutable;
@@ -294,6 +338,14 @@ typedef struct {
     int value;          ///< Blob value, or average pixel value in the original image
     int min;            ///< Minimum pixel value in the original image
     int max;            ///< Maximum pixel value in the original image
+    float mu20;         ///< Second order central moment (variance of x)
+    float mu11;         ///< Second order central moment (covariance of x and y)
+    float mu02;         ///< Second order central moment (variance of y)
+    float orientation;  ///< Angle of the major axis with the x axis, in radians
+    float major;        ///< Major semi-axis of the equivalent ellipse
+    float minor;        ///< Minor semi-axis of the equivalent ellipse
+    int perimeter;      ///< Number of pixel sides on the border of the blob
+    int euler;          ///< Euler number (1 minus the number of holes)
     void *misc;         ///< Additional user-dependant blob information
 } CamBlobInfo;
 
@@ -301,7 +353,14 @@ typedef struct {
 
 struct CamBlobs {
     int nbBlobs;            ///< Number of valid blobs
-    CamBlobs() {nbBlobs=0;} ///< Default constructor
+%mutable;
+    int features;           ///< Optional blob features (CAM_BLOB_MOMENTS)
+%immutable;
+    CamBlobs();             ///< Default constructor
+    CamBlobs(int capacity); ///< Constructor with initial capacity parameter
+    ~CamBlobs();            ///< Default destructor
+    bool reserve(int capacity); ///< C++ wrapping of camBlobsReserve() function
+    int capacity() const;   ///< Number of blobs that can be stored without reallocation
 };
 
 %extend CamBlobs {
@@ -320,6 +379,18 @@ struct CamBlobs {
     };
 };
 
+struct CamRLELabelingStream {
+    int width;              ///< Width of the rows
+    int y;                  ///< Number of rows already labelled
+    int features;           ///< Blob features (CAM_BLOB_MOMENTS)
+    int nbBlobs;            ///< Number of blobs emitted so far
+    CamRLELabelingStream(int width, int features=0); ///< Constructor with rows width and blob features parameters
+    ~CamRLELabelingStream(); ///< Default destructor
+    bool threshold(const CamImage &rows, int threshold, CamBlobs &closed, const CamImage *original=NULL); ///< C++ wrapping for camRLELabelingStreamThreshold() function
+    bool lut(const CamImage &rows, const CamTable &LUT, CamBlobs &closed, const CamImage *original=NULL); ///< C++ wrapping for camRLELabelingStreamLUT() function
+    bool end(CamBlobs &closed); ///< C++ wrapping for camRLELabelingStreamEnd() function
+};
+
 %mixin CamTableOfBasins "Enumerable";
 
 struct CamTableOfBasins
@@ -62,7 +62,8 @@
 #define CAM_PIXEL unsigned char
 #define CAM_SIGNED_PIXEL signed char
 
-// Max image size
+// Max image size processed with stack line buffers
+// (scanline kernels switch to heap allocated line buffers for wider images)
 #define CAM_MAX_SCANLINE 1280
 #define CAM_MAX_FRAME_HEIGHT 1024
 
@@ -75,6 +76,9 @@
 // Big endian architecture?
 //#define CAM_BIG_ENDIAN
 
+// 32 bits run indexes in RLE images (for images taller than 65535 lines, or with more than 65535 runs)?
+//#define CAM_RLE_32BITS
+
 // Generate 8 AND 16 bits pixel size code
 #define CAM_GENERATE_FULL_CODE
 
@@ -206,6 +210,7 @@ typedef struct {
 struct CamLinearFilterKernel;
 struct CamMorphoMathsKernel;
 struct CamRLEImage;
+struct CamBlobs;
 struct CamTable;
 struct CamMeasuresResults;
 struct CamSepFilterKernel;
@@ -333,6 +338,7 @@ typedef struct {
     bool load_bmp(const char *filename);                ///< C++ wrapping for camLoadPGM() function
     bool save_bmp(const char *filename) const;          ///< C++ wrapping for camSavePGM() function
     bool set_roi(const CamROI &roi);                    ///< C++ wrapping for camSetROI() function
+    bool set_border(int mode, int value=0);             ///< Set the mode (<DFN>CAM_BORDER_CONSTANT</DFN> or <DFN>CAM_BORDER_REPLICATE</DFN>) and constant of the four borders
     void get_pixels(char **result, int *len) const;     ///< Fills an char array allocated with C++ operator new. len is filled with the length of the array. Used for mapping Ruby to_s member.
     bool set_pixels(const char *pixels, int sz);        ///< Set pixels of the picture, from a byte array
     void inspect(char **result, int *len) const;        ///< Returns some textual information about the image
@@ -358,6 +364,22 @@ typedef struct {
     int morpho_gradient_circle5(CamImage &dest) const;  ///< C++ wrapping for camMorphoGradientCircle5() function
     int morpho_gradient_circle7();                      ///< C++ wrapping for camMorphoGradientCircle7() function
     int morpho_gradient_circle7(CamImage &dest) const;  ///< C++ wrapping for camMorphoGradientCircle7() function
+    int erode_rect(int width, int height);                                ///< C++ wrapping for camErodeRect() function
+    int erode_rect(CamImage &dest, int width, int height) const;          ///< C++ wrapping for camErodeRect() function
+    int dilate_rect(int width, int height);                               ///< C++ wrapping for camDilateRect() function
+    int dilate_rect(CamImage &dest, int width, int height) const;         ///< C++ wrapping for camDilateRect() function
+    int morpho_gradient_rect(int width, int height);                      ///< C++ wrapping for camMorphoGradientRect() function
+    int morpho_gradient_rect(CamImage &dest, int width, int height) const;///< C++ wrapping for camMorphoGradientRect() function
+    int open_rect(int width, int height);                                 ///< C++ wrapping for camOpenRect() function
+    int open_rect(CamImage &dest, int width, int height) const;           ///< C++ wrapping for camOpenRect() function
+    int close_rect(int width, int height);                                ///< C++ wrapping for camCloseRect() function
+    int close_rect(CamImage &dest, int width, int height) const;          ///< C++ wrapping for camCloseRect() function
+    int top_hat_rect(int width, int height);                              ///< C++ wrapping for camTopHatRect() function
+    int top_hat_rect(CamImage &dest, int width, int height) const;        ///< C++ wrapping for camTopHatRect() function
+    int black_top_hat_rect(int width, int height);                        ///< C++ wrapping for camBlackTopHatRect() function
+    int black_top_hat_rect(CamImage &dest, int width, int height) const;  ///< C++ wrapping for camBlackTopHatRect() function
+    int alternating_sequential_filter_rect(int order, int closingFirst=0);                          ///< C++ wrapping for camAlternatingSequentialFilterRect() function
+    int alternating_sequential_filter_rect(CamImage &dest, int order, int closingFirst=0) const;    ///< C++ wrapping for camAlternatingSequentialFilterRect() function
 
     int morpho_maths(const CamMorphoMathsKernel &ker);                                  ///< C++ wrapping for camMorphoMaths() function
     int morpho_maths(CamImage &dest, const CamMorphoMathsKernel &ker) const;            ///< C++ wrapping for camMorphoMaths() function
@@ -404,6 +426,12 @@ typedef struct {
     int sep_filter_abs_7x7(CamImage &dest, const CamSepFilterKernel &k) const;          ///< C++ wrapping for camSepFilterAbs7x7() function
     bool fixed_filter(CamImage &dest, int filter) const;                                ///< C++ wrapping for camFixedFilter() function
     bool fixed_filter(int filter);                                                      ///< C++ wrapping for camFixedFilter() function
+    bool median_filter_3x3(CamImage &dest) const;                                       ///< C++ wrapping for camMedianFilter3x3() function
+    bool median_filter_3x3();                                                           ///< C++ wrapping for camMedianFilter3x3() function
+    bool median_filter_5x5(CamImage &dest) const;                                       ///< C++ wrapping for camMedianFilter5x5() function
+    bool median_filter_5x5();                                                           ///< C++ wrapping for camMedianFilter5x5() function
+    bool median_filter(CamImage &dest, int size) const;                                 ///< C++ wrapping for camMedianFilterNxN() function
+    bool median_filter(int size);                                                       ///< C++ wrapping for camMedianFilterNxN() function
 
     bool draw_line(int x1, int y1, int x2, int y2, int color);                          ///< C++ wrapping for camDrawLine() function
     bool accumulate_line(int x1, int y1, int x2, int y2, int acc);                      ///< C++ wrapping for camAccumulateLine() function
@@ -440,6 +468,12 @@ typedef struct {
     bool encode_lut(CamRLEImage& dest, const CamTable &LUT)  const;                     ///< C++ wrapping for camRLEEncodeLUT() function
     bool encode_threshold(CamRLEImage& dest, int threshold) const;                      ///< C++ wrapping for camRLEEncodeThreshold() function
     bool encode_threshold_inv(CamRLEImage& dest, int threshold) const;                  ///< C++ wrapping for camRLEEncodeThresholdInv() function
+    CamBlobs* labeling_threshold(int threshold, const CamImage *original=NULL) const;   ///< C++ wrapping for camRLELabelingThreshold() function
+    CamBlobs* labeling_lut(const CamTable &LUT, const CamImage *original=NULL) const;   ///< C++ wrapping for camRLELabelingLUT() function
+    bool labeling_threshold(CamBlobs &results, int threshold, const CamImage *original=NULL) const; ///< C++ wrapping for camRLELabelingThreshold() function
+    bool labeling_lut(CamBlobs &results, const CamTable &LUT, const CamImage *original=NULL) const; ///< C++ wrapping for camRLELabelingLUT() function
+    CamBlobs* labeling(CamImage *dest=NULL, int connectivity=4, const CamImage *original=NULL) const; ///< C++ wrapping for camLabelingUnionFind() function
+    bool labeling(CamBlobs &results, CamImage *dest=NULL, int connectivity=4, const CamImage *original=NULL) const; ///< C++ wrapping for camLabelingUnionFind() function
 
     int threshold(CamImage &dest,int threshold) const;                                  ///< C++ wrapping for camThreshold() function
     int threshold_inv(CamImage &dest,int threshold) const;                              ///< C++ wrapping for camThresholdInv() function
@@ -962,6 +996,121 @@ int camErodeSquare3(CamImage *source, CamImage *dest); ///< Erosion (3x3 square
  *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
  */
 int camDilateSquare3(CamImage *source, CamImage *dest); ///< Dilation (3x3 square structural element)
+
+/** Computes the eroded image of a source image, using a rectangular structural
+ *  element of any size (horizontal or vertical lines are 1-pixel high or wide rectangles).
+ *  Uses the van Herk/Gil-Werman algorithm : the processing time doesn't depend on the size
+ *  of the structural element.
+ *
+ *  \param source   The source ::CamImage to process. Must be a grey-level image (8 or 16 bits) or a binary image (CAM_DEPTH_1U).
+ *  \param dest	    The destination ::CamImage. Must be of the same kind as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return Sum (Accumulator) of all computed pixels
+ *
+ *  The structural element is centered on the pixel (for even sizes, the pixel is at width/2, height/2).
+ *  Binary images are processed 64 pixels at a time (shifts and ANDs of whole bit blocks), and the
+ *  accumulator is then the number of pixels set. Masks are not supported on binary images.
+ *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
+ */
+int camErodeRect(CamImage *source, CamImage *dest, int width, int height); ///< Erosion (rectangular structural element)
+
+/** Computes the dilated image of a source image, using a rectangular structural
+ *  element of any size. Constant time per pixel (van Herk/Gil-Werman algorithm).
+ *
+ *  \param source   The source ::CamImage to process. Must be a grey-level image (8 or 16 bits) or a binary image (CAM_DEPTH_1U).
+ *  \param dest	    The destination ::CamImage. Must be of the same kind as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return Sum (Accumulator) of all computed pixels
+ *
+ *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
+ */
+int camDilateRect(CamImage *source, CamImage *dest, int width, int height); ///< Dilation (rectangular structural element)
+
+/** Computes the morphological gradient (dilation minus erosion) of an image, using a rectangular structural
+ *  element of any size. Constant time per pixel (van Herk/Gil-Werman algorithm).
+ *
+ *  \param source   The source ::CamImage to process. Must be a grey-level image (8 or 16 bits) or a binary image (CAM_DEPTH_1U).
+ *  \param dest	    The destination ::CamImage. Must be of the same kind as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return Sum (Accumulator) of all computed pixels
+ *
+ *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
+ */
+int camMorphoGradientRect(CamImage *source, CamImage *dest, int width, int height); ///< Morphological gradient computation (rectangular structural element)
+
+/** Computes the opening (erosion followed by dilation) of an image, using a rectangular structural
+ *  element of any size. Constant time per pixel (van Herk/Gil-Werman algorithm).
+ *
+ *  \param source   The source ::CamImage to process. Must be a grey-level image (8 or 16 bits) or a binary image (CAM_DEPTH_1U).
+ *  \param dest	    The destination ::CamImage. Must be of the same kind as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return Sum (Accumulator) of all computed pixels
+ *
+ *  The erosion is computed on the pixels around the ROI that are needed by the dilation, line
+ *  by line, as the dilation needs them : no intermediate image is written.
+ *  Out of the frame, the eroded image follows the border settings of the source image.
+ *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
+ */
+int camOpenRect(CamImage *source, CamImage *dest, int width, int height); ///< Opening (rectangular structural element)
+
+/** Computes the closing (dilation followed by erosion) of an image, using a rectangular structural
+ *  element of any size. Constant time per pixel (van Herk/Gil-Werman algorithm).
+ *
+ *  \param source   The source ::CamImage to process. Must be a grey-level image (8 or 16 bits) or a binary image (CAM_DEPTH_1U).
+ *  \param dest	    The destination ::CamImage. Must be of the same kind as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return Sum (Accumulator) of all computed pixels
+ *
+ *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
+ */
+int camCloseRect(CamImage *source, CamImage *dest, int width, int height); ///< Closing (rectangular structural element)
+
+/** Computes the white top-hat (source minus its opening) of an image, using a rectangular structural
+ *  element of any size. Keeps the bright details smaller than the structural element.
+ *
+ *  \param source   The source ::CamImage to process. Must be a grey-level image (8 or 16 bits) or a binary image (CAM_DEPTH_1U).
+ *  \param dest	    The destination ::CamImage. Must be of the same kind as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return Sum (Accumulator) of all computed pixels
+ *
+ *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
+ */
+int camTopHatRect(CamImage *source, CamImage *dest, int width, int height); ///< White top-hat (rectangular structural element)
+
+/** Computes the black top-hat (closing minus source) of an image, using a rectangular structural
+ *  element of any size. Keeps the dark details smaller than the structural element.
+ *
+ *  \param source   The source ::CamImage to process. Must be a grey-level image (8 or 16 bits) or a binary image (CAM_DEPTH_1U).
+ *  \param dest	    The destination ::CamImage. Must be of the same kind as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return Sum (Accumulator) of all computed pixels
+ *
+ *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
+ */
+int camBlackTopHatRect(CamImage *source, CamImage *dest, int width, int height); ///< Black top-hat (rectangular structural element)
+
+/** Computes the alternating sequential filter of an image : openings and closings by squares of
+ *  increasing size (3x3, 5x5, ... up to (2*order+1)x(2*order+1)).
+ *
+ *  All the openings and closings are run as one pipeline : each pass computes its lines on demand
+ *  from the previous one, so that no intermediate image is written.
+ *
+ *  \param source   The source ::CamImage to process. Must be a grey-level image (8 or 16 bits) or a binary image (CAM_DEPTH_1U).
+ *  \param dest	    The destination ::CamImage. Must be of the same kind as the source.
+ *  \param order    The number of opening/closing steps
+ *  \param closingFirst 0 to start each step with the opening (removes the bright details first), 1 to start with the closing
+ *  \return Sum (Accumulator) of all computed pixels
+ *
+ *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
+ */
+int camAlternatingSequentialFilterRect(CamImage *source, CamImage *dest, int order, int closingFirst); ///< Alternating sequential filter (square structural elements)
 //@}
 
 /* Labeling kernel
@@ -971,7 +1120,9 @@ int camDilateSquare3(CamImage *source, CamImage *dest); ///< Dilation (3x3 squar
 #define camLabelling2ndScan camLabeling2ndScan
 #define camRLELabelling camRLELabeling
 
-#define CAM_LABEL_MAX_BLOBS 1024
+#define CAM_LABEL_MAX_BLOBS 1024 ///< Initial capacity of a ::CamBlobs structure when it is grown automatically
+#define CAM_LABEL_MAX_LABELS 65536 ///< Max number of labels of pixel-based labeling (label images are 16 bits deep)
+#define CAM_BLOB_MOMENTS 1 ///< Blob feature : second order moments, equivalent ellipse, perimeter and Euler number (see ::CamBlobs)
 #define CAM_LABEL_PIXEL unsigned short
 
 #define CAM_LABEL_PIXEL_ACCESS(ptr,y,x) \
@@ -980,7 +1131,7 @@ int camDilateSquare3(CamImage *source, CamImage *dest); ///< Dilation (3x3 squar
 /// Data structure containing the result of pixel-based labeling.
 typedef struct {
     int nbLabels;		    ///< Number of labels found in the frame
-    int equiv[CAM_LABEL_MAX_BLOBS]; ///< Labels equivalence table (see D3.1 for details)
+    int equiv[CAM_LABEL_MAX_LABELS]; ///< Labels equivalence table (see D3.1 for details)
 } CamLabelingResults;
 
 /// 4-connectedness labeling function
@@ -990,7 +1141,8 @@ typedef struct {
  *  \param source   The source ::CamImage to process. Must be a grey-level image.
  *  \param dest	    The destination ::CamImage..Must be 16-bits deep (its the label result image)
  *  \param results  The ::CamLabelingResults containing the label equivalence table, to provide to a blob analysis function.
- *  \return	    0 (false) if an error occurs
+ *  \return	    0 (false) if an error occurs, especially if the number of labels
+ *		    exceeds the <DFN>CAM_LABEL_MAX_LABELS</DFN> constant.
  *
  *  Note that this function is rather obsolete. This pixel-based labeling algorithm is
  *  outdated compared to RLE-based labeling. 
@@ -1011,15 +1163,22 @@ int camLabeling2ndScan(CamImage *image, CamLabelingResults *results); ///< Secon
 #endif // SWIG
 
 #define CAM_RLE_INT_TYPE unsigned short
+#ifdef CAM_RLE_32BITS
+#define CAM_RLE_INDEX_TYPE unsigned int
+#else
+#define CAM_RLE_INDEX_TYPE unsigned short
+#endif
+#define CAM_RLE_MAX_INDEX ((CAM_RLE_INDEX_TYPE)-1) ///< Max number of runs and lines of an RLE image (excluded)
 
 /// The CamRun structure, basic element of a Run-Length Encoding (RLE) of an image.
-/** sizeof(CamRun) is 8 (64 bits)
+/** sizeof(CamRun) is 8 (64 bits), or 12 with CAM_RLE_32BITS compilation option.
+ *  Runs length are always 16 bits : the images must be less than 65536 pixels wide.
  */
 typedef struct {
     CAM_RLE_INT_TYPE value;	///< Which color(s) this run represents
     CAM_RLE_INT_TYPE length;    ///< The length of the run (in pixels)
-    CAM_RLE_INT_TYPE blob;	///< Run's parent in the connected components tree, which becomes the blob number after labeling
-    CAM_RLE_INT_TYPE line;	///< The line to which the run belongs
+    CAM_RLE_INDEX_TYPE blob;	///< Run's parent in the connected components tree, which becomes the blob number after labeling
+    CAM_RLE_INDEX_TYPE line;	///< The line to which the run belongs
 } CamRun;
 
 #ifndef SWIG
@@ -1037,6 +1196,14 @@ typedef struct {
     int value;	        ///< Blob value, or average pixel value in the original image
     int min;		///< Minimum pixel value in the original image
     int max;		///< Maximum pixel value in the original image
+    float mu20;		///< Second order central moment (variance of x). Only with <DFN>CAM_BLOB_MOMENTS</DFN>
+    float mu11;		///< Second order central moment (covariance of x and y). Only with <DFN>CAM_BLOB_MOMENTS</DFN>
+    float mu02;		///< Second order central moment (variance of y). Only with <DFN>CAM_BLOB_MOMENTS</DFN>
+    float orientation;	///< Angle of the major axis with the x axis, in radians, within [-pi/2,pi/2] (y axis pointing down). Only with <DFN>CAM_BLOB_MOMENTS</DFN>
+    float major;	///< Major semi-axis of the ellipse having the same second order moments. Only with <DFN>CAM_BLOB_MOMENTS</DFN>
+    float minor;	///< Minor semi-axis of the ellipse having the same second order moments. Only with <DFN>CAM_BLOB_MOMENTS</DFN>
+    int perimeter;	///< Number of pixel sides on the border of the blob, holes included. Only with <DFN>CAM_BLOB_MOMENTS</DFN>
+    int euler;		///< Euler number : 1 minus the number of holes of the blob. Only with <DFN>CAM_BLOB_MOMENTS</DFN>
     CamRun *first;	///< First run of the blob (only for RLE labeling)
     CamRun *last;	///< Last run of the blob (only for RLE labeling)
     void *misc;		///< Additional user-dependant blob information
@@ -1045,21 +1212,82 @@ typedef struct {
 #define CamBlobAnalysisResults CamBlobs // For compatibility with previous versions
 
 #ifdef __cplusplus
-/// The result of any blob analysis. Essentially an array of ::CamBlobInfo
+/// The result of any blob analysis. Essentially a growable array of ::CamBlobInfo
 struct CamBlobs {
+#else
+/// The result of any blob analysis. Essentially a growable array of ::CamBlobInfo
+typedef struct {
+#endif
     int nbBlobs;	                        ///< Number of valid blobs
-    CamBlobInfo blobInfo[CAM_LABEL_MAX_BLOBS];  ///< Array of information on the blobs
-    CamBlobs() {nbBlobs=0;}                     ///< Default constructor
+    int allocated;	                        ///< Number of blobs allocated
+    CamBlobInfo *blobInfo;                      ///< Array of information on the blobs
+    int features;                               ///< Optional blob features computed by the RLE blob analysis (<DFN>CAM_BLOB_MOMENTS</DFN>). 0 by default
+    void *scratch;                              ///< Working memory of the blob analysis functions, kept from one call to the next
+    int scratchSize;                            ///< Size of <DFN>scratch</DFN>, in bytes
+
+#ifdef __cplusplus
+    CamBlobs() {nbBlobs=0; allocated=0; blobInfo=NULL; features=0; scratch=NULL; scratchSize=0;} ///< Default constructor
+    CamBlobs(int capacity);                     ///< Constructor with initial capacity parameter
+    CamBlobs(const CamBlobs &blobs);            ///< Copy constructor
+    ~CamBlobs();                                ///< Default destructor
+
+    CamBlobs& operator=(const CamBlobs &blobs); ///< Operator= redefinition
     CamBlobInfo& operator[](int index);
+    bool reserve(int capacity);                 ///< C++ wrapping of camBlobsReserve() function
+    int capacity() const {return allocated;}    ///< Number of blobs that can be stored without reallocation
 };
 #else
-/// The result of any blob analysis. Essentially an array of ::CamBlobInfo
-typedef struct {
-    int nbBlobs;	                        ///< Number of valid blobs
-    CamBlobInfo blobInfo[CAM_LABEL_MAX_BLOBS];  ///< Array of information on the blobs
 } CamBlobs;
 #endif
 
+/// Blobs allocation.
+/** Allocates a ::CamBlobs structure able to store <DFN>capacity</DFN> blobs.
+ *
+ *  The blob analysis functions grow the array on demand (doubling its capacity),
+ *  so that there is no limit on the number of blobs found in a frame. The memory
+ *  is kept from one call to the next : reusing the same ::CamBlobs structure
+ *  across frames avoids any allocation once the capacity is large enough.
+ *
+ *  In C, a ::CamBlobs structure must either be allocated with this function or
+ *  be zero-initialized before being passed to a blob analysis function.
+ *
+ *  \param blobs    The ::CamBlobs to allocate.
+ *  \param capacity The number of blobs to allocate.
+ *  \return	    0 (false) if an error occurs.
+ *
+ *  The <DFN>features</DFN> member is reset to 0 : set it to <DFN>CAM_BLOB_MOMENTS</DFN>
+ *  after the allocation to get the second order moments, the equivalent ellipse, the perimeter
+ *  and the Euler number of the blobs. These are computed on the runs, in the same pass
+ *  as the other measures, by camRLEBlobAnalysis() (and thus camRLELabeling()),
+ *  camRLELabelingThreshold() and camRLELabelingLUT().
+ *
+ *  The blob analysis functions keep their working memory in the structure, so that analysing
+ *  frame after frame with the same ::CamBlobs doesn't allocate memory anymore.
+ *
+ *  The structure should be deallocated using the camBlobsDeallocate() function.
+ */
+int camBlobsAllocate(CamBlobs *blobs, int capacity);
+
+/// Blobs capacity reservation.
+/** Makes sure that <DFN>blobs</DFN> can store at least <DFN>capacity</DFN> blobs,
+ *  keeping its current content. Never shrinks the array.
+ *
+ *  \param blobs    The ::CamBlobs to grow.
+ *  \param capacity The required number of blobs.
+ *  \return	    0 (false) if an error occurs.
+ *
+ *  Note that this function uses the standard C <DFN>realloc()</DFN> function.
+ */
+int camBlobsReserve(CamBlobs *blobs, int capacity);
+
+/// Blobs deallocation.
+/** Releases the memory of a ::CamBlobs structure (including the working memory of the blob analysis).
+ *
+ *  \param blobs    The ::CamBlobs to deallocate.
+ *  \return	    0 (false) if an error occurs.
+ */
+int camBlobsDeallocate(CamBlobs *blobs);
+
 /** Computes the most important blob information :
  *  <DFN>top</DFN>, <DFN>left</DFN>, <DFN>width</DFN>, <DFN>height</DFN>, <DFN>cx</DFN>, <DFN>cy</DFN>,
  *  and <DFN>surface</DFN>. <DFN>average</DFN>, <DFN>min</DFN> and <DFN>max</DFN> 
@@ -1070,7 +1298,7 @@ typedef struct {
  *  \param info	     The ::CamLabelingResults structure provided by the former call to camLabeling().(in data)
  *  \param results   The ::CamBlobs structure that is filled with the collected blob information.
  *		    
- *  \return	    0 (false) if an error occurs, especially if the number of blobs is too high.(more than the <DFN>CAM_LABEL_MAX_BLOBS</DFN> constant)
+ *  \return	    0 (false) if an error occurs.
  *
  *  In-place processing (<DFN>blobImage</DFN> will be affected).
  */
@@ -1088,6 +1316,35 @@ int camBlobAnalysis1stScan(CamImage *blobImage, CamImage *original, CamLabelingR
  */
 int camBlobAnalysisRefinement(CamImage *blobImage, CamImage *original, CamBlobs *results);
 
+/// Union-find pixel labeling and blob analysis. 4- or 8-connectedness.
+/** Finds the connected components of identical non-zero pixels of the source image,
+ *  and computes their <DFN>left</DFN>, <DFN>top</DFN>, <DFN>width</DFN>, <DFN>height</DFN>,
+ *  <DFN>surface</DFN>, <DFN>cx</DFN>, <DFN>cy</DFN>, <DFN>value</DFN>, <DFN>min</DFN> and <DFN>max</DFN>,
+ *  in a single scan of the image. The pixels are processed by runs of identical values,
+ *  which are connected to the runs of the previous line using a union-find forest with
+ *  path compression : there is no limit on the number of labels.
+ *
+ *  The blobs are numbered in the order of their first pixel (in raster order).
+ *  With more than one thread (see camSetNumThreads()), the lines are split into horizontal strips
+ *  that are labelled in parallel, and merged afterwards. The result does not depend on the number of threads.
+ *
+ *  This function replaces camLabeling() and camBlobAnalysis1stScan(), and is much faster. Unlike them,
+ *  it doesn't label the background (zero pixels).
+ *
+ *  \param source   The source ::CamImage to process. Must be a 8 or 16 bits grey-level image (or have a channel of interest).
+ *  \param dest	    The destination label image, 32 bits deep (<DFN>CAM_DEPTH_32S</DFN>). The pixels of blob <I>i</I>
+ *		    are set to <I>i+1</I>, and the background to 0. Can be NULL if only the blobs are needed.
+ *  \param connectivity 4 or 8.
+ *  \param original The original ::CamImage, on which <DFN>value</DFN> (average), <DFN>min</DFN> and <DFN>max</DFN> are measured.
+ *		    Can be NULL : <DFN>value</DFN>, <DFN>min</DFN> and <DFN>max</DFN> are then the value of the source pixels of the blob.
+ *  \param results  The ::CamBlobs structure that is filled with the blobs information.
+ *		    The <DFN>CAM_BLOB_MOMENTS</DFN> feature is not supported, and <DFN>features</DFN> is reset to 0.
+ *  \return	    0 (false) if an error occurs.
+ *
+ *  \sa camRLELabeling
+ */
+int camLabelingUnionFind(CamImage *source, CamImage *dest, int connectivity, CamImage *original, CamBlobs *results);
+
 /* RLE Labeling kernel
  * New : v1.4 of LLAs
  * Updated v1.6 and v1.9, v2.0 of LLAs
@@ -1138,12 +1395,24 @@ typedef struct {
     bool decode_blobs(CamImage &dest) const;                        ///< C++ wrapping for camRLEDecodeBlobs() function            
     bool decode_blobs(CamImage &dest, const CamTable &LUT) const;   ///< C++ wrapping for camRLEDecodeBlos() function
     bool inverse();                                                 ///< C++ wrapping for camRLEInverse() function
+    bool arithm(const CamRLEImage &source2, CamRLEImage &dest, int operation) const; ///< C++ wrapping for camRLEDyadicArithm() function
+    CamRLEImage *arithm(const CamRLEImage &source2, int operation) const;           ///< C++ wrapping for camRLEDyadicArithm() function
+    int population_count() const;                                   ///< C++ wrapping for camRLEPopulationCount() function
+    int bounding_box(CamROI &box) const;                            ///< C++ wrapping for camRLEBoundingBox() function
     bool erode_cross(CamRLEImage &dest) const;                      ///< C++ wrapping for camRLEErodeCross() function 
     CamRLEImage *erode_cross() const;                               ///< C++ wrapping for camRLEErodeCross() function 
     bool erode_3x3(CamRLEImage &dest) const;                        ///< C++ wrapping for camRLEErode3x3() function 
     CamRLEImage *erode_3x3() const;                                 ///< C++ wrapping for camRLEErode3x3() function 
     bool erode_3x2(CamRLEImage &dest) const;                        ///< C++ wrapping for camRLEErode3x2() function 
     CamRLEImage *erode_3x2() const;                                 ///< C++ wrapping for camRLEErode3x2() function 
+    bool erode_rect(CamRLEImage &dest, int width, int height) const;   ///< C++ wrapping for camRLEErodeRect() function
+    CamRLEImage *erode_rect(int width, int height) const;               ///< C++ wrapping for camRLEErodeRect() function
+    bool dilate_rect(CamRLEImage &dest, int width, int height) const;   ///< C++ wrapping for camRLEDilateRect() function
+    CamRLEImage *dilate_rect(int width, int height) const;               ///< C++ wrapping for camRLEDilateRect() function
+    bool open_rect(CamRLEImage &dest, int width, int height) const;   ///< C++ wrapping for camRLEOpenRect() function
+    CamRLEImage *open_rect(int width, int height) const;               ///< C++ wrapping for camRLEOpenRect() function
+    bool close_rect(CamRLEImage &dest, int width, int height) const;   ///< C++ wrapping for camRLECloseRect() function
+    CamRLEImage *close_rect(int width, int height) const;               ///< C++ wrapping for camRLECloseRect() function
 };
 #else
 } CamRLEImage;
@@ -1269,8 +1538,16 @@ int camRLEEncodeColor(CamImage *source, CamRLEImage *dest, CamTable *clusters);
  *		    since it doesn't require neither an additional label image nor an equivalence
  *		    table, everything being stored in the ::CamRLEImage structure.
  *  \param results  The ::CamBlobs containing the results of the blob analysis.
- *  \return	    0 (false) if an error occurs. Generally when the number
- *		    of blobs exceeds the <DFN>CAM_LABEL_MAX_BLOBS</DFN> constant.
+ *  \return	    0 (false) if an error occurs. <DFN>results</DFN> is grown
+ *		    as needed (see camBlobsAllocate()).
+ *
+ * The number of runs and the height of the image must be less than <DFN>CAM_RLE_MAX_INDEX</DFN>
+ * (65535, unless the library is compiled with the <DFN>CAM_RLE_32BITS</DFN> option).
+ *
+ * With more than one thread (see camSetNumThreads()), the lines are split into horizontal strips
+ * that are labelled in parallel, the blobs crossing the strips boundaries being merged afterwards.
+ * The results (including the blobs numbering) are the same as the serial ones.
+ * The labeling is always serial when the <DFN>CAM_BLOB_MOMENTS</DFN> feature is requested.
  *
  * This code is based on the ideas developped in the CMVision library by CMU.
  *
@@ -1292,11 +1569,121 @@ int camRLELabeling(CamRLEImage *src, CamBlobs *results);
  *
  *  \param src	    The source ::CamRLEImage, already labelled.
  *  \param results  The ::CamBlobs containing the results of the blob analysis.
- *  \return	    0 (false) if an error occurs. Generally when the number
- *		    of blobs exceeds the <DFN>CAM_LABEL_MAX_BLOBS</DFN> constant.
+ *  \return	    0 (false) if an error occurs. <DFN>results</DFN> is grown
+ *		    as needed (see camBlobsAllocate()).
  */
 int camRLEBlobAnalysis(CamRLEImage *src, CamBlobs *results);
 
+/// Single-pass threshold, labeling and blob analysis
+/** Same blobs as camRLEEncodeThreshold() followed by camRLELabeling(), but the
+ *  image is scanned only once, and only the runs of two lines are kept in memory.
+ *  The blobs are numbered in the same order as with camRLELabeling(), with the same
+ *  <DFN>left</DFN>, <DFN>top</DFN>, <DFN>width</DFN>, <DFN>height</DFN>, <DFN>surface</DFN>,
+ *  <DFN>cx</DFN> and <DFN>cy</DFN> (and moments, with the <DFN>CAM_BLOB_MOMENTS</DFN> feature).
+ *  If <DFN>original</DFN> is given, <DFN>value</DFN>, <DFN>min</DFN> and <DFN>max</DFN> are
+ *  the ones computed by camRLEBlobMeasures() on each blob.
+ *
+ *  As no ::CamRLEImage is produced, the <DFN>first</DFN> and <DFN>last</DFN>
+ *  members of the blobs are set to NULL.
+ *
+ *  \param source   The source ::CamImage (8 or 16 bits, 1 channel or COI).
+ *  \param threshold The threshold : pixels greater or equal to <DFN>threshold</DFN> belong to the blobs.
+ *  \param original The image (with the same ROI size as <DFN>source</DFN>) on which
+ *		    the average, min and max values of the blobs are measured. May be NULL,
+ *		    in which case <DFN>value</DFN> is set to 1 and <DFN>min</DFN> and <DFN>max</DFN> to 0.
+ *  \param results  The ::CamBlobs containing the results of the blob analysis.
+ *  \return	    0 (false) if an error occurs. <DFN>results</DFN> is grown
+ *		    as needed (see camBlobsAllocate()).
+ */
+int camRLELabelingThreshold(CamImage *source, int threshold, CamImage *original, CamBlobs *results);
+
+/// Single-pass LUT, labeling and blob analysis
+/** Same as camRLELabelingThreshold(), the runs being built on the
+ *  values of <DFN>LUT</DFN> (0 being the background), as with camRLEEncodeLUT().
+ *  If <DFN>original</DFN> is NULL, the <DFN>value</DFN> member of the blobs is the LUT value.
+ *
+ *  \param source   The source ::CamImage (8 or 16 bits, 1 channel or COI).
+ *  \param LUT	    The look-up-table applied to the pixels of <DFN>source</DFN>.
+ *  \param original The image on which the average, min and max values of the blobs are measured. May be NULL.
+ *  \param results  The ::CamBlobs containing the results of the blob analysis.
+ *  \return	    0 (false) if an error occurs.
+ */
+int camRLELabelingLUT(CamImage *source, CamTable *LUT, CamImage *original, CamBlobs *results);
+
+#ifdef __cplusplus
+/// Incremental RLE labeling, for images delivered by chunks of rows (line-scan cameras)
+struct CamRLELabelingStream {
+#else
+/// Incremental RLE labeling, for images delivered by chunks of rows (line-scan cameras)
+typedef struct {
+#endif
+    int width;		///< Width of the rows
+    int y;		///< Number of rows already labelled
+    int features;	///< Blob features (<DFN>CAM_BLOB_MOMENTS</DFN>)
+    int nbBlobs;	///< Number of blobs emitted so far
+    void *state;	///< Internal state : runs of the last row, and open blobs
+
+#ifdef __cplusplus
+    CamRLELabelingStream() {width=0; y=0; features=0; nbBlobs=0; state=NULL;} ///< Default constructor
+    CamRLELabelingStream(int width, int features=0); ///< Constructor with rows width and blob features parameters
+    ~CamRLELabelingStream();	///< Default destructor
+    bool threshold(const CamImage &rows, int threshold, CamBlobs &closed, const CamImage *original=NULL); ///< C++ wrapping for camRLELabelingStreamThreshold() function
+    bool lut(const CamImage &rows, const CamTable &LUT, CamBlobs &closed, const CamImage *original=NULL); ///< C++ wrapping for camRLELabelingStreamLUT() function
+    bool end(CamBlobs &closed);	///< C++ wrapping for camRLELabelingStreamEnd() function
+};
+#else
+} CamRLELabelingStream;
+#endif
+
+/// Incremental labeling allocation
+/** Allocates the internal state of an incremental labeling, for rows of <DFN>width</DFN> pixels.
+ *  The memory used only depends on <DFN>width</DFN>, not on the height of the image.
+ *
+ *  \param stream   The ::CamRLELabelingStream to allocate.
+ *  \param width    The width of the rows.
+ *  \param features The blob features to compute (0 or <DFN>CAM_BLOB_MOMENTS</DFN>).
+ *  \return	    0 (false) if an error occurs.
+ */
+int camRLELabelingStreamAllocate(CamRLELabelingStream *stream, int width, int features);
+
+/// Incremental labeling deallocation
+int camRLELabelingStreamDeallocate(CamRLELabelingStream *stream);
+
+/// Incremental threshold, labeling and blob analysis
+/** Labels the next rows of an image, as camRLELabelingThreshold() does for a whole image.
+ *  Only the runs of the last row and the open blobs (i.e. having runs on the last row)
+ *  are kept from one call to the next. A blob is emitted as soon as it is closed,
+ *  that is to say after the first row on which it has no run.
+ *
+ *  The blobs are numbered in the order they are emitted (<DFN>id</DFN> member). Their
+ *  coordinates are relative to the first row of the image. The <DFN>first</DFN> and
+ *  <DFN>last</DFN> members are set to NULL.
+ *
+ *  \param stream   The ::CamRLELabelingStream (see camRLELabelingStreamAllocate()).
+ *  \param rows     The next rows of the image (8 or 16 bits, 1 channel or COI). Its ROI width must be <DFN>stream->width</DFN>.
+ *  \param threshold The threshold : pixels greater or equal to <DFN>threshold</DFN> belong to the blobs.
+ *  \param original The original rows, on which the average, min and max values of the blobs are measured.
+ *		    May be NULL, but then must be so for all the rows of the image.
+ *  \param closed   The ::CamBlobs receiving the blobs closed by these rows.
+ *  \return	    0 (false) if an error occurs.
+ */
+int camRLELabelingStreamThreshold(CamRLELabelingStream *stream, CamImage *rows, int threshold, CamImage *original, CamBlobs *closed);
+
+/// Incremental LUT, labeling and blob analysis
+/** Same as camRLELabelingStreamThreshold(), the runs being built on the values of <DFN>LUT</DFN>,
+ *  as with camRLELabelingLUT().
+ */
+int camRLELabelingStreamLUT(CamRLELabelingStream *stream, CamImage *rows, CamTable *LUT, CamImage *original, CamBlobs *closed);
+
+/// Incremental labeling end
+/** Closes the image : all the open blobs are emitted. The stream is then ready for the next image.
+ *
+ *  \param stream   The ::CamRLELabelingStream.
+ *  \param closed   The ::CamBlobs receiving the blobs that were still open.
+ *  \return	    0 (false) if an error occurs.
+ */
+int camRLELabelingStreamEnd(CamRLELabelingStream *stream, CamBlobs *closed);
+
 /// The RLE "Apply a LUT" function
 /** Very useful to post-process a RLE image. This function join runs when needed.
  *
@@ -1345,6 +1732,39 @@ int camRLEDecodeBlobs(CamRLEImage *src, CamImage *dest, CamTable *LUT);
  */
 int camRLEInverse(CamRLEImage *image);
 
+#define CAM_RLE_AND	8   ///< Pixels set in both images
+#define CAM_RLE_OR	14  ///< Pixels set in one of the images
+#define CAM_RLE_XOR	6   ///< Pixels set in only one of the images
+#define CAM_RLE_ANDNOT	4   ///< Pixels set in the first image but not in the second one
+#define CAM_RLE_DIFF	4   ///< Same as CAM_RLE_ANDNOT
+
+/// Boolean operation between two RLE images
+/** The images are processed as binary images (all the non-zero runs are foreground), and
+ *  the result is made of runs of value 1 (foreground) and 0. The run lists are merged
+ *  directly, in linear time in the number of runs.
+ *
+ *  \param source1  The first source ::CamRLEImage.
+ *  \param source2  The second source ::CamRLEImage. Must have the same size as the first one.
+ *  \param dest     The destination ::CamRLEImage. Can be one of the sources.
+ *  \param operation The boolean operation :
+ *  - <DFN>CAM_RLE_AND</DFN> : <I>pdest=psource1 and psource2</I>.
+ *  - <DFN>CAM_RLE_OR</DFN> : <I>pdest=psource1 or psource2</I>.
+ *  - <DFN>CAM_RLE_XOR</DFN> : <I>pdest=psource1 xor psource2</I>.
+ *  - <DFN>CAM_RLE_ANDNOT</DFN> (or <DFN>CAM_RLE_DIFF</DFN>) : <I>pdest=psource1 and not(psource2)</I>.
+ *  \return	    0 (false) if an error occurs.
+ */
+int camRLEDyadicArithm(CamRLEImage *source1, CamRLEImage *source2, CamRLEImage *dest, int operation);
+
+/// Number of pixels set (non-zero runs) in an RLE image
+int camRLEPopulationCount(CamRLEImage *image);
+
+/// Bounding box of the pixels set (non-zero runs) in an RLE image
+/** \param image    The source ::CamRLEImage.
+ *  \param box      The bounding box. Its width and height are 0 if no pixel is set. Can be NULL.
+ *  \return	    The number of pixels set.
+ */
+int camRLEBoundingBox(CamRLEImage *image, CamROI *box);
+
 /// RLE blob sides reconstruction
 int camRLEBlobSides(CamBlobInfo *blob, int *left, int *top, int *right, int *bottom);
 
@@ -1352,6 +1772,13 @@ int camRLEBlobSides(CamBlobInfo *blob, int *left, int *top, int *right, int *bot
 int camRLEBlobROIIntersect(CamBlobInfo *blob, CamROI *roi);
 
 /// Retrieves the average, min and max values
+/** Measures the <DFN>value</DFN> (average), <DFN>min</DFN> and <DFN>max</DFN> members of a blob
+ *  labelled by camRLELabeling(), on the runs of the blob.
+ *
+ *  \param blob     The blob (its <DFN>first</DFN> and <DFN>last</DFN> runs must be set).
+ *  \param original The measured image (8 or 16 bits, 1 channel), with the same ROI size as the encoded image.
+ *  \return	    0 (false) if an error occurs.
+ */
 int camRLEBlobMeasures(CamBlobInfo *blob, CamImage *original);
 
 /// RLE image erosion (cross structural element)
@@ -1378,6 +1805,60 @@ int camRLEErode3x3(CamRLEImage *image, CamRLEImage *result);
  */
 int camRLEErode3x2(CamRLEImage *image, CamRLEImage *result);
 
+/// RLE image erosion (rectangular structural element)
+/** The image is processed as a binary image (all the non-zero runs are foreground), and the
+ *  result is made of runs of value 1 (foreground) and 0. The anchor of the structural element is
+ *  at (width/2,height/2), like in camErodeRect(). The pixels out of the image are ignored.
+ *  The complexity is linear in the number of runs and in log2(height), not in the size of the
+ *  structural element.
+ *
+ *  \param image    The source ::CamRLEImage.
+ *  \param result   The destination ::CamRLEImage. Can be the same as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return	    0 (false) if an error occurs.
+ */
+int camRLEErodeRect(CamRLEImage *image, CamRLEImage *result, int width, int height);
+
+/// RLE image dilation (rectangular structural element)
+/** The image is processed as a binary image (all the non-zero runs are foreground), and the
+ *  result is made of runs of value 1 (foreground) and 0. The anchor of the structural element is
+ *  at (width/2,height/2), like in camDilateRect(). The pixels out of the image are ignored.
+ *
+ *  \param image    The source ::CamRLEImage.
+ *  \param result   The destination ::CamRLEImage. Can be the same as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return	    0 (false) if an error occurs.
+ */
+int camRLEDilateRect(CamRLEImage *image, CamRLEImage *result, int width, int height);
+
+/// RLE image opening (rectangular structural element)
+/** The image is processed as a binary image (all the non-zero runs are foreground), and the
+ *  result is made of runs of value 1 (foreground) and 0. Erosion followed by a dilation
+ *  with the reflected structural element, like camOpenRect().
+ *
+ *  \param image    The source ::CamRLEImage.
+ *  \param result   The destination ::CamRLEImage. Can be the same as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return	    0 (false) if an error occurs.
+ */
+int camRLEOpenRect(CamRLEImage *image, CamRLEImage *result, int width, int height);
+
+/// RLE image closing (rectangular structural element)
+/** The image is processed as a binary image (all the non-zero runs are foreground), and the
+ *  result is made of runs of value 1 (foreground) and 0. Dilation followed by an erosion
+ *  with the reflected structural element, like camCloseRect().
+ *
+ *  \param image    The source ::CamRLEImage.
+ *  \param result   The destination ::CamRLEImage. Can be the same as the source.
+ *  \param width    The width of the structural element
+ *  \param height   The height of the structural element
+ *  \return	    0 (false) if an error occurs.
+ */
+int camRLECloseRect(CamRLEImage *image, CamRLEImage *result, int width, int height);
+
 //@}
 
 /** @name Histogram computation
@@ -1967,6 +2448,20 @@ int camMedianFilter3x3(CamImage *source, CamImage *dest);
  *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
  */
 int camMedianFilter5x5(CamImage *source, CamImage *dest);
+
+/// NxN Median Filtering function
+/** For each NxN set of pixels, keep the median value. The running time doesn't depend
+ *  on the size of the neighbourhood (constant-time algorithm, based on column histograms),
+ *  so that large neighbourhoods (9x9 to 15x15) can be used on full frames.
+ *
+ *  \param source   The source ::CamImage to process. Grey scale, 8 bits only.
+ *  \param dest	    The destination ::CamImage (8 bits)
+ *  \param size     The size of the neighbourhood (odd number, from 3 to 255)
+ *  \return 0 (false) if an error occurs
+ *
+ *  Note that this function supports in-place processing (i.e. dest can be the same as source param)
+ */
+int camMedianFilterNxN(CamImage *source, CamImage *dest, int size);
 //@}
 
 /** @name Watersheding kernel
@@ -2182,6 +2677,8 @@ typedef struct {
 
 #ifdef __cplusplus
 struct CamKeypointsKdTree;
+struct CamKeypointsDatabase;
+struct CamKeypointsIndex;
 
 #ifdef SWIG
     %mutable;
@@ -2202,8 +2699,12 @@ typedef struct _CamKeypoints {
     int nbPoints;	            ///< Number of valid points
     CamKeypoint **keypoint; ///< Array of keypoints
     CamKeypoint *bag;	    ///< Bag of keypoints
+    int qdepth;		    ///< Depth of the quantized descriptors (0 if none, CAM_DEPTH_8U or CAM_DEPTH_16S)
+    int qsize;		    ///< Number of elements of each quantized descriptor (padded to a multiple of 32)
+    int qnbPoints;	    ///< Number of quantized descriptors
+    void *qdescriptors;	    ///< Quantized descriptors (one row of qsize elements per keypoint)
 #ifdef __cplusplus
-    CamKeypoints() {allocated = 0; nbPoints = 0; keypoint = NULL; bag = NULL; cx = 0; cy = 0;} ///< Default constructor
+    CamKeypoints() {allocated = 0; nbPoints = 0; keypoint = NULL; bag = NULL; cx = 0; cy = 0; qdepth = 0; qsize = 0; qnbPoints = 0; qdescriptors = NULL;} ///< Default constructor
     CamKeypoints(int nbPoints);			///< Constructor with max number of points
 #ifndef SWIG
     CamKeypoint& operator[](int index);
@@ -2216,6 +2717,9 @@ typedef struct _CamKeypoints {
     int matching(const CamKeypoints **models, int nbModels, CamKeypointsMatches &matches) const;  ///< C++ wrapping for camKeypointsMatching() function
     int matching2(const CamKeypoints &points, CamKeypointsMatches &matches) const;		  ///< C++ wrapping for camKeypointsMatching2() function
     int matchingKdTree(const CamKeypointsKdTree &kdTree, CamKeypointsMatches &matches, int explore = 100) const; ///< C++ wrapping for camKeypointsMatchingKdTree() function 
+    int matchingDatabase(const CamKeypointsDatabase &db, CamKeypointsMatches &matches) const; ///< C++ wrapping for camKeypointsMatchingDatabase() function
+    int matchingIndex(const CamKeypointsIndex &index, CamKeypointsMatches &matches, int checks = 128) const; ///< C++ wrapping for camKeypointsMatchingIndex() function
+    bool quantize(int depth = CAM_DEPTH_8U);		///< C++ wrapping for camKeypointsQuantize() function
 
     bool alloc(int nbPoints);                           ///< Allocator (C++ wrapping of camKeypointsAllocate() function)
     bool realloc(int nbPoints);                         ///< Reallocator (C++ wrapping of camKeypointsReallocate() function)
@@ -2224,6 +2728,32 @@ typedef struct _CamKeypoints {
 } CamKeypoints;
 #endif
 
+#ifdef __cplusplus
+/// The CamKeypointsDatabase structure : the descriptors of a set of models, stored in one matrix
+struct CamKeypointsDatabase {
+#else
+/// The CamKeypointsDatabase structure : the descriptors of a set of models, stored in one matrix
+typedef struct {
+#endif
+    int nbPoints;	    ///< Number of keypoints (rows of the descriptors matrix)
+    int size;		    ///< Number of elements of each row (padded to a multiple of 32)
+    int depth;		    ///< Depth of the descriptors (CAM_DEPTH_8U, CAM_DEPTH_16S or CAM_DEPTH_32S)
+    void *descriptors;	    ///< Descriptors matrix (64-byte aligned)
+    CamKeypoint **keypoint; ///< Keypoint of each row (position, scale, angle, etc.)
+    int *id;		    ///< Id of the model of each row
+    void *buffer;	    ///< Internal use only
+    void *file;		    ///< Mapped file (see camKeypointsMapDatabase()). Internal use only
+#ifdef __cplusplus
+    CamKeypointsDatabase(const CamKeypoints **models = NULL, int nbModels = 0, int depth = CAM_DEPTH_8U); ///< Constructor (C++ wrapping for camKeypointsCompileDatabase() function)
+    ~CamKeypointsDatabase();							///< Default destructor
+    bool compile(const CamKeypoints **models, int nbModels, int depth = CAM_DEPTH_8U);	///< C++ wrapping for camKeypointsCompileDatabase() function
+    bool save(const char *filename, const CamKeypointsIndex *index = NULL) const;	///< C++ wrapping for camKeypointsSaveDatabase() function
+    bool map(const char *filename, CamKeypointsIndex *index = NULL);		///< C++ wrapping for camKeypointsMapDatabase() function
+};
+#else
+} CamKeypointsDatabase;
+#endif
+
 #define CAM_UPRIGHT 1
 
 int camKeypointsSetParameters(int patchSize, int sigma, int threshGradient);
@@ -2239,6 +2769,22 @@ int camReallocateKeypoints(CamKeypoints *fpoints, int nbPoints);
 /// Keypoints release 
 int camFreeKeypoints(CamKeypoints *fpoints);
 
+/// Compact copy of the keypoints descriptors, used by the matching functions
+/** The descriptors are divided by a constant step (2^14 for 8-bit descriptors, 2^8 for 16-bit descriptors)
+ *  and saturated, and stored contiguously in the \a qdescriptors field of the set (one row of \a qsize elements per keypoint).
+ *  This divides by 8 (8-bit) or 4 (16-bit) the memory read when matching against this set.
+ *  Once quantized, a set of keypoints is compared to the targets with its quantized descriptors
+ *  by camFindKeypoint(), camKeypointsMatching(), camKeypointsMatching2() and camFindKeypointKdTree().
+ *  The targets are quantized on the fly, and the distances are scaled back to the range of the original descriptors.
+ *  The quantized descriptors are ignored once the number of keypoints of the set changes, and they must be computed again
+ *  whenever the keypoints change.
+ *
+ *  \param points The set of keypoints (typically a model)
+ *  \param depth CAM_DEPTH_8U or CAM_DEPTH_16S. 0 releases the quantized descriptors.
+ *  \return 0 (false) if an error occurs
+ */
+int camKeypointsQuantize(CamKeypoints *points, int depth);
+
 /// Draw kepoints on screen
 int camDrawKeypoints(CamKeypoints *points, CamImage *dest, int color);
 
@@ -2278,9 +2824,45 @@ int camAllocateKeypointsMatches(CamKeypointsMatches *matches, int nbpairs);
 void camFreeKeypointsMatches(CamKeypointsMatches *matches);
 
 /// Find an object in a database (brute force matching)
+/** Each target keypoint is matched with its nearest model keypoint, unless the second nearest one is almost as close.
+ *  The model (id) with most matches wins. The target keypoints are spread over the worker threads (see camSetNumThreads()),
+ *  and neither the number of target keypoints nor the ids of the models are limited.
+ *
+ *  \return The id of the best model. \a matches receives the matches with this model
+ *  (among the first matches found, if there are more than \a matches->allocated).
+ */
 int camKeypointsMatching(CamKeypoints *target, CamKeypoints **models, int nbModels, CamKeypointsMatches *matches);
 int camKeypointsMatching2(CamKeypoints *points1, CamKeypoints *points2, CamKeypointsMatches *matches);
 
+/// Keypoints database compilation
+/** The descriptors of the models are copied (CAM_DEPTH_32S) or quantized (CAM_DEPTH_8U, CAM_DEPTH_16S, see camKeypointsQuantize())
+ *  into one contiguous matrix, apart from the keypoints themselves. The matching functions scan this matrix by tiles,
+ *  so that each tile of model descriptors is compared to several target keypoints while it is in the cache.
+ *
+ *  \param db The database to compile. It must be zeroed or hold a database compiled before, which is released first.
+ *  The new one must be freed by camFreeKeypointsDatabase().
+ *  \param models The models. Their keypoints must not be released before the database.
+ *  \param nbModels The number of models
+ *  \param depth CAM_DEPTH_8U, CAM_DEPTH_16S or CAM_DEPTH_32S (no loss of precision)
+ *  \return 0 (false) if an error occurs
+ */
+int camKeypointsCompileDatabase(CamKeypointsDatabase *db, CamKeypoints **models, int nbModels, int depth);
+
+/// Keypoints database release
+int camFreeKeypointsDatabase(CamKeypointsDatabase *db);
+
+/// Nearest and second nearest rows of a database for each target keypoint
+/** \param best Index of the nearest row (-1 if the database is empty), for each target keypoint
+ *  \param dist1 Distance to the nearest row
+ *  \param dist2 Distance to the second nearest row (-1 if there is none)
+ */
+int camKeypointsDatabaseNearest(CamKeypoints *target, CamKeypointsDatabase *db, int *best, int *dist1, int *dist2);
+
+/// Find an object in a database (brute force matching, with a compiled database)
+/** Same results as camKeypointsMatching(), with the descriptors of the database.
+ */
+int camKeypointsMatchingDatabase(CamKeypoints *target, CamKeypointsDatabase *db, CamKeypointsMatches *matches);
+
 /// Find the affine transform from one object to the next
 int camFindAffineTransform(CamKeypointsMatches *matches, CamAffineTransform *t, int *error);
 int camFindAffineTransform2(CamKeypointsMatches *matches, CamAffineTransform *t, int *error);
@@ -2315,6 +2897,94 @@ struct CamKeypointsKdTree {
 };
 #endif // __cplusplus
 
+/// A node of a randomized kd-tree (see CamKeypointsIndex)
+typedef struct {
+    int i;	///< Dimension of the cut, or minus the number of rows of a leaf
+    int m;	///< Value of the cut, or first row of a leaf in CamKeypointsIndex::rows
+    int right;	///< Right child (the left child is the next node)
+} CamKeypointsIndexNode;
+
+#ifdef __cplusplus
+/// The CamKeypointsIndex structure : randomized kd-trees over a keypoints database
+struct CamKeypointsIndex {
+#else
+/// The CamKeypointsIndex structure : randomized kd-trees over a keypoints database
+typedef struct {
+#endif // __cplusplus
+    int nbTrees;		///< Number of kd-trees
+    int nbNodes;		///< Number of nodes of all the trees
+    CamKeypointsIndexNode *nodes; ///< The nodes of the trees, one tree after the other (with indexes instead of pointers, so that they can be saved)
+    int *trees;			///< Root of each tree (index in nodes)
+    int *rows;			///< Rows of the database held by the leaves
+    CamKeypointsDatabase *db;	///< The indexed database
+    void *buffer;		///< Internal use only
+#ifdef __cplusplus
+    CamKeypointsIndex(const CamKeypointsDatabase *db = NULL, int nbTrees = 4); ///< Constructor (C++ wrapping for camKeypointsCompileIndex() function)
+    ~CamKeypointsIndex();						    ///< Default destructor
+    bool compile(const CamKeypointsDatabase &db, int nbTrees = 4);	    ///< C++ wrapping for camKeypointsCompileIndex() function
+    CamKeypoint *find(const CamKeypoint *point, int checks = 128, int *dist1 = NULL, int *dist2 = NULL) const; ///< C++ wrapping for camFindKeypointIndex() function
+};
+#else
+} CamKeypointsIndex;
+#endif
+
+#ifndef SWIG
+/// Randomized kd-trees index compilation
+/** Several kd-trees are built on the rows of a compiled database. Each node splits its rows on the mean of a dimension
+ *  picked at random among the 5 ones with the largest variance, so that the trees complement each other,
+ *  down to leaves of 16 rows at most.
+ *  The trees are searched together, with one priority queue : the nearest branches of all the trees are explored first.
+ *  More trees give a better recall for the same number of checks, but need more memory (and compilation time).
+ *
+ *  \param index The index to compile (it must be freed by camFreeKeypointsIndex())
+ *  \param db The database. It must not be released before the index.
+ *  \param nbTrees The number of trees, up to 64 (4 is a good choice)
+ *  \return 0 (false) if an error occurs
+ */
+int camKeypointsCompileIndex(CamKeypointsIndex *index, CamKeypointsDatabase *db, int nbTrees);
+
+/// Randomized kd-trees index release
+int camFreeKeypointsIndex(CamKeypointsIndex *index);
+
+/// Nearest keypoint in a randomized kd-trees index
+/** \param checks The number of database rows compared to the point (whole leaves are compared, so a few more may be).
+ *  This tunes the recall against the time : the search is exact when \a checks is the number of rows of the database.
+ *  \param dist1 Distance to the nearest keypoint found (same distances as camKeypointsDatabaseNearest())
+ *  \param dist2 Distance to the second nearest keypoint found (-1 if there is none)
+ *  \return The nearest keypoint found (NULL if the index is empty)
+ */
+CamKeypoint *camFindKeypointIndex(CamKeypoint *point, CamKeypointsIndex *index, int checks, int *dist1, int *dist2);
+
+/// Find an object in a database (approximate matching, with a randomized kd-trees index)
+/** Same as camKeypointsMatchingDatabase(), but each target keypoint is compared to \a checks rows of the database only.
+ */
+int camKeypointsMatchingIndex(CamKeypoints *target, CamKeypointsIndex *index, CamKeypointsMatches *matches, int checks);
+
+/// Keypoints database saving
+/** The database (keypoints, descriptors and ids of the models), and optionally its index, are saved in a versioned binary file,
+ *  with the same layout as in memory, so that it can be loaded by camKeypointsMapDatabase() without any parsing.
+ *  The file can only be loaded on the same kind of platform (byte order and size of pointers).
+ *
+ *  \param index The index of the database (NULL if none)
+ *  \return 0 (false) if an error occurs
+ */
+int camKeypointsSaveDatabase(CamKeypointsDatabase *db, CamKeypointsIndex *index, const char *filename);
+
+/// Keypoints database mapping
+/** The file saved by camKeypointsSaveDatabase() is mapped in memory (read-only) and used as it is. Only the array of the
+ *  keypoints pointers is allocated, so that loading takes a few milliseconds, and the processes mapping the same file share
+ *  its pages. The keypoints of a mapped database belong to no set (their set is NULL) : the ids of their models are in \a db->id.
+ *
+ *  The header of the file is checked (all the sections must lie in the file), but not the contents of the sections, which are
+ *  used as they are : the file must be trusted (i.e. written by camKeypointsSaveDatabase()).
+ *
+ *  \param db The database. It must be freed by camFreeKeypointsDatabase(), which unmaps the file.
+ *  \param index The index, mapped as well (NULL if not needed). It must be freed before the database.
+ *  \return 0 (false) if an error occurs (missing file, incompatible version or platform, no index in the file)
+ */
+int camKeypointsMapDatabase(CamKeypointsDatabase *db, CamKeypointsIndex *index, const char *filename);
+#endif // SWIG
+
 //@}
 
 /** @name Utility functions
@@ -2547,8 +3217,61 @@ public:
 void camError(char *module, char *error);
 typedef void (*camErrorFunct)(char *,char*);
 void camSetErrorFunct(camErrorFunct funct);
+
+#endif // SWIG
+
+/* Multi-threading
+ */
+#define CAM_MAX_THREADS 64
+
+/// Set the number of threads used by the library
+/** By default, the library runs serially (1 thread). With more than 1 thread, the image kernels
+ *  (arithmetic, LUT, color conversion, linear, separable, median and morphological filters, integral image)
+ *  split their region of interest into horizontal bands that are processed by a pool of worker threads,
+ *  RLE labeling processes horizontal strips in parallel,
+ *  the keypoints detector processes its scales and descriptors in parallel,
+ *  and the keypoints matching functions (camKeypointsMatching(), camKeypointsMatching2(), camKeypointsMatchingKdTree(),
+ *  camKeypointsMatchingDatabase() and camKeypointsMatchingIndex()) spread the target keypoints over the threads.
+ *  The results are strictly identical to the serial ones.
+ *
+ *  The pool is shared by the whole library : a kernel called while the pool is busy (e.g. by another
+ *  application thread) runs serially, so that the cores are never oversubscribed.
+ *  This function can be called at any time, from any thread : the kernels already running keep the number
+ *  of threads they started with, and the new value is used by the next ones.
+ *
+ *  \param nbThreads The number of threads (including the calling thread). Capped to \ref CAM_MAX_THREADS.
+ *  \return The number of threads actually set
+ */
+int camSetNumThreads(int nbThreads);
+/// Returns the number of threads used by the library
+int camGetNumThreads();
+
+/* SIMD code paths
+ */
+#define CAM_CPU_AVX2 1
+
+/// Set the instruction sets used by the library
+/** By default, the library uses all the instruction set extensions supported by the processor, as detected at run time.
+ *  The AVX2 code path covers the 3x3 and 5x5 linear filters (camLinearFilter3x3(), camLinearFilterAbs3x3(),
+ *  camLinearFilter5x5(), camLinearFilterAbs5x5()) of unsigned 8-bit images, and the separable filters
+ *  (camSepFilter3x3() to camSepFilterAbs7x7(), camFixedFilter(), camSobelH(), camScharrV(), etc.) of 8-bit images,
+ *  to 8-bit or 16-bit images. Separable kernels are processed with 16-bit intermediate results, provided that
+ *  the sum of the absolute values of the horizontal coefficients is at most 128.
+ *  It also covers the RLE encoders (camRLEEncode(), camRLEEncodeLUT(), camRLEEncodeThreshold() and
+ *  camRLEEncodeThresholdInv()) of 8-bit and 16-bit images, which find the transitions 32 pixels at once,
+ *  and the distances between quantized keypoints descriptors (see camKeypointsQuantize()).
+ *  The results are strictly identical to the ones of the C code.
+ *
+ *  \param features A combination of CAM_CPU_* flags. 0 forces the C code.
+ *  \return The instruction sets actually enabled (\a features restricted to the ones supported by the processor)
+ */
+int camSetCPUFeatures(int features);
+/// Returns the instruction sets used by the library
+int camGetCPUFeatures();
 //@}
 
+#ifndef SWIG
+
 /** @name Color conversion functions
  */
 //@{
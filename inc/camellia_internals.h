@@ -52,6 +52,10 @@
 #ifndef _CAMELLIA_INTERNALS_H_
 #define _CAMELLIA_INTERNALS_H_
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -129,6 +133,171 @@ typedef struct {
 int camInternalROIPolicy(CamImage* src, CamImage *dst, CamInternalROIPolicyStruct *res, int options);
 void camInternalROIPolicyExit(CamInternalROIPolicyStruct *res); // Call to this function is necessary only when the caller manages image bit-masking
 
+// Scratch buffers for scanline kernels
+// The stack buffer provided by the caller is used whenever it is large enough (i.e. up to CAM_MAX_SCANLINE pixels wide),
+// otherwise the buffer is allocated on the heap. Returns NULL on allocation failure.
+void *camInternalScratchAlloc(void *stackBuffer, int stackSize, int size);
+void camInternalScratchFree(void *stackBuffer, void *buffer);
+// Working memory of the blob analysis, kept in the blobs and grown (keeping its content) to at least size bytes.
+// Returns NULL on allocation failure
+void *camInternalBlobsScratch(CamBlobs *blobs, int size);
+
+// Thread-local storage, for the per-thread state of the library (error string, keypoints parameters)
+#ifdef _MSC_VER
+#define CAM_THREAD_LOCAL __declspec(thread)
+#else
+#define CAM_THREAD_LOCAL __thread
+#endif
+
+// One-time initialization of static tables, safe when several threads get there at once
+#ifdef _WIN32
+typedef volatile long CamInternalOnce;
+#define CAM_ONCE_INIT 0
+#else
+typedef pthread_once_t CamInternalOnce;
+#define CAM_ONCE_INIT PTHREAD_ONCE_INIT
+#endif
+void camInternalOnce(CamInternalOnce *once, void (*init)(void));
+
+// Worker pool
+typedef void (*camInternalTask)(void *arg, int index);
+int camInternalParallelRun(camInternalTask task, void *arg, int nbTasks); // Runs task(arg,i) for i in [0,nbTasks[, using the worker pool if available
+
+// SIMD code paths, compiled whatever the target processor and selected at run time (see camGetCPUFeatures())
+#if (defined(__i386__)||defined(__x86_64__)||defined(_M_IX86)||defined(_M_X64))
+#if (defined(_MSC_VER)&&(_MSC_VER>=1700))||defined(__clang__)||(defined(__GNUC__)&&((__GNUC__>4)||((__GNUC__==4)&&(__GNUC_MINOR__>=9))))
+#define CAM_AVX2
+#ifdef _MSC_VER
+#define CAM_AVX2_TARGET
+#else
+#define CAM_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+// Linear filter kernel, compiled for SIMD processing (pairs of 16-bit coefficients)
+// Separable filters use the same structure : the horizontal taps are applied first, giving 16-bit lines,
+// then the vertical taps are applied as a 2D kernel on these lines
+#define CAM_LF_SIMD_MAX_TAPS 26
+#define CAM_LF_SIMD_ABS      1 // Absolute value of the result
+#define CAM_LF_SIMD_DEST16   2 // 16-bit destination
+#define CAM_LF_SIMD_SIGNED   4 // Signed destination
+#define CAM_LF_SIMD_SRC_SIGNED 8 // Signed source (horizontal pass of separable filters)
+typedef struct {
+    int nbPairs;
+    int xp[CAM_LF_SIMD_MAX_TAPS],yp[CAM_LF_SIMD_MAX_TAPS];
+    int coeffs[CAM_LF_SIMD_MAX_TAPS/2];
+    int nbh;
+    int xh[CAM_LF_SIMD_MAX_TAPS],hcoeffs[CAM_LF_SIMD_MAX_TAPS];
+    int coeff1,coeff2;
+    int valmin,valmax;
+    int options;
+} CamLinearFilterSIMDKernel;
+int camInternalLinearFilterPrepareSIMD(CamLinearFilterSIMDKernel *k, int nbk, int *xpk, int *ypk, int *valk, int coeff1, int coeff2, int valmin, int valmax, int options); // Returns 0 if the kernel doesn't fit
+int camInternalSepFilterPrepareSIMD(CamLinearFilterSIMDKernel *k, int nbx, const int *x, int nby, const int *y, int coeff1, int coeff2, int valmin, int valmax, int options); // Returns 0 if the kernel doesn't fit
+#ifdef CAM_AVX2
+int camInternalLinearFilterLineAVX2(unsigned char **lines, int offset, int width, void *dstptr, CamLinearFilterSIMDKernel *k, int *acc); // Returns the number of pixels processed (a multiple of 16)
+void camInternalSepFilterLineHAVX2(unsigned char *src, short *dst, int width, CamLinearFilterSIMDKernel *k);
+void camInternalSepFilterLineVAVX2(short **lines, int offset, int width, void *dstptr, CamLinearFilterSIMDKernel *k, int *acc); // acc may be NULL
+#endif
+
+// RLE encoding of a line, compiled for SIMD processing
+#define CAM_RLE_SIMD_VALUE         0 // Runs of pixel values, or of LUT values
+#define CAM_RLE_SIMD_THRESHOLD     1 // Runs of (pixel>=threshold)
+#define CAM_RLE_SIMD_THRESHOLD_INV 2 // Runs of (pixel<threshold)
+#ifdef CAM_AVX2
+int camInternalRLEEncodeLineAVX2(void *srcptr, int width, int pixelSize, int mode, int threshold, int *LUT, CamRun *runs, int first, int y); // Returns the number of runs
+#endif
+
+// Binary RLE images as rows of foreground intervals [start,end[ (the non-zero runs, merged)
+typedef struct {
+    int width,height;
+    int *rows;		// Index of the first interval of each row (height+1 entries)
+    int *bounds;	// Start and end of each interval
+    int allocated;	// Number of intervals allocated
+} CamRLEIntervals;
+int camInternalRLEToIntervals(CamRLEImage *src, CamRLEIntervals *dest);
+int camInternalRLEFromIntervals(CamRLEIntervals *src, CamRLEImage *dest); // Runs of value 1 (foreground) and 0
+int camInternalRLEIntervalsReserve(CamRLEIntervals *s, int nbIntervals);
+void camInternalRLEFreeIntervals(CamRLEIntervals *s);
+// Boolean combination of two rows of intervals. op is the truth table of the operation : bit (a<<1|b) is the result
+// for a pixel in the first row (a=1) and/or in the second one (b=1). Bit 0 must be 0. out must have room for na+nb intervals.
+// Returns the number of intervals of the result
+int camInternalRLECombineIntervals(const int *a, int na, const int *b, int nb, int op, int *out);
+#define CAM_RLE_INTERVALS_AND 8
+#define CAM_RLE_INTERVALS_OR  14
+
+// Median selection networks for 3x3 and 5x5 neighbourhoods. S(a,b) is a compare-exchange (min in a, max in b).
+// Once the network is applied, the median is the middle element (4 or 12)
+#define CAM_MF_NETWORK9(S) \
+    S(1,2) S(4,5) S(7,8) S(0,1) S(3,4) S(6,7) S(1,2) S(4,5) S(7,8) S(0,3) \
+    S(5,8) S(4,7) S(3,6) S(1,4) S(2,5) S(4,7) S(4,2) S(6,4) S(4,2)
+#define CAM_MF_NETWORK25(S) \
+    S(0,1) S(3,4) S(2,4) S(2,3) S(6,7) S(5,7) S(5,6) S(9,10) S(8,10) S(8,9) \
+    S(12,13) S(11,13) S(11,12) S(15,16) S(14,16) S(14,15) S(18,19) S(17,19) S(17,18) S(21,22) \
+    S(20,22) S(20,21) S(23,24) S(2,5) S(3,6) S(0,6) S(0,3) S(4,7) S(1,7) S(1,4) \
+    S(11,14) S(8,14) S(8,11) S(12,15) S(9,15) S(9,12) S(13,16) S(10,16) S(10,13) S(20,23) \
+    S(17,23) S(17,20) S(21,24) S(18,24) S(18,21) S(19,22) S(8,17) S(9,18) S(0,18) S(0,9) \
+    S(10,19) S(1,19) S(1,10) S(11,20) S(2,20) S(2,11) S(12,21) S(3,21) S(3,12) S(13,22) \
+    S(4,22) S(4,13) S(14,23) S(5,23) S(5,14) S(15,24) S(6,24) S(6,15) S(7,16) S(7,19) \
+    S(13,21) S(15,23) S(7,13) S(7,15) S(1,9) S(3,11) S(5,17) S(11,17) S(9,17) S(4,10) \
+    S(6,12) S(7,14) S(4,6) S(4,7) S(12,14) S(10,14) S(6,7) S(10,12) S(6,10) S(6,17) \
+    S(12,17) S(7,17) S(7,10) S(12,18) S(7,12) S(10,18) S(12,20) S(10,20) S(10,12)
+#ifdef CAM_AVX2
+int camInternalMedianFilterLineAVX2(unsigned char **lines, int width, unsigned char *dstptr, int neighb); // Returns the number of pixels processed (a multiple of 32)
+#endif
+
+// L1 distance between quantized keypoints descriptors (see camKeypointsQuantize()). size is a multiple of 32
+#ifdef CAM_AVX2
+int camInternalCompareDescriptors8uAVX2(const unsigned char *desc1, const unsigned char *desc2, int size);
+int camInternalCompareDescriptors16sAVX2(const short *desc1, const short *desc2, int size); // Descriptors in [-16384,16383]
+#endif
+
+// Read-only file mapping (NULL if the file can't be mapped)
+void *camInternalMapFile(const char *filename, CAM_INT64 *size);
+void camInternalUnmapFile(void *map, CAM_INT64 size);
+
+// Band-parallel execution of image kernels
+typedef int (*camInternalBandKernel)(CamImage *source, CamImage *dest, void *params);
+typedef int (*camInternalBandKernel2)(CamImage *source1, CamImage *source2, CamImage *dest, void *params);
+#define CAM_BANDS_SUM 1          // The results of the bands are summed up (otherwise, the result is 1 if all the bands succeeded)
+#define CAM_BANDS_INPLACE 2      // Pixel to pixel kernel : in-place processing can be split into bands as well
+#define CAM_MIN_BAND_HEIGHT 16   // Minimum number of lines per band
+int camInternalParallelBands(CamImage *source, CamImage *dest, void *params, camInternalBandKernel kernel, int options);
+int camInternalParallelBands2(CamImage *source1, CamImage *source2, CamImage *dest, void *params, camInternalBandKernel2 kernel, int options);
+
+// Defines the entry point of an image kernel, dispatching its serial version (function##Serial) on bands
+#define CAM_PARALLEL_BANDS_FUNCTION(function, paramtype, options) \
+static int function##Band(CamImage *source, CamImage *dest, void *params) \
+{ \
+    return function##Serial(source, dest, (paramtype)params); \
+} \
+int function(CamImage *source, CamImage *dest, paramtype params) \
+{ \
+    return camInternalParallelBands(source, dest, (void*)params, function##Band, options); \
+}
+
+#define CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(function, options) \
+static int function##Band(CamImage *source, CamImage *dest, void *params) \
+{ \
+    return function##Serial(source, dest); \
+} \
+int function(CamImage *source, CamImage *dest) \
+{ \
+    return camInternalParallelBands(source, dest, NULL, function##Band, options); \
+}
+
+#define CAM_PARALLEL_BANDS_FUNCTION2(function, paramtype, options) \
+static int function##Band(CamImage *source1, CamImage *source2, CamImage *dest, void *params) \
+{ \
+    return function##Serial(source1, source2, dest, (paramtype)params); \
+} \
+int function(CamImage *source1, CamImage *source2, CamImage *dest, paramtype params) \
+{ \
+    return camInternalParallelBands2(source1, source2, dest, (void*)params, function##Band, options); \
+}
+
+// The error string is kept per thread
 const char *camGetErrorStr();
 void camSetErrorStr(const char *s);
 
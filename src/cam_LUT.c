@@ -74,7 +74,7 @@
 #undef camApplyLUT
 #undef camApplyLUT1U
 
-int camApplyLUT(CamImage *source, CamImage *dest, CamLUT *LUT)
+static int camApplyLUTSerial(CamImage *source, CamImage *dest, CamLUT *LUT)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
 	return camApplyLUT16(source,dest,LUT);
@@ -83,6 +83,8 @@ int camApplyLUT(CamImage *source, CamImage *dest, CamLUT *LUT)
     }
 }
 
+CAM_PARALLEL_BANDS_FUNCTION(camApplyLUT, CamLUT*, CAM_BANDS_SUM | CAM_BANDS_INPLACE)
+
 #else
 #include "cam_LUT_code.c"
 #endif
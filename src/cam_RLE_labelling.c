@@ -50,6 +50,9 @@
  * C code */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include "camellia.h"
 #include "camellia_internals.h"
 
@@ -565,26 +568,16 @@ void camRLEEncodeTableGenerator()
 }
 #endif
 
-// Connect components using four-connecteness so that the runs each
-// identify the global parent of the connected region they are a part of.
-// It does this by scanning adjacent rows and merging where similar
-// colors overlap.
-int camRLELabelling(CamRLEImage *src, CamBlobAnalysisResults *results)
+// Scans the adjacent rows of runs [start,end[ (whole lines) in lock step,
+// merging where similar colors overlap
+static void camRLELabellingScan(CamRun *run, int width, int start, int end)
 {
     int x1,x2;
     int l1,l2;
     CamRun r1,r2;
-    int i,p,s,n;
-    int num=src->nbRuns;
-    int width=src->width;
-    CamRun *run=src->runs;
-    
-    if (src->nbRuns == 0) {
-	results->nbBlobs = 0;	
-	return 0;
-    }
+    int p,s,n;
 
-    l1 = l2 = 1;
+    l1 = l2 = start;
     x1 = x2 = 0;
     
     // Lower scan begins on second line, so skip over first
@@ -592,12 +585,13 @@ int camRLELabelling(CamRLEImage *src, CamBlobAnalysisResults *results)
 	x1 += run[l1++].length;
     }
     x1 = 0;
+    if (l1 >= end) return;
     
     // Do the remaining lines in lock step
     r1 = run[l1];
     r2 = run[l2];
     s = l1;
-    while (l1 < num) {
+    while (l1 < end) {
 	if (r1.value==r2.value && r1.value) { 
 	    if ((x1>=x2 && x1<x2+r2.length) || (x2>=x1 && x2<x1+r1.length)) {
 		if(s != l1) {
@@ -623,16 +617,20 @@ int camRLELabelling(CamRLEImage *src, CamBlobAnalysisResults *results)
 	// Move to next point where values may change
 	if (x1+r1.length < x2+r2.length) {
 	    x1 += r1.length;
-	    r1 = run[++l1];
+	    if (++l1 < end) r1 = run[l1];
 	} else {
 	    x2 += r2.length;
 	    r2 = run[++l2];
 	}
     }
-    
-    // Now we need to compress all parent paths
-    // This is the traditional second scan
-    for (i=1; i<num; i++) {
+}
+
+// Compresses all parent paths of runs [start,end[
+// This is the traditional second scan
+static void camRLELabellingCompress(CamRun *run, int start, int end)
+{
+    int i,p;
+    for (i=start; i<end; i++) {
 	p = run[i].parent;
 	if (p > i) {
 	    while (p != run[p].parent) p = run[p].parent;
@@ -641,11 +639,117 @@ int camRLELabelling(CamRLEImage *src, CamBlobAnalysisResults *results)
 	    run[i].parent = run[p].parent;
 	}
     }
+}
+
+static int camRLEParallelLabelling(CamRLEImage *src, CamBlobAnalysisResults *results);
+
+// Connect components using four-connecteness so that the runs each
+// identify the global parent of the connected region they are a part of.
+// It does this by scanning adjacent rows and merging where similar
+// colors overlap.
+int camRLELabelling(CamRLEImage *src, CamBlobAnalysisResults *results)
+{
+    int num=src->nbRuns;
+    
+    if (src->nbRuns == 0) {
+	results->nbBlobs = 0;	
+	return 0;
+    }
+    if (((unsigned int)num >= CAM_RLE_MAX_INDEX) || ((unsigned int)src->height >= CAM_RLE_MAX_INDEX)) {
+	// The runs indexes would overflow
+	results->nbBlobs = 0;
+	camError("camRLELabelling","Too many runs or lines. Compile with CAM_RLE_32BITS option");
+	return 0;
+    }
+
+    // Large images are labelled by strips, on several threads
+    if (camGetNumThreads() > 1 && src->height >= 2*CAM_MIN_BAND_HEIGHT && !(results->features & CAM_BLOB_MOMENTS)) {
+	return camRLEParallelLabelling(src,results);
+    }
+
+    camRLELabellingScan(src->runs,src->width,1,num);
+    
+    // Now we need to compress all parent paths
+    camRLELabellingCompress(src->runs,1,num);
     
     // Now, let's run the blob analysis
     return camRLEBlobAnalysis(src,results);
 }
 
+// Sum of integers over range [x,x+w)
+#define RANGE_SUM(x,w) ((CAM_INT64)(w)*(2*(x) + (w)-1) / 2)
+// Sum of squares over range [x,x+w)
+#define SQUARES_SUM(n) ((CAM_INT64)(n)*((n)+1)*(2*(n)+1) / 6)
+#define RANGE_SUM2(x,w) (SQUARES_SUM((x)+(w)-1) - SQUARES_SUM((x)-1))
+#define MIN(x,y) (((x)<(y))?(x):(y))
+#define MAX(x,y) (((x)>(y))?(x):(y))
+
+/* Blob moments (CAM_BLOB_MOMENTS feature)
+ * Computed on the runs, with closed-form sums over each run. The perimeter and the Euler number
+ * only need the overlaps of each run with the runs of the previous line belonging to the same blob.
+ */
+typedef struct {
+    CAM_INT64 sx,sy;	    // First order moments
+    CAM_INT64 sxx,sxy,syy;  // Second order moments
+    int perimeter;
+    int euler;
+} CamRLEMoments;
+
+// Accumulators of a blob, kept in the working memory of the results
+typedef struct {
+    CAM_INT64 sums[2];	    // Centroids accumulators (the y one relative to the top of the blob)
+    CamRLEMoments moments;  // Only with the CAM_BLOB_MOMENTS feature
+} CamRLEBlobAcc;
+
+// Adds the run [x,x+length[ of line y. overlap is the number of pixels shared with the runs of the
+// previous line of the same blob, and neighbours the number of such runs
+static void camRLEMomentsAddRun(CamRLEMoments *m, int x, int y, int length, int overlap, int neighbours)
+{
+    CAM_INT64 s=RANGE_SUM(x,length);
+    m->sx+=s;
+    m->sy+=(CAM_INT64)y*length;
+    m->sxx+=RANGE_SUM2(x,length);
+    m->sxy+=s*y;
+    m->syy+=(CAM_INT64)y*y*length;
+    // The sides shared with the previous line are not on the border, neither for this run, nor for the runs above
+    m->perimeter+=2*(length+1-overlap);
+    // Each new connection either merges two parts of the blob, or closes a hole (4-connectivity)
+    m->euler+=1-neighbours;
+}
+
+static void camRLEMomentsMerge(CamRLEMoments *m, CamRLEMoments *other)
+{
+    m->sx+=other->sx;
+    m->sy+=other->sy;
+    m->sxx+=other->sxx;
+    m->sxy+=other->sxy;
+    m->syy+=other->syy;
+    m->perimeter+=other->perimeter;
+    m->euler+=other->euler;
+}
+
+// Fills the moments members of the blob (whose surface is already set)
+static void camRLEMomentsSet(CamBlobInfo *blob, CamRLEMoments *m)
+{
+    double n=blob->surface;
+    double mx=m->sx/n, my=m->sy/n;
+    double mu20=m->sxx/n-mx*mx, mu11=m->sxy/n-mx*my, mu02=m->syy/n-my*my;
+    double d;
+
+    if (mu20<0) mu20=0; // Rounding errors
+    if (mu02<0) mu02=0;
+    d=sqrt(4*mu11*mu11+(mu20-mu02)*(mu20-mu02));
+    blob->mu20=(float)mu20;
+    blob->mu11=(float)mu11;
+    blob->mu02=(float)mu02;
+    blob->orientation=(float)(0.5*atan2(2*mu11,mu20-mu02));
+    // The semi-axes of an ellipse are twice the standard deviations along its axes
+    blob->major=(float)sqrt(2*(mu20+mu02+d));
+    blob->minor=(float)sqrt(MAX(0,2*(mu20+mu02-d)));
+    blob->perimeter=m->perimeter;
+    blob->euler=m->euler;
+}
+
 // Takes the list of runs and formats them into a region table,
 // gathering the various statistics we want along the way.
 // Implemented as a single pass over the array of runs.
@@ -656,20 +760,33 @@ int camRLEBlobAnalysis(CamRLEImage *src, CamBlobAnalysisResults *results)
     CamRun *r;
     int nbRuns=src->nbRuns;
     int width=src->width;
-
-    // Sum of integers over range [x,x+w)
-    #define RANGE_SUM(x,w) (w*(2*x + w-1) / 2)
-    #define MIN(x,y) (((x)<(y))?(x):(y))
-    #define MAX(x,y) (((x)>(y))?(x):(y))
+    CamRLEBlobAcc *acc=NULL;
+    int nbAcc=0;
+    int features=results->features&CAM_BLOB_MOMENTS;
+    int start,p,xp,k,xk,overlap,neighbours; // Runs of the previous line (for the moments)
 
     results->nbBlobs=0; // Just in case it would fail...
     
     x = y = n = 0;
+    start = p = 1; xp = 0;
     for (i=1; i<nbRuns; i++) {
 	r = &src->runs[i];
+	if (features && x == 0) {
+	    // New line : the current line becomes the previous one
+	    p = start;
+	    start = i;
+	    xp = 0;
+	}
 	
 	if (r->value) {
 	    if (r->parent == i) {
+		// Grow the blobs array (and the accumulators) if it is full
+		if (n == nbAcc) {
+		    if (n == results->allocated && !camBlobsReserve(results, (n) ? n * 2 : CAM_LABEL_MAX_BLOBS)) return 0;
+		    acc = (CamRLEBlobAcc*)camInternalBlobsScratch(results, results->allocated * sizeof(CamRLEBlobAcc));
+		    if (acc == NULL) return 0;
+		    nbAcc = results->allocated;
+		}
 		// Add new region if this run is a root (i.e. self parented)
 		src->runs[i].parent = b = n;  // Renumber to point to region id
 		results->blobInfo[b].id = n;
@@ -678,13 +795,13 @@ int camRLEBlobAnalysis(CamRLEImage *src, CamBlobAnalysisResults *results)
 		results->blobInfo[b].top = y;
 		results->blobInfo[b].width = r->length;
 		results->blobInfo[b].height = 1;
-		results->blobInfo[b].cx = RANGE_SUM(x, r->length);
-		results->blobInfo[b].cy = y * r->length;
+		acc[b].sums[0] = RANGE_SUM(x, r->length);
+		acc[b].sums[1] = 0;
 		results->blobInfo[b].value = r->value;
 		results->blobInfo[b].first = r;
 		results->blobInfo[b].last = r;
+		if (features) memset(&acc[b].moments, 0, sizeof(CamRLEMoments));
 		n++;
-		if(n >= CAM_LABEL_MAX_BLOBS) return 0;
 	    } else {
 		// Otherwise update region stats incrementally
 		b = src->runs[r->parent].parent;
@@ -696,10 +813,25 @@ int camRLEBlobAnalysis(CamRLEImage *src, CamBlobAnalysisResults *results)
 		}   
 		results->blobInfo[b].width = MAX(x + r->length - results->blobInfo[b].left, results->blobInfo[b].width);
 		results->blobInfo[b].height = y - results->blobInfo[b].top+1; // Last set by lowest run
-		results->blobInfo[b].cx += RANGE_SUM(x, r->length);
-		results->blobInfo[b].cy += y * r->length;
+		acc[b].sums[0] += RANGE_SUM(x, r->length);
+		acc[b].sums[1] += (CAM_INT64)(y - results->blobInfo[b].top) * r->length;
 		results->blobInfo[b].last = r;
 	    }
+	    if (features) {
+		// Runs of the previous line overlapping this one, with the same value (thus of the same blob)
+		while (p < start && xp + src->runs[p].length <= x) {
+		    xp += src->runs[p].length;
+		    p++;
+		}
+		overlap = neighbours = 0;
+		for (k = p, xk = xp; k < start && xk < x + r->length; xk += src->runs[k].length, k++) {
+		    if (src->runs[k].value == r->value) {
+			overlap += MIN(xk + src->runs[k].length, x + r->length) - MAX(xk, x);
+			neighbours++;
+		    }
+		}
+		camRLEMomentsAddRun(&acc[b].moments, x, y, r->length, overlap, neighbours);
+	    }
 	} else r->parent=-1;
 	
 	// Step to next location
@@ -710,72 +842,824 @@ int camRLEBlobAnalysis(CamRLEImage *src, CamBlobAnalysisResults *results)
     // Calculate centroids from stored temporaries
     for (i=0; i<n; i++) {
 	a = results->blobInfo[i].surface;
-	results->blobInfo[i].cx = results->blobInfo[i].cx / a;
-	results->blobInfo[i].cy = results->blobInfo[i].cy / a;
+	results->blobInfo[i].cx = (int)(acc[i].sums[0] / a);
+	results->blobInfo[i].cy = results->blobInfo[i].top + (int)(acc[i].sums[1] / a);
+	if (features) camRLEMomentsSet(&results->blobInfo[i], &acc[i].moments);
     }
     
     results->nbBlobs=n;
     return 1;
 }
 
+/* Parallel RLE labeling
+ * The lines are split into horizontal strips that are labelled independently, each strip
+ * collecting the statistics of its own partial blobs. The partial blobs are then merged
+ * along the strips boundaries (union-find), and their statistics reduced into the final blobs.
+ * The result is the same as the one of the serial labeling.
+ */
+typedef struct {
+    int left,right;	    // Horizontal extent [left,right[
+    int top,bottom;	    // Vertical extent [top,bottom]
+    int surface;
+    int value;
+    CAM_INT64 sx,sy;	    // Centroids accumulators
+    CamRun *first,*last;
+} CamRLEPartialBlob;
+
+typedef struct {
+    int start,end;	    // Runs of the strip : [start,end[
+    int y;		    // First line of the strip
+    int nbBlobs;	    // Number of partial blobs, or -1 if an error occured
+    int allocated;
+    CamRLEPartialBlob *blobs;
+    int base;		    // Index of the first partial blob of the strip in the whole image
+} CamRLEStrip;
+
+typedef struct {
+    CamRun *run;
+    int width;
+    int nbStrips;
+    int *ids;		    // Final blob number of each partial blob
+    CamRLEStrip strip[CAM_MAX_THREADS];
+} CamRLELabellingJob;
+
+// Returns the index of the first run of line y (or of the next lines)
+static int camRLEFindLine(CamRun *run, int num, int y)
+{
+    int lo=1,hi=num,m;
+    while (lo < hi) {
+	m = (lo + hi) >> 1;
+	if ((int)run[m].line < y) lo = m + 1; else hi = m;
+    }
+    return lo;
+}
+
+// Labels a strip, and collects its partial blobs. The runs are then attached to their partial blob
+static void camRLELabellingStripTask(void *arg, int index)
+{
+    CamRLELabellingJob *job=(CamRLELabellingJob*)arg;
+    CamRLEStrip *strip=&job->strip[index];
+    CamRun *run=job->run,*r;
+    CamRLEPartialBlob *b;
+    int i,x,y,n=0;
+    int width=job->width;
+
+    camRLELabellingScan(run,width,strip->start,strip->end);
+    camRLELabellingCompress(run,strip->start,strip->end);
+
+    x = 0; y = strip->y;
+    for (i=strip->start; i<strip->end; i++) {
+	r = &run[i];
+	if (r->value) {
+	    if (r->parent == i) {
+		// New partial blob
+		if (n == strip->allocated) {
+		    b = (CamRLEPartialBlob*)realloc(strip->blobs, (n ? n * 2 : 64) * sizeof(CamRLEPartialBlob));
+		    if (b == NULL) {
+			strip->nbBlobs = -1;
+			return;
+		    }
+		    strip->blobs = b;
+		    strip->allocated = (n ? n * 2 : 64);
+		}
+		b = &strip->blobs[n];
+		r->parent = n++;
+		b->left = x;
+		b->right = x + r->length;
+		b->top = b->bottom = y;
+		b->surface = r->length;
+		b->value = r->value;
+		b->sx = RANGE_SUM(x, r->length);
+		b->sy = (CAM_INT64)y * r->length;
+		b->first = b->last = r;
+	    } else {
+		r->parent = run[r->parent].parent;
+		b = &strip->blobs[r->parent];
+		b->left = MIN(x, b->left);
+		b->right = MAX(x + r->length, b->right);
+		b->bottom = y;
+		b->surface += r->length;
+		b->sx += RANGE_SUM(x, r->length);
+		b->sy += (CAM_INT64)y * r->length;
+		b->last = r;
+	    }
+	}
+	x = (x + r->length) % width;
+	y += (x == 0);
+    }
+    strip->nbBlobs = n;
+}
+
+// Attaches the runs of a strip to their final blob
+static void camRLERelabellingStripTask(void *arg, int index)
+{
+    CamRLELabellingJob *job=(CamRLELabellingJob*)arg;
+    CamRLEStrip *strip=&job->strip[index];
+    CamRun *run=job->run;
+    int i;
+
+    for (i=strip->start; i<strip->end; i++) {
+	if (run[i].value) {
+	    run[i].parent = job->ids[strip->base + run[i].parent];
+	} else run[i].parent = -1;
+    }
+}
+
+// Merges the partial blobs of the strips into the final blobs
+static int camRLEMergeStrips(CamRLELabellingJob *job, CamRLEImage *src, CamBlobAnalysisResults *results)
+{
+    CamRun *run=src->runs,*r1,*r2;
+    CamRLEPartialBlob *pb;
+    CamBlobInfo *blob;
+    CAM_INT64 (*sums)[2];
+    int *eq;
+    int i,k,s,g,n,p,x1,x2,l1,l2,end1,end2,a;
+    int nbPartial,nbBlobs;
+
+    for (nbPartial=0, k=0; k<job->nbStrips; k++) {
+	if (job->strip[k].nbBlobs < 0) {
+	    camError("camRLELabelling","Memory allocation error");
+	    return 0;
+	}
+	job->strip[k].base = nbPartial;
+	nbPartial += job->strip[k].nbBlobs;
+    }
+    if (nbPartial == 0) {
+	// No blob at all : just reset the runs
+	for (i=1; i<src->nbRuns; i++) run[i].parent = -1;
+	return 1;
+    }
+    // The centroids accumulators (at most one per partial blob), then the equivalences and the blobs ids
+    sums = (CAM_INT64(*)[2])camInternalBlobsScratch(results, nbPartial * (sizeof(*sums) + 2 * sizeof(int)));
+    if (sums == NULL) return 0;
+    eq = (int*)(sums + nbPartial);
+    job->ids = eq + nbPartial;
+    for (g=0; g<nbPartial; g++) eq[g] = g;
+
+    // Merge the partial blobs along the strips boundaries : the last line of a strip
+    // and the first line of the next one are scanned in lock step
+    for (k=1; k<job->nbStrips; k++) {
+	l1 = job->strip[k].start;
+	end1 = camRLEFindLine(run, job->strip[k].end, job->strip[k].y + 1);
+	l2 = camRLEFindLine(run, job->strip[k].start, job->strip[k].y - 1);
+	end2 = job->strip[k].start;
+	x1 = x2 = 0;
+	while (l1 < end1 && l2 < end2) {
+	    r1 = &run[l1];
+	    r2 = &run[l2];
+	    if (r1->value == r2->value && r1->value) {
+		if ((x1>=x2 && x1<x2+r2->length) || (x2>=x1 && x2<x1+r1->length)) {
+		    n = job->strip[k].base + r1->parent;
+		    while (n != eq[n]) n = eq[n];
+		    p = job->strip[k-1].base + r2->parent;
+		    while (p != eq[p]) p = eq[p];
+		    // Keep the smaller, so that the blobs are numbered as in serial labeling
+		    if (n < p) eq[p] = n; else eq[n] = p;
+		}
+	    }
+	    if (x1 + r1->length < x2 + r2->length) {
+		x1 += r1->length;
+		l1++;
+	    } else {
+		x2 += r2->length;
+		l2++;
+	    }
+	}
+    }
+
+    // Number the blobs
+    for (nbBlobs=0, g=0; g<nbPartial; g++) {
+	if (eq[g] == g) {
+	    job->ids[g] = nbBlobs++;
+	} else {
+	    eq[g] = eq[eq[g]];
+	    job->ids[g] = job->ids[eq[g]];
+	}
+    }
+    if (!camBlobsReserve(results, nbBlobs)) return 0;
+
+    // Reduce the partial blobs statistics
+    for (k=0; k<job->nbStrips; k++) {
+	for (s=0; s<job->strip[k].nbBlobs; s++) {
+	    g = job->strip[k].base + s;
+	    pb = &job->strip[k].blobs[s];
+	    i = job->ids[g];
+	    blob = &results->blobInfo[i];
+	    if (eq[g] == g) {
+		blob->id = i;
+		blob->left = pb->left;
+		blob->width = pb->right; // Right for now
+		blob->top = pb->top;
+		blob->height = pb->bottom; // Bottom for now
+		blob->surface = pb->surface;
+		blob->value = pb->value;
+		blob->first = pb->first;
+		blob->last = pb->last;
+		sums[i][0] = pb->sx;
+		sums[i][1] = pb->sy;
+	    } else {
+		blob->left = MIN(pb->left, blob->left);
+		blob->width = MAX(pb->right, blob->width);
+		blob->height = MAX(pb->bottom, blob->height);
+		blob->surface += pb->surface;
+		if (pb->last > blob->last) blob->last = pb->last;
+		sums[i][0] += pb->sx;
+		sums[i][1] += pb->sy;
+	    }
+	}
+    }
+    for (i=0; i<nbBlobs; i++) {
+	blob = &results->blobInfo[i];
+	a = blob->surface;
+	blob->width -= blob->left;
+	blob->height -= blob->top - 1;
+	blob->cx = (int)(sums[i][0] / a);
+	blob->cy = (int)(sums[i][1] / a);
+    }
+
+    // Attach the runs to their blob
+    camInternalParallelRun(camRLERelabellingStripTask, job, job->nbStrips);
+    results->nbBlobs = nbBlobs;
+    return 1;
+}
+
+static int camRLEParallelLabelling(CamRLEImage *src, CamBlobAnalysisResults *results)
+{
+    CamRLELabellingJob job;
+    int k,ok;
+
+    results->nbBlobs = 0;
+
+    job.run = src->runs;
+    job.width = src->width;
+    job.nbStrips = camGetNumThreads();
+    if (job.nbStrips > src->height / CAM_MIN_BAND_HEIGHT) job.nbStrips = src->height / CAM_MIN_BAND_HEIGHT;
+    for (k=0; k<job.nbStrips; k++) {
+	job.strip[k].y = src->height * k / job.nbStrips;
+	job.strip[k].start = (k) ? camRLEFindLine(src->runs, src->nbRuns, job.strip[k].y) : 1;
+	job.strip[k].nbBlobs = 0;
+	job.strip[k].allocated = 0;
+	job.strip[k].blobs = NULL;
+    }
+    for (k=0; k<job.nbStrips-1; k++) job.strip[k].end = job.strip[k+1].start;
+    job.strip[k].end = src->nbRuns;
+
+    // Label the strips independently, then merge them
+    camInternalParallelRun(camRLELabellingStripTask, &job, job.nbStrips);
+    ok = camRLEMergeStrips(&job, src, results);
+
+    for (k=0; k<job.nbStrips; k++) free(job.strip[k].blobs);
+    return ok;
+}
+
+/* Streaming labeling
+ * Thresholds (or applies a LUT to) the source image, and labels it on the fly, line after line,
+ * keeping only the runs of the current and the previous lines. The blobs statistics are accumulated
+ * as the runs are produced, and merged whenever two blobs are found to be connected (union-find).
+ */
+typedef struct {
+    int left,right;	    // Horizontal extent [left,right[
+    int top,bottom;	    // Vertical extent [top,bottom]
+    int surface;
+    int value;
+    int min,max;	    // Min and max values in the original image
+    CAM_INT64 sx,sy;	    // Centroids accumulators
+    CAM_INT64 sum;	    // Sum of the values in the original image
+    CamRLEMoments moments;  // Only with CAM_BLOB_MOMENTS
+} CamRLEStreamBlob;
+
+typedef struct {
+    int *root;		    // Union-find forest of the labels
+    CamRLEStreamBlob *blobs; // Statistics of the labels (valid for the roots only)
+    int nbLabels;
+    int allocated;
+    CamBlobAnalysisResults *results; // Whose working memory keeps the labels, if they can grow
+} CamRLEStreamLabels;
+
+typedef struct {
+    unsigned char *srcptr;  // First line of the source ROI
+    unsigned char *optr;    // First line of the original ROI (or NULL)
+    int srcinc,oinc;	    // Pixels increments
+    int pixelSize,opixelSize;
+    int width,height;
+    int simd;		    // Use of camInternalRLEEncodeLineAVX2
+} CamRLEStreamInput;
+
+// RLE encoding of a line (C version of camInternalRLEEncodeLineAVX2). Only the value and length of the runs are set.
+static int camRLEEncodeLine(unsigned char *srcptr, int width, int inc, int pixelSize, int mode, int threshold, int *LUT, CamRun *runs)
+{
+    int x,l,n,pixel,val,cur=0;
+    int mask=(pixelSize==1)?0xff:0xffff;
+
+    for (x=0,l=0,n=0; x<width; x++) {
+	pixel=(pixelSize==1)?srcptr[x*inc]:((unsigned short*)srcptr)[x*inc];
+	if (mode==CAM_RLE_SIMD_VALUE) {
+	    val=(LUT)?(LUT[pixel]&mask):pixel;
+	} else {
+	    val=((pixel>=threshold)!=(mode==CAM_RLE_SIMD_THRESHOLD_INV));
+	}
+	if (x==0) cur=val;
+	else if (val!=cur) {
+	    runs[n].value=cur;
+	    runs[n].length=x-l;
+	    n++;
+	    l=x;
+	    cur=val;
+	}
+    }
+    runs[n].value=cur;
+    runs[n].length=width-l;
+    return n+1;
+}
+
+// Accumulates the values of the original image over [x,x+length[
+static void camRLEStreamMeasures(CamRLEStreamBlob *b, unsigned char *ptr, int inc, int pixelSize, int x, int length)
+{
+    int i,v,min=b->min,max=b->max;
+    CAM_INT64 sum=0;
+    if (pixelSize==1) {
+	for (ptr+=x*inc, i=0; i<length; i++, ptr+=inc) {
+	    v=*ptr;
+	    sum+=v;
+	    if (v<min) min=v;
+	    if (v>max) max=v;
+	}
+    } else {
+	unsigned short *ptr16=((unsigned short*)ptr)+x*inc;
+	for (i=0; i<length; i++, ptr16+=inc) {
+	    v=*ptr16;
+	    sum+=v;
+	    if (v<min) min=v;
+	    if (v>max) max=v;
+	}
+    }
+    b->sum+=sum;
+    b->min=min;
+    b->max=max;
+}
+
+static int camRLEStreamFind(int *root, int n)
+{
+    while (root[n]!=n) n=root[n]=root[root[n]];
+    return n;
+}
+
+// Checks the source and original images, and retrieves their ROI
+static int camRLEStreamInit(CamImage *source, CamImage *original, CamRLEStreamInput *in)
+{
+    CamInternalROIPolicyStruct iROI,oROI;
+
+    CAM_CHECK(camRLEStreamInit,camInternalROIPolicy(source, NULL, &iROI, 0));
+    CAM_CHECK_ARGS(camRLEStreamInit,iROI.nChannels==1);
+    CAM_CHECK_ARGS(camRLEStreamInit,(source->depth&CAM_DEPTH_MASK)<=16);
+    CAM_CHECK_ARGS(camRLEStreamInit,(source->depth&CAM_DEPTH_MASK)>=8);
+    in->width=iROI.srcroi.width;
+    in->height=iROI.srcroi.height;
+    in->pixelSize=((source->depth&CAM_DEPTH_MASK)==8)?1:2;
+    in->srcptr=(unsigned char*)iROI.srcptr;
+    in->srcinc=iROI.srcinc;
+    in->optr=NULL;
+    if (original) {
+	CAM_CHECK(camRLEStreamInit,camInternalROIPolicy(original, NULL, &oROI, 0));
+	CAM_CHECK_ARGS(camRLEStreamInit,oROI.nChannels==1);
+	CAM_CHECK_ARGS(camRLEStreamInit,(original->depth&CAM_DEPTH_MASK)<=16);
+	CAM_CHECK_ARGS(camRLEStreamInit,(original->depth&CAM_DEPTH_MASK)>=8);
+	CAM_CHECK_ARGS(camRLEStreamInit,(oROI.srcroi.width==in->width)&&(oROI.srcroi.height==in->height));
+	in->opixelSize=((original->depth&CAM_DEPTH_MASK)==8)?1:2;
+	in->optr=(unsigned char*)oROI.srcptr;
+	in->oinc=oROI.srcinc;
+    }
+#ifdef CAM_AVX2
+    in->simd=((camGetCPUFeatures()&CAM_CPU_AVX2)&&(iROI.srcinc==1));
+#else
+    in->simd=0;
+#endif
+    return 1;
+}
+
+// Encodes the current line of the source image
+static int camRLEStreamEncodeLine(CamRLEStreamInput *in, int mode, int threshold, CamTable *LUT, CamRun *runs)
+{
+#ifdef CAM_AVX2
+    if (in->simd) {
+	return camInternalRLEEncodeLineAVX2(in->srcptr,in->width,in->pixelSize,mode,threshold,(LUT)?LUT->t:NULL,runs,0,0);
+    }
+#endif
+    return camRLEEncodeLine(in->srcptr,in->width,in->srcinc,in->pixelSize,mode,threshold,(LUT)?LUT->t:NULL,runs);
+}
+
+// Grows the labels, kept in the working memory of the results : the statistics, then the roots
+static int camRLEStreamGrow(CamRLEStreamLabels *t)
+{
+    int k=(t->allocated)?t->allocated*2:CAM_LABEL_MAX_BLOBS;
+    int size=sizeof(CamRLEStreamBlob)+sizeof(int);
+    CamRLEStreamBlob *blobs;
+
+    if (t->results==NULL) {
+	camError("camRLEStreamConnect","Too many labels");
+	return 0;
+    }
+    // Use all the memory left by the previous frames
+    if (k*size<t->results->scratchSize) k=t->results->scratchSize/size;
+    blobs=(CamRLEStreamBlob*)camInternalBlobsScratch(t->results,k*size);
+    if (blobs==NULL) return 0;
+    t->blobs=blobs;
+    t->root=(int*)memmove(blobs+k,blobs+t->allocated,t->nbLabels*sizeof(int));
+    t->allocated=k;
+    return 1;
+}
+
+// Connects the runs of line y to the ones of the previous line, labelling them and accumulating
+// their statistics. optr is the line of the original image (or NULL).
+// New labels are appended to t, which is grown as needed.
+static int camRLEStreamConnect(CamRLEStreamLabels *t, CamRun *runs, int nbRuns, int *labels, CamRun *prevRuns, int nbPrevRuns, int *prevLabels, int y, CamRLEStreamInput *in, int features)
+{
+    int x,i,j,xj,xe,n,a,b,c,k,overlap,neighbours;
+    CamRLEStreamBlob *blob,*other;
+
+    for (i=0,x=0,j=0,xj=0; i<nbRuns; x=xe,i++) {
+	xe=x+runs[i].length;
+	labels[i]=-1;
+	if (runs[i].value==0) continue;
+	// Skip the runs of the previous line that end before this one
+	while ((j<nbPrevRuns)&&(xj+prevRuns[j].length<=x)) {
+	    xj+=prevRuns[j].length;
+	    j++;
+	}
+	a=-1;
+	overlap=neighbours=0;
+	for (n=j,b=xj; (n<nbPrevRuns)&&(b<xe); b+=prevRuns[n].length,n++) {
+	    if ((prevRuns[n].value!=runs[i].value)||(prevLabels[n]<0)) continue;
+	    overlap+=MIN(b+prevRuns[n].length,xe)-MAX(b,x);
+	    neighbours++;
+	    c=camRLEStreamFind(t->root,prevLabels[n]);
+	    if (a<0) a=c;
+	    else if (c!=a) {
+		// Union : the smaller label becomes the root, and collects the statistics of the other one
+		if (c<a) {k=a; a=c; c=k;}
+		t->root[c]=a;
+		blob=&t->blobs[a]; other=&t->blobs[c];
+		blob->left=MIN(blob->left,other->left);
+		blob->right=MAX(blob->right,other->right);
+		blob->top=MIN(blob->top,other->top);
+		blob->bottom=MAX(blob->bottom,other->bottom);
+		blob->surface+=other->surface;
+		blob->sx+=other->sx;
+		blob->sy+=other->sy;
+		blob->sum+=other->sum;
+		blob->min=MIN(blob->min,other->min);
+		blob->max=MAX(blob->max,other->max);
+		if (features) camRLEMomentsMerge(&blob->moments,&other->moments);
+	    }
+	}
+	if (a<0) {
+	    // New blob
+	    if ((t->nbLabels==t->allocated)&&(!camRLEStreamGrow(t))) return 0;
+	    a=t->nbLabels++;
+	    t->root[a]=a;
+	    blob=&t->blobs[a];
+	    blob->left=x; blob->right=xe;
+	    blob->top=blob->bottom=y;
+	    blob->surface=0;
+	    blob->value=runs[i].value;
+	    blob->sx=blob->sy=blob->sum=0;
+	    blob->min=(in->optr)?0xffff:0;
+	    blob->max=0;
+	    if (features) memset(&blob->moments,0,sizeof(CamRLEMoments));
+	} else {
+	    blob=&t->blobs[a];
+	    blob->left=MIN(blob->left,x);
+	    blob->right=MAX(blob->right,xe);
+	    blob->bottom=y;
+	}
+	blob->surface+=runs[i].length;
+	blob->sx+=RANGE_SUM(x,runs[i].length);
+	blob->sy+=(CAM_INT64)y*runs[i].length;
+	if (in->optr) camRLEStreamMeasures(blob,in->optr,in->oinc,in->opixelSize,x,runs[i].length);
+	if (features) camRLEMomentsAddRun(&blob->moments,x,y,runs[i].length,overlap,neighbours);
+	labels[i]=a;
+    }
+    return 1;
+}
+
+// Fills the blob information (except its id) from its statistics
+static void camRLEStreamBlobInfo(CamBlobInfo *info, CamRLEStreamBlob *blob, int original, int features)
+{
+    info->left=blob->left;
+    info->top=blob->top;
+    info->width=blob->right-blob->left;
+    info->height=blob->bottom-blob->top+1;
+    info->surface=blob->surface;
+    info->cx=(int)(blob->sx/blob->surface);
+    info->cy=(int)(blob->sy/blob->surface);
+    info->value=(original)?(int)(blob->sum/blob->surface):blob->value;
+    info->min=blob->min;
+    info->max=blob->max;
+    info->first=NULL;
+    info->last=NULL;
+    if (features) camRLEMomentsSet(info,&blob->moments);
+}
+
+// Whole image streaming labeling
+// The blobs are numbered in the same order as with camRLELabeling().
+static int camRLEStreamLabeling(CamImage *source, int mode, int threshold, CamTable *LUT, CamImage *original, CamBlobAnalysisResults *results)
+{
+    int y,a,n,ok=1;
+    int nbRuns,nbPrevRuns=0;
+    int features=results->features&CAM_BLOB_MOMENTS;
+    CamRun runsStack[2][CAM_MAX_SCANLINE],*buffer,*runs,*prevRuns,*tmpRuns;
+    int labelsStack[2][CAM_MAX_SCANLINE],*labelBuffer,*labels,*prevLabels,*tmpLabels;
+    CamRLEStreamLabels t={NULL,NULL,0,0,NULL};
+    CamRLEStreamInput in;
+
+    results->nbBlobs=0; // Just in case it would fail...
+    if (!camRLEStreamInit(source,original,&in)) return 0;
+    // The labels are kept in the working memory of the results, reused from one frame to the next
+    t.results=results;
+
+    // Runs and labels of the current and previous lines (on the stack up to CAM_MAX_SCANLINE)
+    buffer=(CamRun*)camInternalScratchAlloc(runsStack,sizeof(runsStack),2*in.width*sizeof(CamRun));
+    labelBuffer=(int*)camInternalScratchAlloc(labelsStack,sizeof(labelsStack),2*in.width*sizeof(int));
+    if ((buffer==NULL)||(labelBuffer==NULL)) {
+	if (buffer) camInternalScratchFree(runsStack,buffer);
+	if (labelBuffer) camInternalScratchFree(labelsStack,labelBuffer);
+	camError("camRLEStreamLabeling","Memory allocation error");
+	return 0;
+    }
+    runs=buffer; prevRuns=buffer+in.width;
+    labels=labelBuffer; prevLabels=labelBuffer+in.width;
+
+    for (y=0; (y<in.height)&&ok; y++) {
+	nbRuns=camRLEStreamEncodeLine(&in,mode,threshold,LUT,runs);
+	ok=camRLEStreamConnect(&t,runs,nbRuns,labels,prevRuns,nbPrevRuns,prevLabels,y,&in,features);
+
+	tmpRuns=prevRuns; prevRuns=runs; runs=tmpRuns;
+	tmpLabels=prevLabels; prevLabels=labels; labels=tmpLabels;
+	nbPrevRuns=nbRuns;
+	in.srcptr+=source->widthStep;
+	if (original) in.optr+=original->widthStep;
+    }
+    camInternalScratchFree(runsStack,buffer);
+    camInternalScratchFree(labelsStack,labelBuffer);
+
+    // Number the remaining roots
+    for (a=0,n=0; a<t.nbLabels; a++) if (t.root[a]==a) n++;
+    if (ok&&(n>results->allocated)) ok=camBlobsReserve(results,n);
+    if (ok) {
+	for (a=0,n=0; a<t.nbLabels; a++) {
+	    if (t.root[a]!=a) continue;
+	    results->blobInfo[n].id=n;
+	    camRLEStreamBlobInfo(&results->blobInfo[n],&t.blobs[a],original!=NULL,features);
+	    n++;
+	}
+	results->nbBlobs=n;
+    }
+    return ok;
+}
+
+int camRLELabelingThreshold(CamImage *source, int threshold, CamImage *original, CamBlobAnalysisResults *results)
+{
+    return camRLEStreamLabeling(source,CAM_RLE_SIMD_THRESHOLD,threshold,NULL,original,results);
+}
+
+int camRLELabelingLUT(CamImage *source, CamTable *LUT, CamImage *original, CamBlobAnalysisResults *results)
+{
+    return camRLEStreamLabeling(source,CAM_RLE_SIMD_VALUE,0,LUT,original,results);
+}
+
+/* Incremental labeling
+ * Same as the streaming labeling, on chunks of rows. After each row, the labels of the open blobs
+ * (the ones having runs on this row) are compacted, and the blobs that have not been continued
+ * on this row are emitted. There are at most 2*width labels at any time (width open blobs, plus
+ * width new ones on the row being labelled), so that the memory does not depend on the image height.
+ */
+typedef struct {
+    CamRun *runs,*prevRuns;	// Runs of the row being labelled and of the last row
+    int *labels,*prevLabels;
+    int nbPrevRuns;
+    int original;		// Measures on an original image
+    CamRLEStreamLabels t;	// Labels of the open blobs
+    CamRLEStreamBlob *spare;	// Compaction buffer
+    int *remap;			// New label of each root, -1 if closed, -2 once emitted
+} CamRLEIncrementalState;
+
+int camRLELabelingStreamAllocate(CamRLELabelingStream *stream, int width, int features)
+{
+    CamRLEIncrementalState *s;
+
+    CAM_CHECK_ARGS(camRLELabelingStreamAllocate,width>0);
+    stream->width=width;
+    stream->y=0;
+    stream->features=features&CAM_BLOB_MOMENTS;
+    stream->nbBlobs=0;
+    stream->state=s=(CamRLEIncrementalState*)malloc(sizeof(CamRLEIncrementalState));
+    if (s) {
+	s->runs=(CamRun*)malloc(2*width*sizeof(CamRun));
+	s->labels=(int*)malloc(2*width*sizeof(int));
+	s->t.root=(int*)malloc(2*width*sizeof(int));
+	s->t.blobs=(CamRLEStreamBlob*)malloc(2*width*sizeof(CamRLEStreamBlob));
+	s->spare=(CamRLEStreamBlob*)malloc(2*width*sizeof(CamRLEStreamBlob));
+	s->remap=(int*)malloc(2*width*sizeof(int));
+	s->prevRuns=(s->runs)?s->runs+width:NULL;
+	s->prevLabels=(s->labels)?s->labels+width:NULL;
+	s->nbPrevRuns=0;
+	s->original=0;
+	s->t.nbLabels=0;
+	s->t.allocated=2*width; // Enough for the open blobs and the new ones of a row : never grown
+	s->t.results=NULL;
+    }
+    if ((s==NULL)||(s->runs==NULL)||(s->labels==NULL)||(s->t.root==NULL)||(s->t.blobs==NULL)||(s->spare==NULL)||(s->remap==NULL)) {
+	camRLELabelingStreamDeallocate(stream);
+	camError("camRLELabelingStreamAllocate","Memory allocation error");
+	return 0;
+    }
+    return 1;
+}
+
+int camRLELabelingStreamDeallocate(CamRLELabelingStream *stream)
+{
+    CamRLEIncrementalState *s=(CamRLEIncrementalState*)stream->state;
+    if (s) {
+	// The current and last rows buffers are allocated at once
+	free((s->runs<s->prevRuns)?s->runs:s->prevRuns);
+	free((s->labels<s->prevLabels)?s->labels:s->prevLabels);
+	free(s->t.root);
+	free(s->t.blobs);
+	free(s->spare);
+	free(s->remap);
+	free(s);
+    }
+    stream->state=NULL;
+    return 1;
+}
+
+// Emits a closed blob
+static int camRLEStreamEmit(CamRLELabelingStream *stream, CamRLEStreamBlob *blob, CamBlobAnalysisResults *closed)
+{
+    if ((closed->nbBlobs==closed->allocated)&&(!camBlobsReserve(closed,(closed->allocated)?closed->allocated*2:CAM_LABEL_MAX_BLOBS))) return 0;
+    closed->blobInfo[closed->nbBlobs].id=stream->nbBlobs++;
+    camRLEStreamBlobInfo(&closed->blobInfo[closed->nbBlobs++],blob,((CamRLEIncrementalState*)stream->state)->original,stream->features);
+    return 1;
+}
+
+// Compacts the labels of the runs of the row just labelled (the open blobs), and emits the blobs of the last row
+// that are not open anymore. With nbRuns==0, all the blobs of the last row are emitted.
+static int camRLEStreamClose(CamRLELabelingStream *stream, CamRLEIncrementalState *s, int nbRuns, CamBlobAnalysisResults *closed)
+{
+    int i,a,m;
+    CamRLEStreamBlob *tmpBlobs;
+
+    for (a=0; a<s->t.nbLabels; a++) s->remap[a]=-1;
+    for (i=0,m=0; i<nbRuns; i++) {
+	if (s->labels[i]<0) continue;
+	a=camRLEStreamFind(s->t.root,s->labels[i]);
+	if (s->remap[a]==-1) {
+	    s->remap[a]=m;
+	    s->spare[m++]=s->t.blobs[a];
+	}
+	s->labels[i]=s->remap[a];
+    }
+    for (i=0; i<s->nbPrevRuns; i++) {
+	if (s->prevLabels[i]<0) continue;
+	a=camRLEStreamFind(s->t.root,s->prevLabels[i]);
+	if (s->remap[a]==-1) {
+	    if (!camRLEStreamEmit(stream,&s->t.blobs[a],closed)) return 0;
+	    s->remap[a]=-2;
+	}
+    }
+    tmpBlobs=s->t.blobs; s->t.blobs=s->spare; s->spare=tmpBlobs;
+    for (a=0; a<m; a++) s->t.root[a]=a;
+    s->t.nbLabels=m;
+    return 1;
+}
+
+static int camRLEStreamRows(CamRLELabelingStream *stream, CamImage *rows, int mode, int threshold, CamTable *LUT, CamImage *original, CamBlobAnalysisResults *closed)
+{
+    int y,nbRuns;
+    int *tmpLabels;
+    CamRun *tmpRuns;
+    CamRLEIncrementalState *s=(CamRLEIncrementalState*)stream->state;
+    CamRLEStreamInput in;
+
+    closed->nbBlobs=0;
+    CAM_CHECK_ARGS(camRLEStreamRows,s!=NULL);
+    if (!camRLEStreamInit(rows,original,&in)) return 0;
+    CAM_CHECK_ARGS(camRLEStreamRows,in.width==stream->width);
+    s->original=(original!=NULL);
+
+    for (y=0; y<in.height; y++) {
+	nbRuns=camRLEStreamEncodeLine(&in,mode,threshold,LUT,s->runs);
+	if (!camRLEStreamConnect(&s->t,s->runs,nbRuns,s->labels,s->prevRuns,s->nbPrevRuns,s->prevLabels,stream->y,&in,stream->features)) return 0;
+	if (!camRLEStreamClose(stream,s,nbRuns,closed)) return 0;
+
+	tmpRuns=s->prevRuns; s->prevRuns=s->runs; s->runs=tmpRuns;
+	tmpLabels=s->prevLabels; s->prevLabels=s->labels; s->labels=tmpLabels;
+	s->nbPrevRuns=nbRuns;
+	stream->y++;
+	in.srcptr+=rows->widthStep;
+	if (original) in.optr+=original->widthStep;
+    }
+    return 1;
+}
+
+int camRLELabelingStreamThreshold(CamRLELabelingStream *stream, CamImage *rows, int threshold, CamImage *original, CamBlobAnalysisResults *closed)
+{
+    return camRLEStreamRows(stream,rows,CAM_RLE_SIMD_THRESHOLD,threshold,NULL,original,closed);
+}
+
+int camRLELabelingStreamLUT(CamRLELabelingStream *stream, CamImage *rows, CamTable *LUT, CamImage *original, CamBlobAnalysisResults *closed)
+{
+    return camRLEStreamRows(stream,rows,CAM_RLE_SIMD_VALUE,0,LUT,original,closed);
+}
+
+int camRLELabelingStreamEnd(CamRLELabelingStream *stream, CamBlobAnalysisResults *closed)
+{
+    CamRLEIncrementalState *s=(CamRLEIncrementalState*)stream->state;
+
+    closed->nbBlobs=0;
+    CAM_CHECK_ARGS(camRLELabelingStreamEnd,s!=NULL);
+    // No more runs : all the open blobs are closed
+    if (!camRLEStreamClose(stream,s,0,closed)) return 0;
+    s->nbPrevRuns=0;
+    stream->y=0;
+    stream->nbBlobs=0;
+    return 1;
+}
+
 #undef CAM_PIXEL
 #define CAM_PIXEL unsigned char
 #define camRLEEncode camRLEEncode8
 #define MAP(x) x
+#define SIMD_PARAMS CAM_RLE_SIMD_VALUE,0,NULL
 #undef PARAM
 #include "cam_RLE_labelling_code.c"
 #undef camRLEEncode
 #undef MAP
+#undef SIMD_PARAMS
 #define camRLEEncode camRLEEncodeLUT8
 #define MAP(x) LUT->t[x]
+#define SIMD_PARAMS CAM_RLE_SIMD_VALUE,0,LUT->t
 #define PARAM CamLUT *LUT
 #include "cam_RLE_labelling_code.c"
 #undef camRLEEncode
 #undef MAP
+#undef SIMD_PARAMS
 #undef PARAM
 #define camRLEEncode camRLEEncodeThreshold8
 #define MAP(x) x>=threshold
+#define SIMD_PARAMS CAM_RLE_SIMD_THRESHOLD,threshold,NULL
 #define PARAM int threshold
 #include "cam_RLE_labelling_code.c"
 #undef camRLEEncode
 #undef MAP
+#undef SIMD_PARAMS
 #undef PARAM
 #define camRLEEncode camRLEEncodeThresholdInv8
 #define MAP(x) x<threshold
+#define SIMD_PARAMS CAM_RLE_SIMD_THRESHOLD_INV,threshold,NULL
 #define PARAM int threshold
 #include "cam_RLE_labelling_code.c"
 #undef camRLEEncode
 #undef MAP
+#undef SIMD_PARAMS
 #undef PARAM
 
 #undef CAM_PIXEL
 #define CAM_PIXEL unsigned short
 #define camRLEEncode camRLEEncode16
 #define MAP(x) x
+#define SIMD_PARAMS CAM_RLE_SIMD_VALUE,0,NULL
 #undef PARAM
 #include "cam_RLE_labelling_code.c"
 #undef camRLEEncode
 #undef MAP
+#undef SIMD_PARAMS
 #define camRLEEncode camRLEEncodeLUT16
 #define MAP(x) LUT->t[x]
+#define SIMD_PARAMS CAM_RLE_SIMD_VALUE,0,LUT->t
 #define PARAM CamLUT *LUT
 #include "cam_RLE_labelling_code.c"
 #undef camRLEEncode
 #undef MAP
+#undef SIMD_PARAMS
 #undef PARAM
 #define camRLEEncode camRLEEncodeThreshold16
 #define MAP(x) x>=threshold
+#define SIMD_PARAMS CAM_RLE_SIMD_THRESHOLD,threshold,NULL
 #define PARAM int threshold
 #include "cam_RLE_labelling_code.c"
 #undef camRLEEncode
 #undef MAP
+#undef SIMD_PARAMS
 #undef PARAM
 #define camRLEEncode camRLEEncodeThresholdInv16
 #define MAP(x) x<threshold
+#define SIMD_PARAMS CAM_RLE_SIMD_THRESHOLD_INV,threshold,NULL
 #define PARAM int threshold
 #include "cam_RLE_labelling_code.c"
 #undef camRLEEncode
 #undef MAP
+#undef SIMD_PARAMS
 #undef PARAM
 
 int camRLEEncode(CamImage *source, CamRLEImage *dest)
@@ -0,0 +1,168 @@
+/***************************************
+ *
+ *  Camellia Image Processing Library
+ *
+
+    The Camellia Image Processing Library is an open source low-level image processing library.
+    As it uses the IplImage structure to describe images, it is a good replacement to the IPL (Intel) library
+    and a good complement to the OpenCV library. It includes a lot of functions for image processing
+    (filtering, morphological mathematics, labeling, warping, loading/saving images, etc.),
+    some of them being highly optimized; It is also cross-platform and robust. It is doxygen-documented
+    and examples of use are provided.
+
+    This software library is an outcome of the Camellia european project (IST-2001-34410).
+    It was developped by the Ecole des Mines de Paris (ENSMP), in coordination with
+    the other partners of the project.
+
+  ==========================================================================
+
+    Copyright (c) 2002-2006, Ecole des Mines de Paris - Centre de Robotique
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer
+          in the documentation and/or other materials provided with the distribution.
+        * Neither the name of the Ecole des Mines de Paris nor the names of
+          its contributors may be used to endorse or promote products
+          derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+    EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+    PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+    PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+    LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  ==========================================================================
+*/
+
+/* RLE Labeling Kernel
+ * AVX2 code */
+
+#include "camellia.h"
+#include "camellia_internals.h"
+#ifdef CAM_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define parent blob
+
+// Index of the lowest bit set
+#ifdef _MSC_VER
+static __inline int camRLEBitScan(unsigned int m) {unsigned long i; _BitScanForward(&i,m); return (int)i;}
+#else
+#define camRLEBitScan(m) __builtin_ctz(m)
+#endif
+
+// Ends the current run at pixel end
+#define CAM_RLE_EMIT(end) \
+    runs[n].value=cur; \
+    runs[n].length=(end)-l; \
+    runs[n].parent=first+n; \
+    runs[n].line=y; \
+    n++; l=(end);
+
+// One bit per 16-bit pixel (32 pixels from two vectors of comparison results)
+#define CAM_RLE_MASK16(a,b) ((unsigned int)_mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(a,b),0xD8)))
+
+// Run-length encoding of a line of 8-bit (pixelSize=1) or 16-bit (pixelSize=2) pixels, 32 pixels at once.
+// The pixels are compared to their left neighbour (CAM_RLE_SIMD_VALUE) or to the threshold, and the runs
+// are emitted by scanning the bits of the transitions : uniform spans cost one compare per 32 pixels.
+CAM_AVX2_TARGET int camInternalRLEEncodeLineAVX2(void *srcptr, int width, int pixelSize, int mode, int threshold, int *LUT, CamRun *runs, int first, int y)
+{
+    unsigned char *p8=(unsigned char*)srcptr;
+    unsigned short *p16=(unsigned short*)srcptr;
+    int x,l=0,n=0,pos,pixel;
+    int maxval=(pixelSize==1)?0xff:0xffff;
+    unsigned int cur,val,m,t,inv=(mode==CAM_RLE_SIMD_THRESHOLD_INV);
+    __m256i th,a,b;
+
+#define CAM_RLE_PIXEL(i) ((pixelSize==1)?p8[i]:p16[i])
+    if (mode!=CAM_RLE_SIMD_VALUE) {
+        // Runs of 0s and 1s
+        if ((threshold<=0)||(threshold>maxval)) {
+            // Uniform line
+            cur=(threshold<=0)^inv;
+            CAM_RLE_EMIT(width);
+            return n;
+        }
+        th=(pixelSize==1)?_mm256_set1_epi8((char)threshold):_mm256_set1_epi16((short)threshold);
+        cur=(CAM_RLE_PIXEL(0)>=threshold)^inv;
+        for (x=0;x+32<=width;x+=32) {
+            if (pixelSize==1) {
+                a=_mm256_loadu_si256((__m256i*)(p8+x));
+                m=(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(a,th),a));
+            } else {
+                a=_mm256_loadu_si256((__m256i*)(p16+x));
+                b=_mm256_loadu_si256((__m256i*)(p16+x+16));
+                m=CAM_RLE_MASK16(_mm256_cmpeq_epi16(_mm256_max_epu16(a,th),a),_mm256_cmpeq_epi16(_mm256_max_epu16(b,th),b));
+            }
+            if (inv) m=~m;
+            // Transitions, cur being the value of the pixel on the left
+            t=m^((m<<1)|cur);
+            while (t) {
+                pos=x+camRLEBitScan(t);
+                CAM_RLE_EMIT(pos);
+                cur^=1;
+                t&=t-1;
+            }
+        }
+        for (;x<width;x++) {
+            val=(CAM_RLE_PIXEL(x)>=threshold)^inv;
+            if (val!=cur) {
+                CAM_RLE_EMIT(x);
+                cur=val;
+            }
+        }
+    } else {
+        // Runs of pixel values, possibly mapped through a LUT. The pixels that differ from their
+        // left neighbour are candidates for a new run (always, without LUT)
+        pixel=CAM_RLE_PIXEL(0);
+        cur=(LUT)?(LUT[pixel]&maxval):pixel;
+        for (x=1;x+32<=width;x+=32) {
+            if (pixelSize==1) {
+                a=_mm256_loadu_si256((__m256i*)(p8+x));
+                b=_mm256_loadu_si256((__m256i*)(p8+x-1));
+                m=~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a,b));
+            } else {
+                a=_mm256_cmpeq_epi16(_mm256_loadu_si256((__m256i*)(p16+x)),_mm256_loadu_si256((__m256i*)(p16+x-1)));
+                b=_mm256_cmpeq_epi16(_mm256_loadu_si256((__m256i*)(p16+x+16)),_mm256_loadu_si256((__m256i*)(p16+x+15)));
+                m=~CAM_RLE_MASK16(a,b);
+            }
+            while (m) {
+                pos=x+camRLEBitScan(m);
+                pixel=CAM_RLE_PIXEL(pos);
+                val=(LUT)?(LUT[pixel]&maxval):pixel;
+                if (val!=cur) {
+                    CAM_RLE_EMIT(pos);
+                    cur=val;
+                }
+                m&=m-1;
+            }
+        }
+        for (;x<width;x++) {
+            pixel=CAM_RLE_PIXEL(x);
+            val=(LUT)?(LUT[pixel]&maxval):pixel;
+            if (val!=cur) {
+                CAM_RLE_EMIT(x);
+                cur=val;
+            }
+        }
+    }
+    CAM_RLE_EMIT(width);
+    return n;
+}
+
+#endif // CAM_AVX2
@@ -8,6 +8,9 @@ int camRLEEncode(CamImage *source, CamRLEImage *dest)
     int width,height;
     CAM_PIXEL *srcptr,m;
     CamRun *newRun;
+#ifdef CAM_AVX2
+    int simd;
+#endif
 
     CamInternalROIPolicyStruct iROI;
     
@@ -33,6 +36,9 @@ int camRLEEncode(CamImage *source, CamRLEImage *dest)
 
     dest->height=height;
     dest->width=width;
+#ifdef CAM_AVX2
+    simd=((camGetCPUFeatures()&CAM_CPU_AVX2)&&(iROI.srcinc==1));
+#endif
 
     // Put a run at the begin to have a reference starting point
     newRun=&dest->runs[0];
@@ -45,30 +51,37 @@ int camRLEEncode(CamImage *source, CamRLEImage *dest)
     // Encode the whole ROI
     for (y=0;y<height;y++) {
 	CAM_PIXEL n;
-	x=0; xp=0;
-	m=MAP(srcptr[xp]);
-	do {
-	    l=x;
-	    x++;
-            xp+=iROI.srcinc;
-	    
-            while (x<width) {
-                n=MAP(srcptr[xp]);
-                if (n==m) {
-                    xp+=iROI.srcinc;
-                    x++;
-                } else break;
-            }
+#ifdef CAM_AVX2
+	if (simd) {
+	    nbRuns+=camInternalRLEEncodeLineAVX2(srcptr,width,sizeof(CAM_PIXEL),SIMD_PARAMS,&dest->runs[nbRuns],nbRuns,y);
+	} else
+#endif
+	{
+	    x=0; xp=0;
+	    m=MAP(srcptr[xp]);
+	    do {
+		l=x;
+		x++;
+		xp+=iROI.srcinc;
+		
+		while (x<width) {
+		    n=MAP(srcptr[xp]);
+		    if (n==m) {
+			xp+=iROI.srcinc;
+			x++;
+		    } else break;
+		}
 
-            newRun=&dest->runs[nbRuns];
-	    newRun->value=m;
-	    newRun->length=x-l;
-	    newRun->parent=nbRuns;
-	    newRun->line=y;
-	    nbRuns++;
-	    
-	    m=n;
-	} while (x<width);	
+		newRun=&dest->runs[nbRuns];
+		newRun->value=m;
+		newRun->length=x-l;
+		newRun->parent=nbRuns;
+		newRun->line=y;
+		nbRuns++;
+		
+		m=n;
+	    } while (x<width);	
+	}
 	if (nbRuns>=dest->allocated-width) {
     	    camRLEReallocate(dest,dest->allocated*2);
             // dest->nbRuns=0;
@@ -1147,3 +1147,132 @@ int camRLEErode3x2(CamRLEImage *source, CamRLEImage *dest)
     return 1;
 }
 
+/* RLE morphology with rectangular structuring elements
+ * The image is processed as rows of intervals : the horizontal pass shrinks or grows each
+ * interval, and the vertical pass intersects (or unites) the rows covered by the structuring
+ * element. The combination of 2^k consecutive rows is obtained from two combinations of 2^(k-1)
+ * rows, so that a structuring element of height h costs log2(h) row combinations per row.
+ * The pixels out of the image are ignored.
+ */
+static int camRLEIntervalsAllocate(CamRLEIntervals *dest, CamRLEIntervals *model)
+{
+    dest->width=model->width;
+    dest->height=model->height;
+    dest->rows=(int*)malloc((model->height+1)*sizeof(int));
+    dest->bounds=NULL;
+    dest->allocated=0;
+    if (dest->rows==NULL) return 0;
+    dest->rows[0]=0;
+    return camInternalRLEIntervalsReserve(dest,model->rows[model->height]+1);
+}
+
+// Row y of dest is the combination of row ya of a and row yb of b (or only row ya of a if yb<0)
+static int camRLEIntervalsCombineRows(CamRLEIntervals *dest, int y, CamRLEIntervals *a, int ya, CamRLEIntervals *b, int yb, int op)
+{
+    int n=dest->rows[y];
+    int na=a->rows[ya+1]-a->rows[ya];
+    int nb=(yb>=0)?b->rows[yb+1]-b->rows[yb]:0;
+    if (!camInternalRLEIntervalsReserve(dest,n+na+nb)) return 0;
+    dest->rows[y+1]=n+camInternalRLECombineIntervals(a->bounds+2*a->rows[ya],na,b->bounds+2*b->rows[(yb>=0)?yb:0],nb,(yb>=0)?op:CAM_RLE_INTERVALS_OR,dest->bounds+2*n);
+    return 1;
+}
+
+static int camRLEMorphoRectPass(CamRLEIntervals *s, int sew, int seh, int ax, int ay, int erode)
+{
+    int x,y,i,n,k,q,lo,hi,nbLevels,ok=1;
+    int op=(erode)?CAM_RLE_INTERVALS_AND:CAM_RLE_INTERVALS_OR;
+    int left=sew-1-ax,right=ax; // Dilation : [start,end[ -> [start-left,end+right[
+    CamRLEIntervals levels[32],res;
+
+    // Horizontal pass, in place
+    if (sew>1) {
+	for (y=0,n=0; y<s->height; y++) {
+	    i=s->rows[y];
+	    s->rows[y]=n;
+	    for (; i<s->rows[y+1]; i++) {
+		if (erode) {
+		    x=(s->bounds[2*i]==0)?0:s->bounds[2*i]+right;
+		    k=(s->bounds[2*i+1]==s->width)?s->width:s->bounds[2*i+1]-left;
+		    if (x>=k) continue;
+		} else {
+		    x=s->bounds[2*i]-left; if (x<0) x=0;
+		    k=s->bounds[2*i+1]+right; if (k>s->width) k=s->width;
+		    if ((n>s->rows[y])&&(x<=s->bounds[2*n-1])) {
+			// Overlaps the previous interval
+			s->bounds[2*n-1]=k;
+			continue;
+		    }
+		}
+		s->bounds[2*n]=x;
+		s->bounds[2*n+1]=k;
+		n++;
+	    }
+	}
+	s->rows[y]=n;
+    }
+    if (seh==1) return 1;
+
+    // Vertical pass : row y of levels[k] is the combination of the rows [y,y+2^k[
+    levels[0]=*s;
+    for (nbLevels=1; ok&&((1<<nbLevels)<=seh); nbLevels++) {
+	q=1<<(nbLevels-1);
+	ok=camRLEIntervalsAllocate(&levels[nbLevels],s);
+	for (y=0; ok&&(y<s->height); y++) {
+	    ok=camRLEIntervalsCombineRows(&levels[nbLevels],y,&levels[nbLevels-1],y,&levels[nbLevels-1],(y+q<s->height)?y+q:-1,op);
+	}
+    }
+
+    // The rows [y-ay,y-ay+seh[ within the image are covered by two overlapping sets of 2^q rows
+    if (ok) ok=camRLEIntervalsAllocate(&res,s); else res.rows=res.bounds=NULL;
+    for (y=0; ok&&(y<s->height); y++) {
+	lo=y-ay; if (lo<0) lo=0;
+	hi=y-ay+seh; if (hi>s->height) hi=s->height;
+	for (q=0; (2<<q)<=hi-lo; q++);
+	ok=camRLEIntervalsCombineRows(&res,y,&levels[q],lo,&levels[q],hi-(1<<q),op);
+    }
+
+    for (k=1; k<nbLevels; k++) camInternalRLEFreeIntervals(&levels[k]);
+    if (!ok) {
+	camInternalRLEFreeIntervals(&res);
+	camError("camRLEMorphoRect","Memory allocation error");
+	return 0;
+    }
+    camInternalRLEFreeIntervals(s);
+    *s=res;
+    return 1;
+}
+
+static int camRLEMorphoRect(CamRLEImage *source, CamRLEImage *dest, int width, int height, int erode, int both)
+{
+    CamRLEIntervals s;
+    int ax=width/2,ay=height/2,ok;
+
+    CAM_CHECK_ARGS(camRLEMorphoRect,(width>0)&&(height>0));
+    if (!camInternalRLEToIntervals(source,&s)) return 0;
+    // Opening and closing : the second pass uses the reflected structuring element
+    ok=camRLEMorphoRectPass(&s,width,height,ax,ay,erode);
+    if (ok&&both) ok=camRLEMorphoRectPass(&s,width,height,width-1-ax,height-1-ay,!erode);
+    if (ok) ok=camInternalRLEFromIntervals(&s,dest);
+    camInternalRLEFreeIntervals(&s);
+    return ok;
+}
+
+int camRLEErodeRect(CamRLEImage *source, CamRLEImage *dest, int width, int height)
+{
+    return camRLEMorphoRect(source,dest,width,height,1,0);
+}
+
+int camRLEDilateRect(CamRLEImage *source, CamRLEImage *dest, int width, int height)
+{
+    return camRLEMorphoRect(source,dest,width,height,0,0);
+}
+
+int camRLEOpenRect(CamRLEImage *source, CamRLEImage *dest, int width, int height)
+{
+    return camRLEMorphoRect(source,dest,width,height,1,1);
+}
+
+int camRLECloseRect(CamRLEImage *source, CamRLEImage *dest, int width, int height)
+{
+    return camRLEMorphoRect(source,dest,width,height,0,1);
+}
@@ -445,11 +445,15 @@ int camRLEBlobMeasures(CamBlobInfo *blob, CamImage *original)
 {
     CamRun *r=blob->first;
     int i,line,counter=0;
-    int posx,width;
+    int posx,width,v;
     int xOffset,yOffset;
-    CAM_PIXEL *ptr;
+    int pixelSize;
+    CAM_INT64 sum=0;
+    unsigned char *ptr;
     
     CAM_CHECK_ARGS(camRLEBlobMeasures,(original->nChannels==1));
+    CAM_CHECK_ARGS(camRLEBlobMeasures,((original->depth&CAM_DEPTH_MASK)>=8)&&((original->depth&CAM_DEPTH_MASK)<=16));
+    pixelSize=((original->depth&CAM_DEPTH_MASK)==8)?1:2;
 
     // Retrieve the width of the image and the position of the run r
     posx=0; 
@@ -478,20 +482,21 @@ int camRLEBlobMeasures(CamBlobInfo *blob, CamImage *original)
         yOffset=0;
         CAM_CHECK_ARGS(camRLEBlobMeasures,(width==original->width));
     }
-    ptr=((CAM_PIXEL*)(original->imageData+(blob->top+yOffset)*original->widthStep))+xOffset+posx;
-    blob->value=0;
     blob->max=-32769;
     blob->min=+65536;
 
     line=0;
-    for (i=0;i<r->length;i++) {
-        blob->value+=*ptr;
-        if (*ptr<blob->min) blob->min=*ptr;
-        if (*ptr>blob->max) blob->max=*ptr;
-        counter++;
-        ptr++;
-    }
-    while (r!=blob->last) {
+    for (;;) {
+        // Each run is read at its own position, as the runs in between belong to other blobs
+        ptr=original->imageData+(blob->top+line+yOffset)*original->widthStep+(xOffset+posx)*pixelSize;
+        for (i=0;i<r->length;i++) {
+            v=(pixelSize==1)?ptr[i]:((unsigned short*)ptr)[i];
+            sum+=v;
+            if (v<blob->min) blob->min=v;
+            if (v>blob->max) blob->max=v;
+        }
+        counter+=r->length;
+        if (r==blob->last) break;
 	posx+=r->length; r++;
 	while (r->blob!=blob->id) {
 	    posx+=r->length; r++;
@@ -500,20 +505,264 @@ int camRLEBlobMeasures(CamBlobInfo *blob, CamImage *original)
 	    // It is a new line
 	    posx-=width;
 	    line++;
-            ptr=((CAM_PIXEL*)(original->imageData+(blob->top+line+yOffset)*original->widthStep))+xOffset+posx;
 	}
-        for (i=0;i<r->length;i++) {
-            blob->value+=*ptr;
-            if (*ptr<blob->min) blob->min=*ptr;
-            if (*ptr>blob->max) blob->max=*ptr;
-            counter++;
-            ptr++;
-        }
-    };
+    }
     
-    blob->value/=counter;
+    blob->value=(int)(sum/counter);
     
     return 1;
 }
 
+/* Binary RLE images as rows of intervals
+ * Used by the RLE morphology and set operations
+ */
+int camInternalRLEIntervalsReserve(CamRLEIntervals *s, int nbIntervals)
+{
+    int *bounds;
+    if (nbIntervals<=s->allocated) return 1;
+    if (nbIntervals<2*s->allocated) nbIntervals=2*s->allocated;
+    bounds=(int*)realloc(s->bounds,2*nbIntervals*sizeof(int));
+    if (bounds==NULL) {
+	camError("camInternalRLEIntervalsReserve","Memory allocation error");
+	return 0;
+    }
+    s->bounds=bounds;
+    s->allocated=nbIntervals;
+    return 1;
+}
+
+void camInternalRLEFreeIntervals(CamRLEIntervals *s)
+{
+    free(s->rows);
+    free(s->bounds);
+    s->rows=NULL;
+    s->bounds=NULL;
+    s->allocated=0;
+}
+
+int camInternalRLEToIntervals(CamRLEImage *src, CamRLEIntervals *dest)
+{
+    int i,x,y,n;
+    CamRun *r;
 
+    dest->width=src->width;
+    dest->height=src->height;
+    dest->rows=(int*)malloc((src->height+1)*sizeof(int));
+    dest->bounds=NULL;
+    dest->allocated=0;
+    if ((dest->rows==NULL)||(!camInternalRLEIntervalsReserve(dest,(src->nbRuns>1)?src->nbRuns:1))) {
+	camInternalRLEFreeIntervals(dest);
+	camError("camInternalRLEToIntervals","Memory allocation error");
+	return 0;
+    }
+    for (i=1,x=0,y=0,n=0; (i<src->nbRuns)&&(y<src->height); i++) {
+	r=&src->runs[i];
+	if (x==0) dest->rows[y]=n;
+	if (r->value) {
+	    if ((n>dest->rows[y])&&(dest->bounds[2*n-1]==x)) {
+		// Adjacent non-zero runs
+		dest->bounds[2*n-1]=x+r->length;
+	    } else {
+		dest->bounds[2*n]=x;
+		dest->bounds[2*n+1]=x+r->length;
+		n++;
+	    }
+	}
+	x+=r->length;
+	if (x>=src->width) {
+	    x=0;
+	    y++;
+	}
+    }
+    for (; y<=src->height; y++) dest->rows[y]=n;
+    return 1;
+}
+
+int camInternalRLEFromIntervals(CamRLEIntervals *src, CamRLEImage *dest)
+{
+    int x,y,i,n,needed;
+    CamRun *r;
+
+    // One run for each interval and for each hole, and the two extra runs
+    needed=2*src->rows[src->height]+src->height+2;
+    if (dest->allocated==0) {
+	if (!camRLEAllocate(dest,needed)) return 0;
+    } else if (dest->allocated<needed) {
+	if (!camRLEReallocate(dest,needed)) return 0;
+    }
+    dest->width=src->width;
+    dest->height=src->height;
+
+    // Put a run at the begin to have a reference starting point
+    r=dest->runs;
+    r->value=-1;
+    r->length=0;
+    r->parent=-1;
+    r->line=-1;
+    n=1;
+
+    #define CAM_RLE_ADD_RUN(v,l) \
+    r=&dest->runs[n]; \
+    r->value=(v); \
+    r->length=(l); \
+    r->parent=n++; \
+    r->line=y;
+
+    for (y=0; y<src->height; y++) {
+	for (i=src->rows[y],x=0; i<src->rows[y+1]; i++) {
+	    if (src->bounds[2*i]>x) {
+		CAM_RLE_ADD_RUN(0,src->bounds[2*i]-x);
+	    }
+	    CAM_RLE_ADD_RUN(1,src->bounds[2*i+1]-src->bounds[2*i]);
+	    x=src->bounds[2*i+1];
+	}
+	if (x<src->width) {
+	    CAM_RLE_ADD_RUN(0,src->width-x);
+	}
+    }
+    #undef CAM_RLE_ADD_RUN
+
+    // Add one last run, just to ease blob analysis/reconstruction
+    r=&dest->runs[n];
+    r->value=-1;
+    r->length=0;
+    r->parent=-1;
+    r->line=-1;
+    dest->nbRuns=n;
+    return 1;
+}
+
+int camInternalRLECombineIntervals(const int *a, int na, const int *b, int nb, int op, int *out)
+{
+    int i=0,j=0,n=0,pos,v,cur=0;
+
+    // The bounds of both rows are merged. After bound i of a, we are in a iff i is odd
+    na*=2; nb*=2;
+    while ((i<na)||(j<nb)) {
+	pos=((j>=nb)||((i<na)&&(a[i]<=b[j])))?a[i]:b[j];
+	while ((i<na)&&(a[i]==pos)) i++;
+	while ((j<nb)&&(b[j]==pos)) j++;
+	v=(op>>(((i&1)<<1)|(j&1)))&1;
+	if (v!=cur) {
+	    out[n++]=pos;
+	    cur=v;
+	}
+    }
+    return n/2;
+}
+
+/* Boolean operations between RLE images
+ * Both run lists are merged row by row : each output run is the overlap of
+ * a run of each source, and consecutive runs with the same value are joined.
+ */
+int camRLEDyadicArithm(CamRLEImage *source1, CamRLEImage *source2, CamRLEImage *dest, int operation)
+{
+    CamRLEImage res,*out;
+    CamRun *a,*b,*r;
+    int x,y,n,la,lb,l,v,needed;
+
+    CAM_CHECK_ARGS(camRLEDyadicArithm,(source1->width==source2->width)&&(source1->height==source2->height));
+    CAM_CHECK_ARGS(camRLEDyadicArithm,(operation>0)&&(operation<16)&&((operation&1)==0));
+
+    // Each output run ends where a run of one of the sources ends
+    needed=source1->nbRuns+source2->nbRuns;
+    if ((dest==source1)||(dest==source2)) {
+	if (!camRLEAllocate(&res,needed)) return 0;
+	out=&res;
+    } else {
+	if (dest->allocated==0) {
+	    if (!camRLEAllocate(dest,needed)) return 0;
+	} else if (dest->allocated<needed) {
+	    if (!camRLEReallocate(dest,needed)) return 0;
+	}
+	out=dest;
+    }
+
+    // Put a run at the begin to have a reference starting point
+    r=out->runs;
+    r->value=-1;
+    r->length=0;
+    r->parent=-1;
+    r->line=-1;
+    n=1;
+
+    a=source1->runs+1;
+    b=source2->runs+1;
+    for (y=0; y<source1->height; y++) {
+	la=a->length;
+	lb=b->length;
+	for (x=0; x<source1->width; x+=l) {
+	    l=(la<lb)?la:lb;
+	    v=(operation>>(((a->value!=0)<<1)|(b->value!=0)))&1;
+	    if ((x!=0)&&(r->value==v)) {
+		r->length+=l;
+	    } else {
+		r=&out->runs[n];
+		r->value=v;
+		r->length=l;
+		r->parent=n++;
+		r->line=y;
+	    }
+	    la-=l; if (la==0) la=(++a)->length;
+	    lb-=l; if (lb==0) lb=(++b)->length;
+	}
+    }
+
+    // Add one last run, just to ease blob analysis/reconstruction
+    r=&out->runs[n];
+    r->value=-1;
+    r->length=0;
+    r->parent=-1;
+    r->line=-1;
+    out->nbRuns=n;
+    out->width=source1->width;
+    out->height=source1->height;
+
+    if (out==&res) {
+	camRLEDeallocate(dest);
+	dest->runs=res.runs;
+	dest->allocated=res.allocated;
+	dest->nbRuns=res.nbRuns;
+	dest->width=res.width;
+	dest->height=res.height;
+    }
+    return 1;
+}
+
+int camRLEBoundingBox(CamRLEImage *image, CamROI *box)
+{
+    CamRun *r=image->runs+1;
+    int i,x=0,y=0,count=0;
+    int left=image->width,top=image->height,right=-1,bottom=-1;
+
+    for (i=1; i<image->nbRuns; i++,r++) {
+	if (r->value) {
+	    count+=r->length;
+	    if (x<left) left=x;
+	    if (x+r->length>right) right=x+r->length;
+	    if (top==image->height) top=y;
+	    bottom=y;
+	}
+	x+=r->length;
+	if (x>=image->width) {
+	    x=0;
+	    y++;
+	}
+    }
+    if (box) {
+	if (count) camSetROI(box,0,left,top,right-left,bottom-top+1);
+	else camSetROI(box,0,0,0,0,0);
+    }
+    return count;
+}
+
+int camRLEPopulationCount(CamRLEImage *image)
+{
+    CamRun *r=image->runs+1;
+    int i,count=0;
+
+    for (i=1; i<image->nbRuns; i++,r++) {
+	if (r->value) count+=r->length;
+    }
+    return count;
+}
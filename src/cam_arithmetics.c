@@ -97,40 +97,43 @@
 #undef camMonadicArithm1U
 #undef camDyadicArithm
 
-int camThreshold(CamImage *source, CamImage *dest,int threshold)
+static int camMonadicArithmSerial(CamImage *source, CamImage *dest, CamArithmParams *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
-	return camThreshold16(source,dest,threshold);
+	return camMonadicArithm16(source,dest,params);
     } else {
-	return camThreshold8(source,dest,threshold);
+	return camMonadicArithm8(source,dest,params);
     }
 }
 
-int camThresholdInv(CamImage *source, CamImage *dest,int thresholdInv)
+CAM_PARALLEL_BANDS_FUNCTION(camMonadicArithm, CamArithmParams*, CAM_BANDS_SUM | CAM_BANDS_INPLACE)
+
+// Not dispatched to camThreshold8(), camAbs16(), etc. which call the serial kernels directly
+int camThreshold(CamImage *source, CamImage *dest,int threshold)
 {
-    if ((source->depth&CAM_DEPTH_MASK)>8) {
-	return camThresholdInv16(source,dest,thresholdInv);
-    } else {
-	return camThresholdInv8(source,dest,thresholdInv);
-    }
+    CamArithmParams params;
+    params.operation=CAM_ARITHM_THRESHOLD;
+    params.c1=threshold;
+    params.c2=0;
+    params.c3=255;
+    return camMonadicArithm(source,dest,&params);
 }
 
-int camAbs(CamImage *source, CamImage *dest)
+int camThresholdInv(CamImage *source, CamImage *dest,int thresholdInv)
 {
-    if ((source->depth&CAM_DEPTH_MASK)>8) {
-	return camAbs16(source,dest);
-    } else {
-	return camAbs8(source,dest);
-    }
+    CamArithmParams params;
+    params.operation=CAM_ARITHM_THRESHOLD;
+    params.c1=thresholdInv;
+    params.c2=255;
+    params.c3=0;
+    return camMonadicArithm(source,dest,&params);
 }
 
-int camMonadicArithm(CamImage *source, CamImage *dest, CamArithmParams *params)
+int camAbs(CamImage *source, CamImage *dest)
 {
-    if ((source->depth&CAM_DEPTH_MASK)>8) {
-	return camMonadicArithm16(source,dest,params);
-    } else {
-	return camMonadicArithm8(source,dest,params);
-    }
+    CamArithmParams params;
+    params.operation=CAM_ARITHM_ABS;
+    return camMonadicArithm(source,dest,&params);
 }
 
 int camAdd(CamImage *source1, CamImage *source2, CamImage *dest) 
@@ -155,7 +158,7 @@ int camSub(CamImage *source1, CamImage *source2, CamImage *dest)
     return camDyadicArithm(source1, source2, dest, &params);
 }
 
-int camDyadicArithm(CamImage *source1, CamImage *source2, CamImage *dest, CamArithmParams *params)
+static int camDyadicArithmSerial(CamImage *source1, CamImage *source2, CamImage *dest, CamArithmParams *params)
 {
     if ((source1->depth&CAM_DEPTH_MASK)>8) {
 	return camDyadicArithm16(source1,source2,dest,params);
@@ -164,6 +167,8 @@ int camDyadicArithm(CamImage *source1, CamImage *source2, CamImage *dest, CamAri
     }
 }
 
+CAM_PARALLEL_BANDS_FUNCTION2(camDyadicArithm, CamArithmParams*, CAM_BANDS_SUM | CAM_BANDS_INPLACE)
+
 #else
 #include "cam_arithmetics_code.c"
 #endif
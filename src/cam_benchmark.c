@@ -164,10 +164,168 @@ int CompareLinearFilters()
     return 0;
 }
 
+// Speedup of the SIMD code path against the C code
+void CompareSIMD(char *name, int (*filter)(CamImage*,CamImage*,CamLinearFilterKernel*), CamImage *source, CamImage *dest, CamLinearFilterKernel *kernel)
+{
+    int i,t1,t2,t3,features;
+
+    features=camGetCPUFeatures();
+    camSetCPUFeatures(0);
+    t1=camGetTimeMs();
+    for (i=0;i<1000;i++) {
+        filter(source,dest,kernel);
+    }
+    t2=camGetTimeMs();
+    camSetCPUFeatures(features);
+    for (i=0;i<1000;i++) {
+        filter(source,dest,kernel);
+    }
+    t3=camGetTimeMs();
+    printf("%s = %dus (C) / %dus (SIMD) : x%.1f\n",name,t2-t1,t3-t2,(t3>t2)?(double)(t2-t1)/(t3-t2):0.0);
+}
+
+void CompareFixedFilterSIMD(char *name, CamImage *source, CamImage *dest, int filter)
+{
+    int i,t1,t2,t3,features;
+
+    features=camGetCPUFeatures();
+    camSetCPUFeatures(0);
+    t1=camGetTimeMs();
+    for (i=0;i<1000;i++) {
+        camFixedFilter(source,dest,filter);
+    }
+    t2=camGetTimeMs();
+    camSetCPUFeatures(features);
+    for (i=0;i<1000;i++) {
+        camFixedFilter(source,dest,filter);
+    }
+    t3=camGetTimeMs();
+    printf("%s = %dus (C) / %dus (SIMD) : x%.1f\n",name,t2-t1,t3-t2,(t3>t2)?(double)(t2-t1)/(t3-t2):0.0);
+}
+
+void CompareMedianFilterSIMD(char *name, int (*filter)(CamImage*,CamImage*), CamImage *source, CamImage *dest)
+{
+    int i,t1,t2,t3,features;
+
+    features=camGetCPUFeatures();
+    camSetCPUFeatures(0);
+    t1=camGetTimeMs();
+    for (i=0;i<1000;i++) {
+        filter(source,dest);
+    }
+    t2=camGetTimeMs();
+    camSetCPUFeatures(features);
+    for (i=0;i<1000;i++) {
+        filter(source,dest);
+    }
+    t3=camGetTimeMs();
+    printf("%s = %dus (C) / %dus (SIMD) : x%.1f\n",name,t2-t1,t3-t2,(t3>t2)?(double)(t2-t1)/(t3-t2):0.0);
+}
+
+void CompareRLEEncodeSIMD(char *name, CamImage *source, CamRLEImage *dest, int threshold)
+{
+    int i,t1,t2,t3,features;
+
+    features=camGetCPUFeatures();
+    camSetCPUFeatures(0);
+    t1=camGetTimeMs();
+    for (i=0;i<1000;i++) {
+        camRLEEncodeThreshold(source,dest,threshold);
+    }
+    t2=camGetTimeMs();
+    camSetCPUFeatures(features);
+    for (i=0;i<1000;i++) {
+        camRLEEncodeThreshold(source,dest,threshold);
+    }
+    t3=camGetTimeMs();
+    printf("%s = %dus (C) / %dus (SIMD) : x%.1f\n",name,t2-t1,t3-t2,(t3>t2)?(double)(t2-t1)/(t3-t2):0.0);
+}
+
+int CompareLinearFiltersSIMD()
+{
+    CamImage source,dest,dest16;
+    CamRLEImage encoded;
+    CamLinearFilterKernel smooth3,smooth5,sobel3,sobel5;
+    const int binomial3[3]={1,2,1};
+    const int binomial[5]={1,4,6,4,1};
+    const int derivative[5]={-1,-2,0,2,1};
+    int i,j,t1,t2;
+
+    camInitBenchmark();
+
+    if (!(camGetCPUFeatures()&CAM_CPU_AVX2)) {
+        printf("AVX2 is not supported by this processor\n");
+        return 0;
+    }
+
+    // Load picture chess.pgm
+    camLoadPGM(&source,"resources/chess.pgm");
+    camAllocateImage(&dest,source.width,source.height,CAM_DEPTH_8U);
+    camAllocateImage(&dest16,source.width,source.height,CAM_DEPTH_16S);
+
+    // Binomial smoothing kernels and Sobel-like derivative kernels
+    for (i=0;i<3;i++) {
+        for (j=0;j<3;j++) {
+            smooth3.kernel[i][j]=binomial3[i]*binomial3[j];
+            sobel3.kernel[i][j]=SOBEL_3x3_V[i][j];
+        }
+    }
+    for (i=0;i<5;i++) {
+        for (j=0;j<5;j++) {
+            smooth5.kernel[i][j]=binomial[i]*binomial[j];
+            sobel5.kernel[i][j]=binomial[i]*derivative[j];
+        }
+    }
+    smooth3.coeff1=1; smooth3.coeff2=4;
+    smooth5.coeff1=1; smooth5.coeff2=8;
+    sobel3.coeff1=1; sobel3.coeff2=0;
+    sobel5.coeff1=1; sobel5.coeff2=0;
+
+    CompareSIMD("Linear filter 3x3 (8U)",camLinearFilter3x3,&source,&dest,&smooth3);
+    CompareSIMD("Linear filter 5x5 (8U)",camLinearFilter5x5,&source,&dest,&smooth5);
+    CompareSIMD("Linear filter abs 3x3 (8U)",camLinearFilterAbs3x3,&source,&dest,&sobel3);
+    CompareSIMD("Linear filter abs 5x5 (8U)",camLinearFilterAbs5x5,&source,&dest,&sobel5);
+    CompareSIMD("Linear filter 3x3 (16S)",camLinearFilter3x3,&source,&dest16,&sobel3);
+    CompareSIMD("Linear filter 5x5 (16S)",camLinearFilter5x5,&source,&dest16,&sobel5);
+    CompareSIMD("Linear filter abs 3x3 (16S)",camLinearFilterAbs3x3,&source,&dest16,&sobel3);
+    CompareSIMD("Linear filter abs 5x5 (16S)",camLinearFilterAbs5x5,&source,&dest16,&sobel5);
+
+    // Separable filters
+    CompareFixedFilterSIMD("Sobel H (16S)",&source,&dest16,CAM_SOBEL_H);
+    CompareFixedFilterSIMD("Sobel V (16S)",&source,&dest16,CAM_SOBEL_V);
+    CompareFixedFilterSIMD("Scharr H (16S)",&source,&dest16,CAM_SCHARR_H);
+    CompareFixedFilterSIMD("Scharr V (16S)",&source,&dest16,CAM_SCHARR_V);
+    CompareFixedFilterSIMD("Gaussian Filter 3x3",&source,&dest,CAM_GAUSSIAN_3x3);
+    CompareFixedFilterSIMD("Gaussian Filter 5x5",&source,&dest,CAM_GAUSSIAN_5x5);
+    CompareFixedFilterSIMD("Gaussian Filter 7x7",&source,&dest,CAM_GAUSSIAN_7x7);
+
+    // Median filters (sorting networks), and constant-time median filter for large neighbourhoods
+    CompareMedianFilterSIMD("Median Filter 3x3",camMedianFilter3x3,&source,&dest);
+    CompareMedianFilterSIMD("Median Filter 5x5",camMedianFilter5x5,&source,&dest);
+    for (i=9;i<=15;i+=6) {
+        t1=camGetTimeMs();
+        for (j=0;j<1000;j++) {
+            camMedianFilterNxN(&source,&dest,i);
+        }
+        t2=camGetTimeMs();
+        printf("Median Filter %dx%d = %dus\n",i,i,t2-t1);
+    }
+
+    // RLE encoding of a thresholded picture
+    camRLEAllocate(&encoded,source.width*source.height+2);
+    CompareRLEEncodeSIMD("RLE Encode Threshold (8U)",&source,&encoded,128);
+    camRLEDeallocate(&encoded);
+
+    camDeallocateImage(&source);
+    camDeallocateImage(&dest);
+    camDeallocateImage(&dest16);
+    return 0;
+}
+
 int CompareMorpho()
 {
     CamImage source,dest;
-    int i,t1,t2;
+    int i,j,t1,t2;
     IplConvKernel *element;
 
     camInitBenchmark();
@@ -236,6 +394,17 @@ int CompareMorpho()
     t2=camGetTimeMs();
     printf("Square3 erosion = %dus\n",t2-t1); 
     camSavePGM(&dest,"output/chess_erode_square3.pgm");
+
+    // Rectangle erosion (van Herk/Gil-Werman) : constant time per pixel whatever the size
+    for (j=3;j<=31;j=j*2+1) {
+        t1=camGetTimeMs();
+        for (i=0;i<1000;i++) {
+            camErodeRect(&source,&dest,j,j);
+        }
+        t2=camGetTimeMs();
+        printf("Rect %dx%d erosion = %dus\n",j,j,t2-t1);
+    }
+    camSavePGM(&dest,"output/chess_erode_rect31.pgm");
    
     camDeallocateImage(&source);
     camDeallocateImage(&dest);
@@ -456,11 +625,108 @@ void CompareUndistort()
     camDeallocateImage(&dest);
 }
 
+// Recall (exact nearest neighbour found) against time of the approximate keypoints searches, on the yalefaces data
+int CompareKeypointsIndex()
+{
+    CamImage image;
+    CamKeypoints models[15],targets[150],*pmodels[15];
+    CamKeypointsDatabase db={0};
+    CamKeypointsIndex index;
+    CamFPKdTreeNode *kdTree;
+    CamKeypoint *p;
+    char filename[256];
+    char *feature[]={"centerlight","glasses","happy","leftlight","noglasses","rightlight","sad","sleepy","surprised","wink"};
+    const int depths[2]={CAM_DEPTH_32S,CAM_DEPTH_8U};
+    const int checks[7]={16,32,64,128,256,512,1024};
+    int *best,*dist1,*dist2,*exact;
+    int i,c,d,k,n,nbPoints=0,good,t1,t2;
+
+    camInitBenchmark();
+
+    for (i=0;i<15;i++) {
+        sprintf(filename,"resources/yalefaces/subject%02d.normal.pgm",i+1);
+        image.imageData=NULL;
+        camLoadPGM(&image,filename);
+        camAllocateKeypoints(&models[i],10000);
+        models[i].id=i;
+        camFastHessianDetector(&image,&models[i],100,CAM_UPRIGHT);
+        camDeallocateImage(&image);
+        pmodels[i]=&models[i];
+    }
+    for (i=0;i<150;i++) {
+        sprintf(filename,"resources/yalefaces/subject%02d.%s.pgm",i/10+1,feature[i%10]);
+        image.imageData=NULL;
+        camLoadPGM(&image,filename);
+        camAllocateKeypoints(&targets[i],10000);
+        camFastHessianDetector(&image,&targets[i],100,CAM_UPRIGHT);
+        camDeallocateImage(&image);
+        nbPoints+=targets[i].nbPoints;
+    }
+    best=(int*)malloc(nbPoints*sizeof(int)*4);
+    dist1=best+nbPoints;
+    dist2=dist1+nbPoints;
+    exact=dist2+nbPoints;
+
+    for (d=0;d<2;d++) {
+        // Brute force (exact) nearest neighbours
+        camKeypointsCompileDatabase(&db,pmodels,15,depths[d]);
+        t1=camGetTimeMs();
+        for (i=0,n=0;i<150;n+=targets[i].nbPoints,i++) {
+            camKeypointsDatabaseNearest(&targets[i],&db,best+n,dist1+n,dist2+n);
+        }
+        t2=camGetTimeMs();
+        for (n=0;n<nbPoints;n++) exact[n]=dist1[n];
+        printf("%d queries in %d rows (%d-bit) : brute force = %dms\n",nbPoints,db.nbPoints,depths[d]&0xff,t2-t1);
+
+        // Randomized kd-trees
+        camKeypointsCompileIndex(&index,&db,4);
+        for (k=0;k<7;k++) {
+            good=0;
+            t1=camGetTimeMs();
+            for (i=0,n=0;i<150;i++) {
+                for (c=0;c<targets[i].nbPoints;c++,n++) {
+                    camFindKeypointIndex(targets[i].keypoint[c],&index,checks[k],dist1,dist2);
+                    if (*dist1==exact[n]) good++;
+                }
+            }
+            t2=camGetTimeMs();
+            printf("Randomized kd-trees (4 trees, %4d checks) : recall = %.1f%% (%dms)\n",checks[k],good*100.0/nbPoints,t2-t1);
+        }
+        camFreeKeypointsIndex(&index);
+        camFreeKeypointsDatabase(&db);
+
+        // Former single kd-tree (full precision descriptors)
+        if (depths[d]==CAM_DEPTH_32S) {
+            kdTree=camKeypointsCompileKdTree(pmodels,15);
+            for (k=0;k<7;k++) {
+                good=0;
+                t1=camGetTimeMs();
+                for (i=0,n=0;i<150;i++) {
+                    for (c=0;c<targets[i].nbPoints;c++,n++) {
+                        p=camFindKeypointKdTree(targets[i].keypoint[c],kdTree,checks[k],dist1,dist2);
+                        if (p && *dist1==exact[n]) good++;
+                    }
+                }
+                t2=camGetTimeMs();
+                printf("Single kd-tree (explore = %4d) : recall = %.1f%% (%dms)\n",checks[k],good*100.0/nbPoints,t2-t1);
+            }
+            free(kdTree);
+        }
+    }
+
+    free(best);
+    for (i=0;i<15;i++) camFreeKeypoints(&models[i]);
+    for (i=0;i<150;i++) camFreeKeypoints(&targets[i]);
+    return 0;
+}
+
 int main()
 {
     CompareLinearFilters();
+    CompareLinearFiltersSIMD();
     CompareMorpho();
     CompareBinary();
     CompareUndistort();
+    CompareKeypointsIndex();
     return 0;
 }
@@ -50,6 +50,7 @@
  * C code */
 #include <stdlib.h>
 #include "camellia.h"
+#include "camellia_internals.h"
 
 /* v1.1 : 1st of November 2002 
  *	- Divided blob analysis into two functions (1stScan and Refinement)
@@ -60,6 +61,62 @@
  * v1.3 : 28th of July 2003
  *	- Added holes parameter to camBlobAnalysis1stScan
  */
+int camBlobsAllocate(CamBlobs *blobs, int capacity)
+{
+    blobs->nbBlobs=0;
+    blobs->features=0;
+    blobs->scratch=NULL;
+    blobs->scratchSize=0;
+    blobs->blobInfo=(CamBlobInfo*)malloc(sizeof(CamBlobInfo)*capacity);
+    if (blobs->blobInfo==NULL) {
+	blobs->allocated=0;
+	camError("camBlobsAllocate","Memory allocation error");
+	return 0;
+    }
+    blobs->allocated=capacity;
+    return 1;
+}
+
+int camBlobsReserve(CamBlobs *blobs, int capacity)
+{
+    CamBlobInfo *blobInfo;
+    if (capacity<=blobs->allocated) return 1;
+    blobInfo=(CamBlobInfo*)realloc(blobs->blobInfo,sizeof(CamBlobInfo)*capacity);
+    if (blobInfo==NULL) {
+	camError("camBlobsReserve","Memory allocation error");
+	return 0;
+    }
+    blobs->blobInfo=blobInfo;
+    blobs->allocated=capacity;
+    return 1;
+}
+
+int camBlobsDeallocate(CamBlobs *blobs)
+{
+    if (blobs->blobInfo) free(blobs->blobInfo);
+    blobs->blobInfo=NULL;
+    blobs->allocated=0;
+    blobs->nbBlobs=0;
+    if (blobs->scratch) free(blobs->scratch);
+    blobs->scratch=NULL;
+    blobs->scratchSize=0;
+    return 1;
+}
+
+void *camInternalBlobsScratch(CamBlobs *blobs, int size)
+{
+    void *scratch;
+    if (size<=blobs->scratchSize) return blobs->scratch;
+    scratch=realloc(blobs->scratch,size);
+    if (scratch==NULL) {
+	camError("camBlobAnalysis","Memory allocation error");
+	return NULL;
+    }
+    blobs->scratch=scratch;
+    blobs->scratchSize=size;
+    return scratch;
+}
+
 // This function can work when "original" parameter is set to NULL. It won't compute the value pixel value for the blobs
 int camBlobAnalysis1stScan(CamImage *blobImage, CamImage *original, CamLabellingResults *info, CamBlobAnalysisResults *results)
 {
@@ -69,10 +126,14 @@ int camBlobAnalysis1stScan(CamImage *blobImage, CamImage *original, CamLabelling
     CAM_PIXEL *origptr,*origtmpptr,valpix;
     CamBlobInfo *blobInfo;
     int *equivTable=info->equiv;
-    int labelToBlob[CAM_LABEL_MAX_BLOBS];
+    int *labelToBlob;
     int nbBlobs=0;
 
+    results->nbBlobs=0;
+
     // Algorithm initialization
+    labelToBlob=(int*)camInternalBlobsScratch(results,info->nbLabels*sizeof(int));
+    if (labelToBlob==NULL) return 0;
     for (i=0;i<info->nbLabels;i++) {
 	labelToBlob[i]=-1;
     }
@@ -108,6 +169,9 @@ int camBlobAnalysis1stScan(CamImage *blobImage, CamImage *original, CamLabelling
 	    // Is this label associated to a blob?
 	    if (labelToBlob[p]<0) {
 		// No! Let's create a new blob
+		if (nbBlobs==results->allocated) {
+		    if (!camBlobsReserve(results,(results->allocated)?results->allocated*2:CAM_LABEL_MAX_BLOBS)) return 0;
+		}
 		*blobimptr=nbBlobs;
 		labelToBlob[p]=nbBlobs;
 		blobInfo=&results->blobInfo[nbBlobs++];
@@ -56,17 +56,21 @@
 #ifndef CAM_INLINED
 #define CAM_INLINED
 
-static int camDrawCircleData[1024]={0};
+static int camDrawCircleData[1024];
+static CamInternalOnce camDrawCircleOnce=CAM_ONCE_INIT;
 
-int camDrawCircleInit(void)
+static void camDrawCircleInitOnce(void)
 {
     int i;
-    if (camDrawCircleData[0]==0) {
-        for (i=0;i<1024;i++) {
-            double x=((double)i)/1024;
-            camDrawCircleData[i]=(int)(sqrt(1-x*x)*1024+0.5);
-        }
+    for (i=0;i<1024;i++) {
+        double x=((double)i)/1024;
+        camDrawCircleData[i]=(int)(sqrt(1-x*x)*1024+0.5);
     }
+}
+
+int camDrawCircleInit(void)
+{
+    camInternalOnce(&camDrawCircleOnce,camDrawCircleInitOnce);
     return 1;
 }
 
@@ -619,9 +623,7 @@ int camDrawCircle(CamImage *image, int xc, int yc, int radius, int color)
     if (radius==0) return 1;
     
     if (radius>0) {
-        if (camDrawCircleData[0]==0) {
-            camDrawCircleInit();
-        }
+        camDrawCircleInit();
         
         incx=iROI.srcinc;
         incy=iROI.srclinc;
@@ -707,9 +709,7 @@ int camDrawEllipse(CamImage *image, int xc, int yc, int rx, int ry, int color)
     CAM_CHECK(camDrawLine,camInternalROIPolicy(image, NULL, &iROI, 0));
     if ((rx==0)||(ry==0)) return 1;    
 
-    if (camDrawCircleData[0]==0) {
-        camDrawCircleInit();
-    }
+    camDrawCircleInit();
     
     incx=iROI.srcinc;
     incy=iROI.srclinc;
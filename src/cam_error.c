@@ -50,6 +50,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "camellia.h"
+#include "camellia_internals.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -91,7 +92,7 @@ BOOL GetProcAddresses( HINSTANCE *hLibrary,
 }
 #endif
 
-static char error[256]="";
+static CAM_THREAD_LOCAL char error[256]="";
 
 void camSetErrorStr(const char *str)
 {
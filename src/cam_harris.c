@@ -71,6 +71,7 @@ int camHarris(CamImage *source, CamKeypoints *points, int k)
 	}
     }
     points->nbPoints = 0;
+    points->qnbPoints = 0; // The quantized descriptors are outdated
 
     params.operation = CAM_ARITHM_MUL;
 
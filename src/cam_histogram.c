@@ -294,20 +294,21 @@ int camHistogram2Channels(CamImage *image, int ch1, int ch2, CamImage *result, i
     unsigned short *dest16;
     int s,valmax;
     CamInternalROIPolicyStruct iROI1,iROI2;
-    CamROI *oldROI,roi;
+    CamROI roi;
+    CamImage channel;
 
-    oldROI=image->roi;
-    if (oldROI) {
-        roi=*oldROI;
+    if (image->roi) {
+        roi=*image->roi;
     } else {
         camSetROI(&roi,0,0,0,image->width,image->height);
     }
+    // The channel ROI is set on a copy of the header, so that the image itself is never modified
+    channel=*image;
+    channel.roi=&roi;
     roi.coi=ch1;
-    image->roi=&roi;
-    CAM_CHECK(camHistogram2Channels,camInternalROIPolicy(image, NULL, &iROI1, 0));
+    CAM_CHECK(camHistogram2Channels,camInternalROIPolicy(&channel, NULL, &iROI1, 0));
     roi.coi=ch2;
-    CAM_CHECK(camHistogram2Channels,camInternalROIPolicy(image, NULL, &iROI2, 0));
-    image->roi=oldROI;
+    CAM_CHECK(camHistogram2Channels,camInternalROIPolicy(&channel, NULL, &iROI2, 0));
 
     // Automatic memory allocation
     if (result->imageData==NULL) {
@@ -143,7 +143,7 @@ static unsigned short cam_sqrt(long carre)
     return sqrt_tab[carre];
 }
 
-int camRGB2HLS(CamImage *source, CamImage *dest)
+static int camRGB2HLSSerial(CamImage *source, CamImage *dest)
 {
     int x,y,width,height;
     int re,im,md;
@@ -233,6 +233,8 @@ int camRGB2HLS(CamImage *source, CamImage *dest)
     return 1;
 }
 
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camRGB2HLS, 0)
+
 /* HLS to pseudo colors conversion
 
 #define SAT_MIN_RED	25
@@ -55,11 +55,11 @@
 #include "camellia_internals.h"
 
 #ifdef CAM_VECTORIZE
-typedef unsigned long v4si __attribute__ ((vector_size(16)));
+typedef unsigned int v4si __attribute__ ((vector_size(16)));
 union i4vector 
 {
   v4si v;
-  unsigned long i[4];
+  unsigned int i[4];
 };
 #endif
 
@@ -79,7 +79,7 @@ union i4vector
 #include "cam_integralimage.c"
 #undef camIntegralImage
   
-int camIntegralImage(CamImage *src, CamImage *dest)
+static int camIntegralImageSerial(CamImage *src, CamImage *dest)
 {
   if ((src->depth&CAM_DEPTH_MASK)>8) {
 	return camIntegralImage16(src, dest);
@@ -88,6 +88,87 @@ int camIntegralImage(CamImage *src, CamImage *dest)
     }
 }
 
+/* Band-parallel integral image
+ * Each band is first integrated on its own. The last lines of the bands are then accumulated
+ * from top to bottom, and each band finally adds the last line of the band above to its other lines.
+ */
+typedef struct {
+    CamImage *src;
+    CamImage *dest;
+    CamInternalROIPolicyStruct iROI;
+    int nbBands;
+    int results[CAM_MAX_THREADS];
+} CamIntegralImageJob;
+
+#define CAM_INTEGRAL_LINE(job, y) ((unsigned int*)((job)->iROI.dstptr + (y) * (job)->dest->widthStep))
+#define CAM_INTEGRAL_BAND_START(job, index) ((job)->iROI.srcroi.height * (index) / (job)->nbBands)
+
+static void camIntegralImageBand(void *arg, int index)
+{
+    CamIntegralImageJob *job = (CamIntegralImageJob*)arg;
+    CamImage src = *job->src, dest = *job->dest;
+    CamROI srcroi = job->iROI.srcroi, dstroi = job->iROI.dstroi;
+    int y0 = CAM_INTEGRAL_BAND_START(job, index);
+    int y1 = CAM_INTEGRAL_BAND_START(job, index + 1);
+
+    srcroi.yOffset += y0; srcroi.height = y1 - y0;
+    dstroi.yOffset += y0; dstroi.height = y1 - y0;
+    src.roi = &srcroi;
+    dest.roi = &dstroi;
+    job->results[index] = camIntegralImageSerial(&src, &dest);
+}
+
+static void camIntegralImageFixBand(void *arg, int index)
+{
+    CamIntegralImageJob *job = (CamIntegralImageJob*)arg;
+    int x, y, width = job->iROI.srcroi.width;
+    int y0 = CAM_INTEGRAL_BAND_START(job, index);
+    int y1 = CAM_INTEGRAL_BAND_START(job, index + 1);
+    unsigned int *above, *dstptr;
+
+    if (index == 0) return;
+    // The last line of the band is already done
+    above = CAM_INTEGRAL_LINE(job, y0 - 1);
+    for (y = y0; y < y1 - 1; y++) {
+	dstptr = CAM_INTEGRAL_LINE(job, y);
+	for (x = 0; x < width; x++) dstptr[x] += above[x];
+    }
+}
+
+int camIntegralImage(CamImage *src, CamImage *dest)
+{
+    CamIntegralImageJob job;
+    int i, x, width;
+    unsigned int *above, *dstptr;
+
+    if ((src->imageData != NULL) && (dest->imageData == NULL)) {
+        // Automatic allocation
+        camAllocateImage(dest, src->width, src->height, CAM_DEPTH_32U);
+    }
+    job.nbBands = camGetNumThreads();
+    if ((job.nbBands > 1) && ((dest->depth & CAM_DEPTH_MASK) == 32) && (camInternalROIPolicy(src, dest, &job.iROI, 0))) {
+	camInternalROIPolicyExit(&job.iROI);
+	if (job.nbBands > job.iROI.srcroi.height / CAM_MIN_BAND_HEIGHT) job.nbBands = job.iROI.srcroi.height / CAM_MIN_BAND_HEIGHT;
+	if (job.nbBands > 1) {
+	    job.src = src;
+	    job.dest = dest;
+	    camInternalParallelRun(camIntegralImageBand, &job, job.nbBands);
+	    for (i = 0; i < job.nbBands; i++) {
+		if (!job.results[i]) return 0;
+	    }
+	    width = job.iROI.srcroi.width;
+	    for (i = 1; i < job.nbBands; i++) {
+		above = CAM_INTEGRAL_LINE(&job, CAM_INTEGRAL_BAND_START(&job, i) - 1);
+		dstptr = CAM_INTEGRAL_LINE(&job, CAM_INTEGRAL_BAND_START(&job, i + 1) - 1);
+		for (x = 0; x < width; x++) dstptr[x] += above[x];
+	    }
+	    camInternalParallelRun(camIntegralImageFixBand, &job, job.nbBands);
+	    return 1;
+	}
+    }
+    return camIntegralImageSerial(src, dest);
+}
+
 #else
 #include "cam_integralimage.c"
 #endif
@@ -99,9 +180,9 @@ int camIntegralImage(CamImage *src, CamImage *dest)
     int x, y;
     int width, height;
     CAM_PIXEL *srcptr, *srctmpptr;
-    unsigned long *dstptr, *dsttmpptr;
+    unsigned int *dstptr, *dsttmpptr;
     CamInternalROIPolicyStruct iROI;
-    unsigned long val;
+    unsigned int val;
 #ifdef CAM_VECTORIZE
     int i;
     union i4vector v1, v2;
@@ -124,7 +205,7 @@ int camIntegralImage(CamImage *src, CamImage *dest)
     width = iROI.srcroi.width;
     height = iROI.srcroi.height;
     srcptr = (CAM_PIXEL*)iROI.srcptr;
-    dstptr = (unsigned long*)iROI.dstptr;
+    dstptr = (unsigned int*)iROI.dstptr;
     srctmpptr = srcptr;
     dsttmpptr = dstptr;
     val = 0;	
@@ -133,17 +214,17 @@ int camIntegralImage(CamImage *src, CamImage *dest)
 	*dstptr = val; 
     }
     srcptr = (CAM_PIXEL*)(((char*)srctmpptr) + src->widthStep);
-    dstptr = (unsigned long*)(((char*)dsttmpptr) + dest->widthStep);
+    dstptr = (unsigned int*)(((char*)dsttmpptr) + dest->widthStep);
     for (y = 1; y < height; y++) {
 	srctmpptr = srcptr;
 	dsttmpptr = dstptr;
 	val = 0;	
 	for (x = 0; x < width; x++, srcptr += iROI.srcinc, dstptr++) {
 	    val += *srcptr;
-	    *dstptr = val + *(unsigned long*)(((char*)dstptr) - dest->widthStep); 
+	    *dstptr = val + *(unsigned int*)(((char*)dstptr) - dest->widthStep); 
 	}
 	srcptr = (CAM_PIXEL*)(((char*)srctmpptr) + src->widthStep);
-	dstptr = (unsigned long*)(((char*)dsttmpptr) + dest->widthStep);
+	dstptr = (unsigned int*)(((char*)dsttmpptr) + dest->widthStep);
     }
 */
 
@@ -152,7 +233,7 @@ int camIntegralImage(CamImage *src, CamImage *dest)
     width = iROI.srcroi.width;
     height = iROI.srcroi.height;
     srcptr = (CAM_PIXEL*)iROI.srcptr;
-    dstptr = (unsigned long*)iROI.dstptr;
+    dstptr = (unsigned int*)iROI.dstptr;
     for (y = 0; y < height; y++) {
 	srctmpptr = srcptr;
 	dsttmpptr = dstptr;
@@ -162,31 +243,31 @@ int camIntegralImage(CamImage *src, CamImage *dest)
 	    *dstptr = val; 
 	}
 	srcptr = (CAM_PIXEL*)(((char*)srctmpptr) + src->widthStep);
-	dstptr = (unsigned long*)(((char*)dsttmpptr) + dest->widthStep);
+	dstptr = (unsigned int*)(((char*)dsttmpptr) + dest->widthStep);
     }
 
 #ifndef CAM_VECTORIZE
     // Second pass 
-    dstptr = (unsigned long*)iROI.dstptr;
-    dstptr = (unsigned long*)(((char*)dstptr) + dest->widthStep);
+    dstptr = (unsigned int*)iROI.dstptr;
+    dstptr = (unsigned int*)(((char*)dstptr) + dest->widthStep);
     for (y = 1; y < height; y++) {
 	dsttmpptr = dstptr;
 	for (x = 0; x < width; x++, dstptr++) {
-	    *dstptr += *(unsigned long*)(((char*)dstptr) - dest->widthStep); 
+	    *dstptr += *(unsigned int*)(((char*)dstptr) - dest->widthStep); 
 	}
-	dstptr = (unsigned long*)(((char*)dsttmpptr) + dest->widthStep);
+	dstptr = (unsigned int*)(((char*)dsttmpptr) + dest->widthStep);
     }
 #else
     // Second pass / SSE2 vectorized
-    dstptr = (unsigned long*)iROI.dstptr;
-    dstptr = (unsigned long*)(((char*)dstptr) + dest->widthStep);
+    dstptr = (unsigned int*)iROI.dstptr;
+    dstptr = (unsigned int*)(((char*)dstptr) + dest->widthStep);
     for (y = 1; y < height; y++) {
 	dsttmpptr = dstptr;
 	for (x = 0; x < width; x+=4) {
 	    // Add 4 pixels at once
 	    for (i = 0; i != 4; i++, dstptr++) {
 		v1.i[i] = *dstptr;
-	        v2.i[i] = *(unsigned long*)(((char*)dstptr) - dest->widthStep);	
+	        v2.i[i] = *(unsigned int*)(((char*)dstptr) - dest->widthStep);	
 	    }
 	    v1.v = v1.v + v2.v;
 	    dstptr -= (iROI.dstinc<<2);
@@ -194,9 +275,9 @@ int camIntegralImage(CamImage *src, CamImage *dest)
 
 	}
 	for (; x < width; x++, dstptr += iROI.dstinc) {
-	    *dstptr += *(unsigned long*)(((char*)dstptr) - dest->widthStep); 
+	    *dstptr += *(unsigned int*)(((char*)dstptr) - dest->widthStep); 
 	}
-	dstptr = (unsigned long*)(((char*)dsttmpptr) + dest->widthStep);
+	dstptr = (unsigned int*)(((char*)dsttmpptr) + dest->widthStep);
     }
 #endif
 
@@ -50,6 +50,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #include "camellia.h"
 #include "camellia_internals.h"
 
@@ -543,3 +552,51 @@ int camLoadBMP(CamImage *im, char *fn)
     fclose (f);
     return 1;
 }
+
+/* Read-only file mapping. The pages are shared by all the processes mapping the same file
+ */
+void *camInternalMapFile(const char *filename, CAM_INT64 *size)
+{
+    void *map;
+#ifdef _WIN32
+    HANDLE file, mapping;
+    LARGE_INTEGER fileSize;
+
+    file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+	CloseHandle(file);
+	return NULL;
+    }
+    mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) return NULL;
+    map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping); // The view keeps the mapping alive
+    *size = fileSize.QuadPart;
+#else
+    int fd;
+    struct stat st;
+
+    fd = open(filename, O_RDONLY);
+    if (fd == -1) return NULL;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+	close(fd);
+	return NULL;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (map == MAP_FAILED) return NULL;
+    *size = st.st_size;
+#endif
+    return map;
+}
+
+void camInternalUnmapFile(void *map, CAM_INT64 size)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(map);
+#else
+    munmap(map, (size_t)size);
+#endif
+}
@@ -62,9 +62,10 @@
 
 #define SEPARATED_NORMALIZATION
 //#define SURF_DESCRIPTOR
-static int camPatchSizeParam = 8*3;
-static int camSigmaParam = 5;
-static int camThreshGradientParam = 128;
+// The parameters are set per thread, so that several detectors can run at once with their own settings
+static CAM_THREAD_LOCAL int camPatchSizeParam = 8*3;
+static CAM_THREAD_LOCAL int camSigmaParam = 5;
+static CAM_THREAD_LOCAL int camThreshGradientParam = 128;
 
 int camKeypointsSetParameters(int patchSize, int sigma, int threshGradient)
 {
@@ -83,6 +84,10 @@ int camAllocateKeypoints(CamKeypoints *fpoints, int nbPoints)
     fpoints->cy = 0;
     fpoints->keypoint = (CamKeypoint**)malloc(sizeof(CamKeypoint*) * nbPoints);
     fpoints->bag = NULL;
+    fpoints->qdepth = 0;
+    fpoints->qsize = 0;
+    fpoints->qnbPoints = 0;
+    fpoints->qdescriptors = NULL;
     if (fpoints->keypoint == NULL) {
 	fpoints->allocated = 0;
 	camError("camAllocateKeypoints", "Memory allocation error");
@@ -102,6 +107,7 @@ int camReallocateKeypoints(CamKeypoints *fpoints, int nbPoints)
     fpoints->keypoint = (CamKeypoint**)realloc(fpoints->keypoint, sizeof(CamKeypoint*) * nbPoints);
     if (fpoints->keypoint == NULL) {
 	fpoints->nbPoints = 0;
+	fpoints->qnbPoints = 0;
 	fpoints->allocated = 0;
 	camError("camKeypointsReallocate", "Memory allocation error");
 	return 0;
@@ -116,8 +122,13 @@ int camFreeKeypoints(CamKeypoints *fpoints)
     CAM_CHECK_ARGS(camKeypointsDeallocate, fpoints != NULL);
     if (fpoints->keypoint) free(fpoints->keypoint);
     if (fpoints->bag) free(fpoints->bag);
+    if (fpoints->qdescriptors) free(fpoints->qdescriptors);
     fpoints->keypoint = NULL;
     fpoints->bag = NULL;
+    fpoints->qdepth = 0;
+    fpoints->qsize = 0;
+    fpoints->qnbPoints = 0;
+    fpoints->qdescriptors = NULL;
     fpoints->nbPoints = 0;
     fpoints->allocated = 0;
     return 1;
@@ -137,7 +148,7 @@ int camFastHessianDetectorFixedScale(CamImage *integral, CamImage *dest, int sca
 {
     int x, y;
     int width, height;
-    unsigned long *srcptr, *tmpsrcptr;
+    unsigned int *srcptr, *tmpsrcptr;
     signed short *dstptr, *tmpdstptr;
     CamInternalROIPolicyStruct iROI;
     int acc=0, det, coeff;
@@ -167,7 +178,7 @@ int camFastHessianDetectorFixedScale(CamImage *integral, CamImage *dest, int sca
     width = iROI.srcroi.width;
     height = iROI.srcroi.height;
     CAM_CHECK_ARGS2(camFastHessianDetectorFixedScale, (width & 3) == 0 && (height & 3) == 0, "ROI width and height must be multiple of 4");
-    srcptr = (unsigned long *)iROI.srcptr;
+    srcptr = (unsigned int *)iROI.srcptr;
     dstptr = (unsigned short *)iROI.dstptr;
 
     INIT_MASK_MANAGEMENT;
@@ -271,7 +282,7 @@ int camFastHessianDetectorFixedScale(CamImage *integral, CamImage *dest, int sca
 		for (; x < endx ; x += (1 << CamSampling[scale]), srcptr += (1 << CamSampling[scale]), dstptr++ ) *dstptr = 0;
 	    }
         END_MASK_MANAGEMENT;
-	srcptr = (unsigned long*)(((char*)tmpsrcptr) + integral->widthStep);
+	srcptr = (unsigned int*)(((char*)tmpsrcptr) + integral->widthStep);
 	if ((y & sampling_mask) == CamSamplingOffset[scale])
 	    dstptr = (unsigned short*)(((char*)tmpdstptr) + dest->widthStep);
     }
@@ -513,7 +524,7 @@ int camKeypointOrientation(CamImage *source, CamKeypoint *point, CamImage *filte
 			    }
 			} else {
 			    // Add a new keypoint 
-			    if (points->keypoint[points->nbPoints - 1] - points->bag != points->allocated) {
+			    if ((points->nbPoints < points->allocated) && (points->keypoint[points->nbPoints - 1] - points->bag < points->allocated - 1)) {
 				points->keypoint[points->nbPoints] = points->keypoint[points->nbPoints - 1] + 1;
 				*points->keypoint[points->nbPoints] = *point;
 				points->keypoint[points->nbPoints]->angle = angle;
@@ -531,8 +542,9 @@ int camKeypointOrientation(CamImage *source, CamKeypoint *point, CamImage *filte
 }
 
 static int camFPNbAttPoints[20 * 20], camFPAttPoint[20 * 20 * 4], camFPCoeff[20 * 20 * 4];
+static CamInternalOnce camFPOnce = CAM_ONCE_INIT;
 
-void camKeypointsInternalsPrepareDescriptor()
+static void camKeypointsInternalsPrepareDescriptor(void)
 {
     int x, y, i;
 
@@ -639,7 +651,8 @@ void camKeypointsInternalsPrepareDescriptor()
     }
 }
 
-int camKeypointsDescriptor(CamImage *source, CamKeypoint *point, CamImage *filter, int option)
+// The patch size is given by the caller, as the descriptors may be computed by the worker threads of the pool
+int camKeypointsDescriptor(CamImage *source, CamKeypoint *point, CamImage *filter, int option, int patchSize)
 {
     CamWarpingParams params;
     CamImage rotated, filtered_h, filtered_v;
@@ -677,7 +690,7 @@ int camKeypointsDescriptor(CamImage *source, CamKeypoint *point, CamImage *filte
     // Rotate the image
     params.perspective=1;
     params.interpolation=1;
-    scale = (point->scale * camPatchSizeParam) >> 5;
+    scale = (point->scale * patchSize) >> 5;
     for (i = 0; i < 4; i++) {
 	params.p[i].x = costheta * xp[i] - sintheta * yp[i];
 	params.p[i].y = sintheta * xp[i] + costheta * yp[i];
@@ -838,15 +851,53 @@ int camSortKeypoints(const void *p1x, const void *p2x)
     return -1;
 }
 
+/* The responses of the detector at all scales, as well as the descriptors of the selected
+ * keypoints, are computed in parallel on the worker pool
+ */
+typedef struct {
+    CamImage *integral;
+    CamImage *results;
+} CamHessianJob;
+
+static void camFastHessianDetectorTask(void *arg, int scale)
+{
+    CamHessianJob *job = (CamHessianJob*)arg;
+    job->results[scale].imageData = NULL; // In order to use automatic allocation
+    camFastHessianDetectorFixedScale(job->integral, &job->results[scale], scale);
+}
+
+typedef struct {
+    CamImage *source;
+    CamKeypoints *points;
+    CamImage *filter;
+    int options;
+    int patchSize;
+    int nbTasks;
+} CamDescriptorJob;
+
+#define CAM_DESCRIPTOR_TASKS_PER_THREAD 4 // Small tasks, for load balancing
+
+static void camKeypointsDescriptorTask(void *arg, int index)
+{
+    CamDescriptorJob *job = (CamDescriptorJob*)arg;
+    int i;
+    int start = job->points->nbPoints * index / job->nbTasks;
+    int end = job->points->nbPoints * (index + 1) / job->nbTasks;
+
+    for (i = start; i < end; i++) {
+	camKeypointsDescriptor(job->source, job->points->keypoint[i], job->filter, job->options, job->patchSize);
+    }
+}
+
 int camFastHessianDetector(CamImage *source, CamKeypoints *points, int threshold, int options)
 {
-    CamImage integral;
+    CamImage integral, fullsource;
     CamImage results[sizeof(CamScale) / sizeof(CamScale[0])];
     int width, height;
     int i, j, k, scale;
     int pNbPoints;
     CamInternalROIPolicyStruct iROI;
-    CamROI *roi, roix;
+    CamROI roix;
     const int nbScales = sizeof(CamScale) / sizeof(CamScale[0]);
 
     int x, y, d, thr;
@@ -863,6 +914,8 @@ int camFastHessianDetector(CamImage *source, CamKeypoints *points, int threshold
     int x1, x3, y1, y2, y3, p, num, den;
     signed short *ptr;
     CamImage filter;
+    CamHessianJob hessianJob;
+    CamDescriptorJob descriptorJob;
 
     CAM_CHECK(camFastHessianDetector, camInternalROIPolicy(source, NULL, &iROI, 1));
     CAM_CHECK_ARGS(camFastHessianDetector, (source->depth & CAM_DEPTH_MASK) >= 8);
@@ -874,14 +927,15 @@ int camFastHessianDetector(CamImage *source, CamKeypoints *points, int threshold
     points->height = height;
 
     integral.imageData = NULL;
-    roi = source->roi;
+    // Work on a copy of the header so that the source image is never modified
+    fullsource = *source;
     camSetMaxROI(&roix, source);
     roix.coi = 1;
-    source->roi = &roix;
-    camIntegralImage(source, &integral);
+    fullsource.roi = &roix;
+    camIntegralImage(&fullsource, &integral);
     points->nbPoints = 0;
+    points->qnbPoints = 0; // The quantized descriptors are outdated
     integral.roi = &iROI.srcroi;
-    source->roi = roi;
 
     // Bag allocation
     if (points->bag == NULL) {
@@ -897,9 +951,10 @@ int camFastHessianDetector(CamImage *source, CamKeypoints *points, int threshold
     points->nbPoints = 0;
 
     // Fast Hessian Detector for all scales
+    hessianJob.integral = &integral;
+    hessianJob.results = results;
+    camInternalParallelRun(camFastHessianDetectorTask, &hessianJob, nbScales);
     for (scale = 0; scale < nbScales; scale++) {
-	results[scale].imageData = NULL; // In order to use automatic allocation
-	camFastHessianDetectorFixedScale(&integral, &results[scale], scale);
 	// camSavePGM(&results[scale], "output/features_fast_hessian.pgm");
 	pNbPoints = points->nbPoints;
 	camFindLocalMaximaCircle5(&results[scale], points, threshold);
@@ -1129,11 +1184,16 @@ int camFastHessianDetector(CamImage *source, CamKeypoints *points, int threshold
     camAllocateImage(&filter, 20, 20, CAM_DEPTH_16S);
     camBuildGaussianFilter(&filter, camSigmaParam);
     
-    camKeypointsInternalsPrepareDescriptor();
+    camInternalOnce(&camFPOnce, camKeypointsInternalsPrepareDescriptor);
     // Get the signature from the selected feature points
-    for (i = 0; i < points->nbPoints; i++) {
-	camKeypointsDescriptor(source, points->keypoint[i], &filter, options);
-    }
+    descriptorJob.source = source;
+    descriptorJob.points = points;
+    descriptorJob.filter = &filter;
+    descriptorJob.options = options;
+    descriptorJob.patchSize = camPatchSizeParam;
+    descriptorJob.nbTasks = camGetNumThreads() * CAM_DESCRIPTOR_TASKS_PER_THREAD;
+    if (descriptorJob.nbTasks > points->nbPoints) descriptorJob.nbTasks = points->nbPoints;
+    camInternalParallelRun(camKeypointsDescriptorTask, &descriptorJob, descriptorJob.nbTasks);
 
     // Finally, set the points' set 
     for (i = 0; i < points->nbPoints; i++) {
@@ -90,8 +90,8 @@ int camCompareDescriptors(const int *desc1, const int *desc2, const int s)
     sum = _mm_setzero_si128();
     for (i = 0; i != s >> 4; i++) {
 	// 32-bits SAD for 4 integers in parallel
-	d1 = _mm_load_si128(p1++);
-	d2 = _mm_load_si128(p2++);
+	d1 = _mm_loadu_si128(p1++);
+	d2 = _mm_loadu_si128(p2++);
 	d = _mm_sub_epi32(d1, d2);
 	md = _mm_sub_epi32(d2, d1);
 	cmp = _mm_cmplt_epi32(d, _mm_setzero_si128());
@@ -101,8 +101,8 @@ int camCompareDescriptors(const int *desc1, const int *desc2, const int s)
 	sum = _mm_add_epi32(sum, d);   
 	
 	// 32-bits SAD for 4 integers in parallel
-	d1 = _mm_load_si128(p1++);
-	d2 = _mm_load_si128(p2++);
+	d1 = _mm_loadu_si128(p1++);
+	d2 = _mm_loadu_si128(p2++);
 	d = _mm_sub_epi32(d1, d2);
 	md = _mm_sub_epi32(d2, d1);
 	cmp = _mm_cmplt_epi32(d, _mm_setzero_si128());
@@ -112,8 +112,8 @@ int camCompareDescriptors(const int *desc1, const int *desc2, const int s)
 	sum = _mm_add_epi32(sum, d);   
 	
 	// 32-bits SAD for 4 integers in parallel
-	d1 = _mm_load_si128(p1++);
-	d2 = _mm_load_si128(p2++);
+	d1 = _mm_loadu_si128(p1++);
+	d2 = _mm_loadu_si128(p2++);
 	d = _mm_sub_epi32(d1, d2);
 	md = _mm_sub_epi32(d2, d1);
 	cmp = _mm_cmplt_epi32(d, _mm_setzero_si128());
@@ -123,8 +123,8 @@ int camCompareDescriptors(const int *desc1, const int *desc2, const int s)
 	sum = _mm_add_epi32(sum, d);   
 	
 	// 32-bits SAD for 4 integers in parallel
-	d1 = _mm_load_si128(p1++);
-	d2 = _mm_load_si128(p2++);
+	d1 = _mm_loadu_si128(p1++);
+	d2 = _mm_loadu_si128(p2++);
 	d = _mm_sub_epi32(d1, d2);
 	md = _mm_sub_epi32(d2, d1);
 	cmp = _mm_cmplt_epi32(d, _mm_setzero_si128());
@@ -143,7 +143,7 @@ int camCompareKeypoints(CamKeypoint *point1, CamKeypoint *point2)
 }
 
 #else
-int camCompareDescriptors(int *d1, int *d2, int s)
+int camCompareDescriptors(const int *d1, const int *d2, const int s)
 {
     int i, distance = 0;
     for (i = 0; i < s; i++) {
@@ -159,6 +159,208 @@ int camCompareKeypoints(CamKeypoint *point1, CamKeypoint *point2)
 #endif
 #endif
 
+// Quantized descriptors
+// The descriptors are divided by 2^CAM_QSHIFT_xx and saturated. 8-bit descriptors are offset by 128
+#define CAM_QSHIFT_8U  14
+#define CAM_QSHIFT_16S 8
+#define CAM_QMAX_16S   16383 // So that the difference of two descriptors fits in 16 bits
+
+#ifdef CAM_EUCLIDIAN_DISTANCE
+static int camCompareDescriptors8u(const unsigned char *d1, const unsigned char *d2, int s)
+{
+    int i, x, distance = 0;
+    for (i = 0; i < s; i++) {
+	x = d1[i] - d2[i];
+	distance += x * x;
+    }
+    return distance;
+}
+
+static int camCompareDescriptors16s(const short *d1, const short *d2, int s)
+{
+    int i;
+    CAM_INT64 distance = 0, x;
+    for (i = 0; i < s; i++) {
+	x = d1[i] - d2[i];
+	distance += x * x;
+    }
+    return (int)(distance >> (24 - 2 * CAM_QSHIFT_16S));
+}
+
+static int camCompareDescriptors32s(const int *d1, const int *d2, int s)
+{
+    int i;
+    CAM_INT64 distance = 0, x;
+    for (i = 0; i < s; i++) {
+	x = d1[i] - d2[i];
+	distance += x * x;
+    }
+    return (int)(distance >> 24);
+}
+
+#define CAM_QDISTANCE_8U(d) ((int)(((CAM_INT64)(d) << (2 * CAM_QSHIFT_8U)) >> 24))
+#define CAM_QDISTANCE_16S(d) (d)
+#define CAM_QDISTANCE_32S(d) (d)
+#else
+#define camCompareDescriptors32s camCompareDescriptors
+#ifdef __SSE2__
+static int camCompareDescriptors8u(const unsigned char *d1, const unsigned char *d2, int s)
+{
+    int i;
+    __m128i sum = _mm_setzero_si128();
+    for (i = 0; i != s; i += 32) {
+	// Sum of absolute differences of 16 bytes, in 2 64-bits words
+	sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_loadu_si128((__m128i*)(d1 + i)), _mm_loadu_si128((__m128i*)(d2 + i))));
+	sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_loadu_si128((__m128i*)(d1 + i + 16)), _mm_loadu_si128((__m128i*)(d2 + i + 16))));
+    }
+    return _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+}
+
+static int camCompareDescriptors16s(const short *d1, const short *d2, int s)
+{
+    int i, j;
+    __m128i sum = _mm_setzero_si128(), ones = _mm_set1_epi16(1), a, b;
+    for (i = 0; i != s; i += 32) {
+	for (j = 0; j != 32; j += 8) {
+	    // |a-b| = max(a,b)-min(a,b), summed by pairs in 32 bits
+	    a = _mm_loadu_si128((__m128i*)(d1 + i + j));
+	    b = _mm_loadu_si128((__m128i*)(d2 + i + j));
+	    sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_sub_epi16(_mm_max_epi16(a, b), _mm_min_epi16(a, b)), ones));
+	}
+    }
+    sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+    sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+    return _mm_cvtsi128_si32(sum);
+}
+#else
+static int camCompareDescriptors8u(const unsigned char *d1, const unsigned char *d2, int s)
+{
+    int i, distance = 0;
+    for (i = 0; i < s; i++) {
+	distance += abs(d1[i] - d2[i]);
+    }
+    return distance;
+}
+
+static int camCompareDescriptors16s(const short *d1, const short *d2, int s)
+{
+    int i, distance = 0;
+    for (i = 0; i < s; i++) {
+	distance += abs(d1[i] - d2[i]);
+    }
+    return distance;
+}
+#endif
+#define CAM_QDISTANCE_8U(d) ((d) << CAM_QSHIFT_8U)
+#define CAM_QDISTANCE_16S(d) ((d) << CAM_QSHIFT_16S)
+#define CAM_QDISTANCE_32S(d) (d)
+#endif
+
+static void camKeypointQuantize(CamKeypoint *point, int depth, int qsize, void *dest)
+{
+    int i, x;
+    unsigned char *d8 = (unsigned char*)dest;
+    short *d16 = (short*)dest;
+    const int size = (point->size < qsize) ? point->size : qsize;
+
+    if (depth == CAM_DEPTH_8U) {
+	for (i = 0; i < size; i++) {
+	    x = (point->descriptor[i] + (1 << (CAM_QSHIFT_8U - 1))) >> CAM_QSHIFT_8U;
+	    d8[i] = (unsigned char)((x < -128) ? 0 : ((x > 127) ? 255 : x + 128));
+	}
+	for (; i < qsize; i++) d8[i] = 128;
+    } else {
+	for (i = 0; i < size; i++) {
+	    x = (point->descriptor[i] + (1 << (CAM_QSHIFT_16S - 1))) >> CAM_QSHIFT_16S;
+	    d16[i] = (short)((x < -CAM_QMAX_16S - 1) ? -CAM_QMAX_16S - 1 : ((x > CAM_QMAX_16S) ? CAM_QMAX_16S : x));
+	}
+	for (; i < qsize; i++) d16[i] = 0;
+    }
+}
+
+int camKeypointsQuantize(CamKeypoints *points, int depth)
+{
+    int i, size = 0, elemSize;
+
+    CAM_CHECK_ARGS(camKeypointsQuantize, points != NULL);
+    CAM_CHECK_ARGS2(camKeypointsQuantize, depth == 0 || depth == CAM_DEPTH_8U || depth == CAM_DEPTH_16S, "Depth must be 0, CAM_DEPTH_8U or CAM_DEPTH_16S");
+
+    if (points->qdescriptors) free(points->qdescriptors);
+    points->qdepth = 0;
+    points->qsize = 0;
+    points->qnbPoints = 0;
+    points->qdescriptors = NULL;
+    if (depth == 0) return 1;
+
+    // Rows are padded to a multiple of 32 elements
+    for (i = 0; i < points->nbPoints; i++) {
+	if (points->keypoint[i]->size > size) size = points->keypoint[i]->size;
+    }
+    size = (size + 31) & ~31;
+    if (size == 0) size = 32;
+    elemSize = (depth == CAM_DEPTH_8U) ? 1 : 2;
+    points->qdescriptors = malloc((points->nbPoints ? points->nbPoints : 1) * size * elemSize);
+    if (points->qdescriptors == NULL) {
+	camError("camKeypointsQuantize", "Memory allocation error");
+	return 0;
+    }
+    for (i = 0; i < points->nbPoints; i++) {
+	camKeypointQuantize(points->keypoint[i], depth, size, (char*)points->qdescriptors + i * size * elemSize);
+    }
+    points->qdepth = depth;
+    points->qsize = size;
+    points->qnbPoints = points->nbPoints;
+    return 1;
+}
+
+#define CAM_KEYPOINTS_QUANTIZED(points) ((points)->qdescriptors && (points)->qnbPoints == (points)->nbPoints)
+
+// A target keypoint, quantized on demand
+typedef struct {
+    CamKeypoint *point;
+    int quantized8u, quantized16s;
+    unsigned char q8u[128];
+    short q16s[128];
+    int (*compare8u)(const unsigned char *d1, const unsigned char *d2, int s);
+    int (*compare16s)(const short *d1, const short *d2, int s);
+} CamKeypointQuery;
+
+static void camKeypointQueryInit(CamKeypointQuery *query, CamKeypoint *point)
+{
+    query->point = point;
+    query->quantized8u = 0;
+    query->quantized16s = 0;
+    query->compare8u = camCompareDescriptors8u;
+    query->compare16s = camCompareDescriptors16s;
+#if defined(CAM_AVX2) && !defined(CAM_EUCLIDIAN_DISTANCE)
+    if (camGetCPUFeatures() & CAM_CPU_AVX2) {
+	query->compare8u = camInternalCompareDescriptors8uAVX2;
+	query->compare16s = camInternalCompareDescriptors16sAVX2;
+    }
+#endif
+}
+
+// Distance between the target and the index-th keypoint of a set, with the quantized descriptors if available
+static int camKeypointQueryCompare(CamKeypointQuery *query, CamKeypoints *points, int index)
+{
+    if (CAM_KEYPOINTS_QUANTIZED(points)) {
+	if (points->qdepth == CAM_DEPTH_8U) {
+	    if (!query->quantized8u) {
+		camKeypointQuantize(query->point, CAM_DEPTH_8U, 128, query->q8u);
+		query->quantized8u = 1;
+	    }
+	    return CAM_QDISTANCE_8U(query->compare8u((unsigned char*)points->qdescriptors + index * points->qsize, query->q8u, points->qsize));
+	} else {
+	    if (!query->quantized16s) {
+		camKeypointQuantize(query->point, CAM_DEPTH_16S, 128, query->q16s);
+		query->quantized16s = 1;
+	    }
+	    return CAM_QDISTANCE_16S(query->compare16s((short*)points->qdescriptors + index * points->qsize, query->q16s, points->qsize));
+	}
+    }
+    return camCompareKeypoints(points->keypoint[index], query->point);
+}
+
 int camAllocateKeypointsMatches(CamKeypointsMatches *matches, int nbpairs)
 {
     matches->pairs = (CamKeypointsMatch*)malloc(nbpairs * sizeof(CamKeypointsMatch));
@@ -184,8 +386,10 @@ CamKeypoint* camFindKeypoint(CamKeypoint *point, CamKeypoints *points, int *dist
 {
     int i, best = 0;
     int distance, bestDistance, secondBestDistance;
-    bestDistance = camCompareKeypoints(points->keypoint[0], point);
-    secondBestDistance = camCompareKeypoints(points->keypoint[1], point);
+    CamKeypointQuery query;
+    camKeypointQueryInit(&query, point);
+    bestDistance = camKeypointQueryCompare(&query, points, 0);
+    secondBestDistance = camKeypointQueryCompare(&query, points, 1);
     if (secondBestDistance < bestDistance) {
 	i = bestDistance;
 	bestDistance = secondBestDistance;
@@ -193,7 +397,7 @@ CamKeypoint* camFindKeypoint(CamKeypoint *point, CamKeypoints *points, int *dist
 	best = 1;
     }
     for (i = 2; i < points->nbPoints; i++) {
-	distance = camCompareKeypoints(points->keypoint[i], point);
+	distance = camKeypointQueryCompare(&query, points, i);
 	if (distance <= bestDistance) {
 	    secondBestDistance = bestDistance;
 	    bestDistance = distance;
@@ -274,116 +478,541 @@ int camKeypointsSmartMatching(CamKeypoints *model, CamKeypoints *target)
     return 0;
 }
 
-int camKeypointsMatching(CamKeypoints *target, CamKeypoints **models, int nbM, CamKeypointsMatches *matches)
+// Keypoints database : the descriptors of all the models in one matrix, apart from the keypoints.
+// The matrix is scanned by tiles of rows, compared to a tile of targets while they are in the L1 cache
+#define CAM_DATABASE_TILE_BYTES   16384
+#define CAM_DATABASE_TILE_TARGETS 16
+#define CAM_ALIGN64(p) ((void*)(((size_t)(p) + 63) & ~(size_t)63))
+
+// Keypoints database file : the sections are stored as they are in memory (64-byte aligned), so that the file
+// can be mapped and used without any parsing. The keypoints are stored without their set (set is NULL)
+#define CAM_KEYPOINTS_FILE_MAGIC   "CAMKPDB"
+#define CAM_KEYPOINTS_FILE_VERSION 1
+#define CAM_KEYPOINTS_FILE_ORDER   0x01020304 // Byte order check
+#define CAM_ALIGN64_SIZE(s) (((s) + 63) & ~(CAM_INT64)63)
+
+typedef struct {
+    char magic[8];
+    int version;
+    int byteOrder;
+    int keypointSize;		    // sizeof(CamKeypoint), which depends on the platform
+    int nbPoints, size, depth;	    // Database
+    int nbTrees, nbNodes;	    // Index (0 if none)
+    CAM_INT64 fileSize;
+    CAM_INT64 keypoints, descriptors, id, nodes, trees, rows; // Offsets of the sections
+} CamKeypointsFileHeader;
+
+static int camKeypointsDatabaseRowBytes(int depth, int size)
 {
-    int i, c, model, best, nbModels = 0;
-    int distance, bestDistance, secondBestDistance, bestModel, secondBestModel;
-    CamKeypoint *point, *bestMatch;
-#define MAX_NB_MODELS 256
-    int results[MAX_NB_MODELS], best4Target[2048];
+    return size * ((depth == CAM_DEPTH_8U) ? 1 : ((depth == CAM_DEPTH_16S) ? 2 : 4));
+}
 
-    CAM_CHECK_ARGS(camKeypointsMatching, nbModels <= MAX_NB_MODELS);
-    CAM_CHECK_ARGS(camKeypointsMatching, target->nbPoints <= 2048);
-    CAM_CHECK_ARGS(camKeypointsMatching, matches->allocated != 0);
+// Copy (CAM_DEPTH_32S) or quantization of a descriptor into a row of the matrix
+static void camKeypointsDatabaseRow(CamKeypoint *point, int depth, int size, void *dest)
+{
+    int i, *d32 = (int*)dest;
+    if (depth != CAM_DEPTH_32S) {
+	camKeypointQuantize(point, depth, size, dest);
+	return;
+    }
+    for (i = 0; i < point->size && i < size; i++) d32[i] = point->descriptor[i];
+    for (; i < size; i++) d32[i] = 0;
+}
 
-    for (model = 0; model < MAX_NB_MODELS; model++) results[model] = 0;
-    matches->nbMatches = 0;
-    matches->nbOutliers = 0;
+int camKeypointsCompileDatabase(CamKeypointsDatabase *db, CamKeypoints **models, int nbModels, int depth)
+{
+    int i, j, n, size = 0, nbPoints = 0, rowBytes;
+    char *ptr;
 
-    for (c = 0; c < target->nbPoints; c++) {
-	point = target->keypoint[c];
-	bestDistance = -1; bestModel = 0;
+    CAM_CHECK_ARGS(camKeypointsCompileDatabase, db != NULL);
+    CAM_CHECK_ARGS2(camKeypointsCompileDatabase, depth == CAM_DEPTH_8U || depth == CAM_DEPTH_16S || depth == CAM_DEPTH_32S, "Depth must be CAM_DEPTH_8U, CAM_DEPTH_16S or CAM_DEPTH_32S");
 
-	for (model = 0; model < nbM; model++) {
-	    for (i = 0; i < models[model]->nbPoints; i++) {
-		distance = camCompareKeypoints(models[model]->keypoint[i], point);
-		if (bestDistance == -1 || distance <= bestDistance) {
-		    bestMatch = models[model]->keypoint[i];
-		    secondBestDistance = bestDistance;
-		    secondBestModel = bestModel;
-		    bestDistance = distance;
-		    bestModel = model;
-		} else if (secondBestDistance == -1 || distance <= secondBestDistance) {
-		    secondBestDistance = distance; 
-		    secondBestModel = model;
-		}
+    // A database compiled (or mapped) before is released first
+    camFreeKeypointsDatabase(db);
+
+    // Rows are padded to a multiple of 32 elements
+    for (i = 0; i < nbModels; i++) {
+	nbPoints += models[i]->nbPoints;
+	for (j = 0; j < models[i]->nbPoints; j++) {
+	    if (models[i]->keypoint[j]->size > size) size = models[i]->keypoint[j]->size;
+	}
+    }
+    size = (size + 31) & ~31;
+    if (size == 0) size = 32;
+    rowBytes = camKeypointsDatabaseRowBytes(depth, size);
+
+    // One memory block : the descriptors matrix (64-byte aligned), the keypoints and the ids of the models
+    db->buffer = malloc(63 + nbPoints * (rowBytes + sizeof(CamKeypoint*) + sizeof(int)));
+    if (db->buffer == NULL) {
+	camError("camKeypointsCompileDatabase", "Memory allocation error");
+	return 0;
+    }
+    db->descriptors = CAM_ALIGN64(db->buffer);
+    db->keypoint = (CamKeypoint**)((char*)db->descriptors + nbPoints * rowBytes);
+    db->id = (int*)(db->keypoint + nbPoints);
+
+    ptr = (char*)db->descriptors;
+    for (i = 0, n = 0; i < nbModels; i++) {
+	for (j = 0; j < models[i]->nbPoints; j++, n++, ptr += rowBytes) {
+	    camKeypointsDatabaseRow(models[i]->keypoint[j], depth, size, ptr);
+	    db->keypoint[n] = models[i]->keypoint[j];
+	    db->id[n] = models[i]->id;
+	}
+    }
+    db->nbPoints = nbPoints;
+    db->size = size;
+    db->depth = depth;
+    return 1;
+}
+
+int camFreeKeypointsDatabase(CamKeypointsDatabase *db)
+{
+    CAM_CHECK_ARGS(camFreeKeypointsDatabase, db != NULL);
+    if (db->buffer) free(db->buffer);
+    if (db->file) camInternalUnmapFile(db->file, ((CamKeypointsFileHeader*)db->file)->fileSize);
+    db->file = NULL;
+    db->nbPoints = 0;
+    db->size = 0;
+    db->depth = 0;
+    db->descriptors = NULL;
+    db->keypoint = NULL;
+    db->id = NULL;
+    db->buffer = NULL;
+    return 1;
+}
+
+// Comparison of a tile of targets [q0,q1[ with a tile of rows [m0,m1[ of the database
+#define CAM_DATABASE_TILE(compare, type, scale) \
+    for (q = q0; q < q1; q++) { \
+	const type *target = (const type*)targets + q * db->size; \
+	for (m = m0; m < m1; m++) { \
+	    distance = scale(compare((const type*)db->descriptors + m * db->size, target, db->size)); \
+	    if (dist1[q] == -1 || distance <= dist1[q]) { \
+		dist2[q] = dist1[q]; \
+		dist1[q] = distance; \
+		best[q] = m; \
+	    } else if (dist2[q] == -1 || distance <= dist2[q]) { \
+		dist2[q] = distance; \
+	    } \
+	} \
+    }
+
+static void camKeypointsDatabaseNearestRows(CamKeypointsDatabase *db, const void *targets, int nbTargets, int *best, int *dist1, int *dist2)
+{
+    int q, q0, q1, m, m0, m1, tileRows, distance;
+    int (*compare8u)(const unsigned char *d1, const unsigned char *d2, int s) = camCompareDescriptors8u;
+    int (*compare16s)(const short *d1, const short *d2, int s) = camCompareDescriptors16s;
+#if defined(CAM_AVX2) && !defined(CAM_EUCLIDIAN_DISTANCE)
+    if (camGetCPUFeatures() & CAM_CPU_AVX2) {
+	compare8u = camInternalCompareDescriptors8uAVX2;
+	compare16s = camInternalCompareDescriptors16sAVX2;
+    }
+#endif
+
+    tileRows = CAM_DATABASE_TILE_BYTES / camKeypointsDatabaseRowBytes(db->depth, db->size);
+    if (tileRows == 0) tileRows = 1;
+    for (q = 0; q < nbTargets; q++) {
+	best[q] = -1;
+	dist1[q] = -1;
+	dist2[q] = -1;
+    }
+    for (q0 = 0; q0 < nbTargets; q0 += CAM_DATABASE_TILE_TARGETS) {
+	q1 = (q0 + CAM_DATABASE_TILE_TARGETS < nbTargets) ? q0 + CAM_DATABASE_TILE_TARGETS : nbTargets;
+	for (m0 = 0; m0 < db->nbPoints; m0 += tileRows) {
+	    m1 = (m0 + tileRows < db->nbPoints) ? m0 + tileRows : db->nbPoints;
+	    if (db->depth == CAM_DEPTH_8U) {
+		CAM_DATABASE_TILE(compare8u, unsigned char, CAM_QDISTANCE_8U);
+	    } else if (db->depth == CAM_DEPTH_16S) {
+		CAM_DATABASE_TILE(compare16s, short, CAM_QDISTANCE_16S);
+	    } else {
+		CAM_DATABASE_TILE(camCompareDescriptors32s, int, CAM_QDISTANCE_32S);
 	    }
 	}
-	
-	//printf("%d %d %d\n", bestMatch->set->id, bestDistance, secondBestDistance);
-	
-	/*
-	if (models[bestModel]->id == models[secondBestModel]->id) {
-	    // Accept the point whatever it is
-	    secondBestDistance = 2 * bestDistance;
+    }
+}
+
+// Nearest rows for the target keypoints [start,end[
+static int camKeypointsDatabaseNearestRange(CamKeypointsDatabase *db, CamKeypoints *target, int start, int end, int *best, int *dist1, int *dist2)
+{
+    int c, rowBytes;
+    void *buffer;
+    char *targets;
+
+    // The targets are converted into a matrix as well
+    rowBytes = camKeypointsDatabaseRowBytes(db->depth, db->size);
+    buffer = malloc(63 + (end - start) * rowBytes);
+    if (buffer == NULL) return 0;
+    targets = (char*)CAM_ALIGN64(buffer);
+    for (c = start; c < end; c++) {
+	camKeypointsDatabaseRow(target->keypoint[c], db->depth, db->size, targets + (c - start) * rowBytes);
+    }
+    camKeypointsDatabaseNearestRows(db, targets, end - start, best, dist1, dist2);
+    free(buffer);
+    return 1;
+}
+
+int camKeypointsDatabaseNearest(CamKeypoints *target, CamKeypointsDatabase *db, int *best, int *dist1, int *dist2)
+{
+    CAM_CHECK_ARGS(camKeypointsDatabaseNearest, db->descriptors != NULL);
+    if (!camKeypointsDatabaseNearestRange(db, target, 0, target->nbPoints, best, dist1, dist2)) {
+	camError("camKeypointsDatabaseNearest", "Memory allocation error");
+	return 0;
+    }
+    return 1;
+}
+
+// Priority queue of the branches to explore : a binary heap of (distance, node) pairs
+typedef struct {
+    int distance;
+    int node; // Index in the nodes of the index
+} CamKeypointsIndexBranch;
+
+// Working memory of the searches in an index, allocated once for a series of queries
+typedef struct {
+    CamKeypointsIndexBranch *pqueue;
+    int allocated;
+    unsigned char *visited;	    // Generation of the last query that checked each row
+    unsigned char generation;
+} CamKeypointsIndexSearch;
+
+static int camKeypointsIndexSearchAllocate(CamKeypointsIndexSearch *search, CamKeypointsIndex *index);
+static void camKeypointsIndexSearchFree(CamKeypointsIndexSearch *search);
+static int camKeypointsIndexNearest(CamKeypointsIndex *index, CamKeypointsIndexSearch *search, CamKeypoint *point, int checks, int *dist1, int *dist2);
+
+// Matching of the target keypoints, spread over the worker pool. Each task processes a range of target keypoints
+// and counts the votes for the models in its own table, so that the tasks never wait for each other
+#define CAM_MATCHING_TASKS_PER_THREAD 4 // Small tasks, for load balancing
+#define CAM_MATCHING_BRUTE_FORCE 0
+#define CAM_MATCHING_POINTS      1 // camKeypointsMatching2 : no vote
+#define CAM_MATCHING_KDTREE      2
+#define CAM_MATCHING_DATABASE    3
+#define CAM_MATCHING_INDEX       4
+
+typedef struct {
+    int mode;
+    CamKeypoints *target;
+    CamKeypoints **models;	    // CAM_MATCHING_BRUTE_FORCE and CAM_MATCHING_POINTS (1 model)
+    int nbModels;
+    CamFPKdTreeNode *kdTreeRoot;    // CAM_MATCHING_KDTREE
+    int explore;		    // Or checks (CAM_MATCHING_INDEX)
+    CamKeypointsDatabase *db;	    // CAM_MATCHING_DATABASE
+    CamKeypointsIndex *index;	    // CAM_MATCHING_INDEX
+    int nbTasks;
+    CamKeypoint **bestMatch;	    // Best match of each target keypoint (NULL if it is rejected)
+    int *bestDistance;
+    int *id;			    // Index in ids of the model of the best match (-1 if none)
+    int *ids;			    // Ids of the models, sorted without duplicates
+    int nbIds;
+    int *votes;			    // Votes for the models (indexed like ids), one row per task
+    int *error;			    // Memory allocation error, per task
+} CamKeypointsMatchingJob;
+
+static int camKeypointsMatchingCompareIds(const void *id1, const void *id2)
+{
+    const int a = *(const int*)id1, b = *(const int*)id2;
+    return (a > b) - (a < b);
+}
+
+// Ids of the models of the leaves of a kdTree (stored in preorder : the left child follows its parent). Returns the number of leaves
+static int camKeypointsKdTreeIds(CamFPKdTreeNode *node, int *ids)
+{
+    int n;
+    if (node->i == -1) {
+	if (ids) *ids = ((CamKeypoint*)node->right)->set ? ((CamKeypoint*)node->right)->set->id : -1;
+	return 1;
+    }
+    n = camKeypointsKdTreeIds(node + 1, ids);
+    return n + camKeypointsKdTreeIds(node->right, ids ? ids + n : NULL);
+}
+
+// The models ids can be large or sparse : the votes are counted on their index in the sorted list of the ids
+static int camKeypointsMatchingIds(CamKeypointsMatchingJob *job)
+{
+    int i, n = 0;
+
+    job->ids = NULL;
+    job->nbIds = 0;
+    switch (job->mode) {
+    case CAM_MATCHING_POINTS:
+	return 1;
+    case CAM_MATCHING_BRUTE_FORCE:
+	n = job->nbModels;
+	break;
+    case CAM_MATCHING_KDTREE:
+	n = camKeypointsKdTreeIds(job->kdTreeRoot, NULL);
+	break;
+    default:
+	// The rows of a model are contiguous in the database
+	for (i = 0; i < job->db->nbPoints; i++) {
+	    if (i == 0 || job->db->id[i] != job->db->id[i - 1]) n++;
 	}
-	*/
+    }
+    if (n == 0) return 1;
+    job->ids = (int*)malloc(n * sizeof(int));
+    if (job->ids == NULL) return 0;
+    switch (job->mode) {
+    case CAM_MATCHING_BRUTE_FORCE:
+	for (i = 0; i < n; i++) job->ids[i] = job->models[i]->id;
+	break;
+    case CAM_MATCHING_KDTREE:
+	camKeypointsKdTreeIds(job->kdTreeRoot, job->ids);
+	break;
+    default:
+	for (i = 0, n = 0; i < job->db->nbPoints; i++) {
+	    if (i == 0 || job->db->id[i] != job->db->id[i - 1]) job->ids[n++] = job->db->id[i];
+	}
+    }
+    qsort(job->ids, n, sizeof(int), camKeypointsMatchingCompareIds);
+    // Negative ids get no vote
+    for (i = 0; i < n; i++) {
+	if (job->ids[i] >= 0 && (job->nbIds == 0 || job->ids[i] != job->ids[job->nbIds - 1])) job->ids[job->nbIds++] = job->ids[i];
+    }
+    return 1;
+}
 
-	/*
-	    secondBestDistance = -1; secondBestModel = 0;
+// Index of a model id in the ids of the job (-1 if it gets no vote)
+static int camKeypointsMatchingIdIndex(CamKeypointsMatchingJob *job, int id)
+{
+    int low = 0, high = job->nbIds - 1, middle;
+    while (low <= high) {
+	middle = (low + high) / 2;
+	if (job->ids[middle] == id) return middle;
+	if (job->ids[middle] < id) low = middle + 1; else high = middle - 1;
+    }
+    return -1;
+}
+
+static void camKeypointsMatchingTask(void *arg, int index)
+{
+    CamKeypointsMatchingJob *job = (CamKeypointsMatchingJob*)arg;
+    int i, c, model, row, distance, bestDistance, secondBestDistance, id, accept;
+    int start = job->target->nbPoints * index / job->nbTasks;
+    int end = job->target->nbPoints * (index + 1) / job->nbTasks;
+    int *bestRow = NULL, *secondBestRow = NULL;
+    CamKeypoint *point, *bestMatch;
+    CamKeypointQuery query;
+    CamKeypointsIndexSearch search;
+
+    if (job->mode == CAM_MATCHING_DATABASE) {
+	// The nearest rows are searched for the whole range at once, by tiles
+	bestRow = (int*)malloc(2 * (end - start) * sizeof(int));
+	if (bestRow == NULL) {
+	    job->error[index] = 1;
+	    return;
+	}
+	secondBestRow = bestRow + (end - start);
+	if (!camKeypointsDatabaseNearestRange(job->db, job->target, start, end, bestRow, job->bestDistance + start, secondBestRow)) {
+	    job->error[index] = 1;
+	    free(bestRow);
+	    return;
+	}
+    } else if (job->mode == CAM_MATCHING_INDEX) {
+	// The same priority queue and visited marks serve all the queries of the range
+	if (!camKeypointsIndexSearchAllocate(&search, job->index)) {
+	    job->error[index] = 1;
+	    return;
+	}
+    }
 
-	    // We have to scan again for the second best
-	    for (model = 0; model < nbM; model++) {
-		if (models[model]->id == models[bestModel]->id) continue; // Skip the best model
-		for (i = 0; i < models[model]->nbPoints; i++) {
-		    distance = camCompareKeypoints(models[model]->keypoint[i], point);
-		    if (secondBestDistance == -1 || distance <= secondBestDistance) {
+    for (c = start; c < end; c++) {
+	point = job->target->keypoint[c];
+	bestMatch = NULL;
+	bestDistance = -1;
+	secondBestDistance = -1;
+	id = -1;
+	switch (job->mode) {
+	case CAM_MATCHING_BRUTE_FORCE:
+	    camKeypointQueryInit(&query, point);
+	    for (model = 0; model < job->nbModels; model++) {
+		for (i = 0; i < job->models[model]->nbPoints; i++) {
+		    distance = camKeypointQueryCompare(&query, job->models[model], i);
+		    if (bestDistance == -1 || distance <= bestDistance) {
+			bestMatch = job->models[model]->keypoint[i];
+			secondBestDistance = bestDistance;
+			bestDistance = distance;
+		    } else if (secondBestDistance == -1 || distance <= secondBestDistance) {
 			secondBestDistance = distance; 
-			secondBestModel = model;
 		    }
 		}
 	    }
-	}
-	*/	 
-
-	// Final test...
-	if (bestDistance < 0.8 * secondBestDistance) {
-	    if (bestMatch->set->id >= 0 && bestMatch->set->id < MAX_NB_MODELS) {
-		results[bestMatch->set->id]++;
-		if (bestMatch->set->id + 1 > nbModels) nbModels = bestMatch->set->id + 1;
+	    break;
+	case CAM_MATCHING_POINTS:
+	    bestMatch = camFindKeypoint(point, job->models[0], &bestDistance, &secondBestDistance);
+	    break;
+	case CAM_MATCHING_KDTREE:
+	    bestMatch = camFindKeypointKdTree(point, job->kdTreeRoot, job->explore, &bestDistance, &secondBestDistance);
+	    break;
+	case CAM_MATCHING_INDEX:
+	    row = camKeypointsIndexNearest(job->index, &search, point, job->explore, &bestDistance, &secondBestDistance);
+	    if (row != -1) {
+		bestMatch = job->db->keypoint[row];
+		id = job->db->id[row];
 	    }
-    	    matches->pairs[matches->nbMatches].p1 = bestMatch;
-    	    matches->pairs[matches->nbMatches].p2 = point;
-    	    matches->pairs[matches->nbMatches].mark = bestDistance;
-	    best4Target[matches->nbMatches] = bestMatch->set->id;
-	    matches->nbMatches++;
-	    if (matches->nbMatches == matches->allocated) break;
-	}	    
-    }
+	    break;
+	default:
+	    if (bestRow[c - start] != -1) {
+		bestMatch = job->db->keypoint[bestRow[c - start]];
+		id = job->db->id[bestRow[c - start]];
+	    }
+	    bestDistance = job->bestDistance[c];
+	    secondBestDistance = secondBestRow[c - start];
+	}
 
-    best = 0;
-    for (i = 1; i < nbModels; i++) {
-	if (results[i] > results[best]) best = i;
-    }
-    
-    c = 0;
-    for (i = 0; i < matches->nbMatches; i++) {
-	if (best4Target[i] == best) {
-	    matches->pairs[c++] = matches->pairs[i];
+	// Final test... (a single candidate found in the kdTree is accepted)
+	accept = (bestDistance < 0.8 * secondBestDistance) || (job->mode == CAM_MATCHING_KDTREE && secondBestDistance == -1);
+	if (bestMatch == NULL || !accept) {
+	    job->bestMatch[c] = NULL;
+	    continue;
 	}
+	if (job->mode == CAM_MATCHING_BRUTE_FORCE || job->mode == CAM_MATCHING_KDTREE) id = bestMatch->set->id;
+	if (job->mode != CAM_MATCHING_POINTS) id = camKeypointsMatchingIdIndex(job, id);
+	job->bestMatch[c] = bestMatch;
+	job->bestDistance[c] = bestDistance;
+	job->id[c] = id;
+	if (id >= 0) job->votes[index * job->nbIds + id]++;
     }
-    matches->nbMatches = results[best];
-    return best;
+    free(bestRow);
+    if (job->mode == CAM_MATCHING_INDEX) camKeypointsIndexSearchFree(&search);
 }
 
-int camKeypointsMatching2(CamKeypoints *points1, CamKeypoints *points2, CamKeypointsMatches *matches)
+// Returns the id of the best model (the number of matches with CAM_MATCHING_POINTS)
+static int camKeypointsMatchingRun(CamKeypointsMatchingJob *job, CamKeypointsMatches *matches)
 {
-    int i, dist1, dist2;
-    CamKeypoint *best;
+    int i, c, n, best = 0, bestId = 0, nbAccepted, error;
+    int *votes;
+    const int nbPoints = job->target->nbPoints;
+
     matches->nbMatches = 0;
     matches->nbOutliers = 0;
-    
-    for (i = 0; i < points1->nbPoints; i++) {
-	best = camFindKeypoint(points1->keypoint[i], points2, &dist1, &dist2);
-	if (dist1 < 0.8 * dist2) {
-    	    matches->pairs[matches->nbMatches].p1 = points1->keypoint[i];
-    	    matches->pairs[matches->nbMatches].p2 = best;
-    	    matches->pairs[matches->nbMatches].mark = dist1;
+    if (nbPoints == 0) return 0;
+
+    job->nbTasks = camGetNumThreads() * CAM_MATCHING_TASKS_PER_THREAD;
+    if (job->nbTasks > nbPoints) job->nbTasks = nbPoints;
+    job->bestMatch = (CamKeypoint**)malloc(nbPoints * sizeof(CamKeypoint*));
+    job->bestDistance = (int*)malloc((2 * nbPoints + job->nbTasks) * sizeof(int));
+    job->votes = NULL;
+    error = !camKeypointsMatchingIds(job);
+    if (!error && job->nbIds != 0) {
+	job->votes = (int*)calloc(job->nbTasks * job->nbIds, sizeof(int));
+	if (job->votes == NULL) error = 1;
+    }
+    if (job->bestMatch == NULL || job->bestDistance == NULL || error) {
+	if (job->bestMatch) free(job->bestMatch);
+	if (job->bestDistance) free(job->bestDistance);
+	if (job->ids) free(job->ids);
+	if (job->votes) free(job->votes);
+	camError("camKeypointsMatching", "Memory allocation error");
+	return 0;
+    }
+    job->id = job->bestDistance + nbPoints;
+    job->error = job->id + nbPoints;
+    for (i = 0; i < job->nbTasks; i++) job->error[i] = 0;
+
+    camInternalParallelRun(camKeypointsMatchingTask, job, job->nbTasks);
+
+    // Aggregation of the votes of all the tasks, in the first row
+    error = 0;
+    for (i = 0; i < job->nbTasks; i++) {
+	if (job->error[i]) error = 1;
+    }
+    votes = job->votes;
+    if (!error) {
+	for (i = 1; i < job->nbTasks; i++) {
+	    for (c = 0; c < job->nbIds; c++) votes[c] += votes[i * job->nbIds + c];
+	}
+	// Only the first matches fit in the matches table : the votes are counted on these only
+	for (c = 0, nbAccepted = 0; c < nbPoints; c++) {
+	    if (job->bestMatch[c]) nbAccepted++;
+	}
+	if (nbAccepted > matches->allocated) {
+	    for (i = 0; i < job->nbIds; i++) votes[i] = 0;
+	    for (c = 0, n = 0; c < nbPoints && n < matches->allocated; c++) {
+		if (job->bestMatch[c]) {
+		    n++;
+		    if (job->id[c] >= 0) votes[job->id[c]]++;
+		}
+	    }
+	}
+
+	for (i = 1; i < job->nbIds; i++) {
+	    if (votes[i] > votes[best]) best = i;
+	}
+	if (job->nbIds != 0 && votes[best] != 0) bestId = job->ids[best];
+
+	for (c = 0, n = 0; c < nbPoints && n < matches->allocated; c++) {
+	    if (job->bestMatch[c] == NULL) continue;
+	    n++;
+	    if (job->mode == CAM_MATCHING_POINTS) {
+		matches->pairs[matches->nbMatches].p1 = job->target->keypoint[c];
+		matches->pairs[matches->nbMatches].p2 = job->bestMatch[c];
+	    } else if (job->id[c] == best) {
+		matches->pairs[matches->nbMatches].p1 = job->bestMatch[c];
+		matches->pairs[matches->nbMatches].p2 = job->target->keypoint[c];
+	    } else continue;
+	    matches->pairs[matches->nbMatches].mark = job->bestDistance[c];
 	    matches->nbMatches++;
-	    if (matches->nbMatches == matches->allocated) break;
 	}
     }
-    return matches->nbMatches;
+
+    if (job->ids) free(job->ids);
+    if (job->votes) free(job->votes);
+    free(job->bestMatch);
+    free(job->bestDistance);
+    if (error) {
+	matches->nbMatches = 0;
+	camError("camKeypointsMatching", "Memory allocation error");
+	return 0;
+    }
+    return (job->mode == CAM_MATCHING_POINTS) ? matches->nbMatches : bestId;
+}
+
+int camKeypointsMatching(CamKeypoints *target, CamKeypoints **models, int nbM, CamKeypointsMatches *matches)
+{
+    CamKeypointsMatchingJob job;
+
+    CAM_CHECK_ARGS(camKeypointsMatching, matches->allocated != 0);
+    job.mode = CAM_MATCHING_BRUTE_FORCE;
+    job.target = target;
+    job.models = models;
+    job.nbModels = nbM;
+    return camKeypointsMatchingRun(&job, matches);
+}
+
+int camKeypointsMatching2(CamKeypoints *points1, CamKeypoints *points2, CamKeypointsMatches *matches)
+{
+    CamKeypointsMatchingJob job;
+
+    job.mode = CAM_MATCHING_POINTS;
+    job.target = points1;
+    job.models = &points2;
+    job.nbModels = 1;
+    return camKeypointsMatchingRun(&job, matches);
+}
+
+int camKeypointsMatchingDatabase(CamKeypoints *target, CamKeypointsDatabase *db, CamKeypointsMatches *matches)
+{
+    CamKeypointsMatchingJob job;
+
+    CAM_CHECK_ARGS(camKeypointsMatchingDatabase, db->descriptors != NULL);
+    CAM_CHECK_ARGS(camKeypointsMatchingDatabase, matches->allocated != 0);
+    job.mode = CAM_MATCHING_DATABASE;
+    job.target = target;
+    job.db = db;
+    return camKeypointsMatchingRun(&job, matches);
+}
+
+int camKeypointsMatchingIndex(CamKeypoints *target, CamKeypointsIndex *index, CamKeypointsMatches *matches, int checks)
+{
+    CamKeypointsMatchingJob job;
+
+    CAM_CHECK_ARGS(camKeypointsMatchingIndex, index->db != NULL);
+    CAM_CHECK_ARGS(camKeypointsMatchingIndex, matches->allocated != 0);
+    job.mode = CAM_MATCHING_INDEX;
+    job.target = target;
+    job.index = index;
+    job.db = index->db;
+    job.explore = checks;
+    return camKeypointsMatchingRun(&job, matches);
 }
 
 // Arithmetic routines
@@ -800,6 +1429,17 @@ CamFPKdTreeBranch *camFPKdTreeGetmin(CamFPKdTreeBranch *pqueue, int *N)
     return &pqueue[*N];
 }
 
+// Distance between the target and a leaf of the kdTree. The leaves keep the index of their keypoint in its set (see camKeypointsCompileKdTree)
+static int camKeypointQueryCompareLeaf(CamKeypointQuery *query, CamFPKdTreeNode *leaf)
+{
+    CamKeypoint *point = (CamKeypoint*)leaf->right;
+    CamKeypoints *points = point->set;
+    if (points && CAM_KEYPOINTS_QUANTIZED(points) && leaf->m >= 0 && leaf->m < points->nbPoints && points->keypoint[leaf->m] == point) {
+	return camKeypointQueryCompare(query, points, leaf->m);
+    }
+    return camCompareKeypoints(point, query->point);
+}
+
 CamKeypoint *camFindKeypointKdTree(CamKeypoint *point, CamFPKdTreeNode *kdTreeRoot, int explore, int *dist1, int *dist2)
 {
     CamFPKdTreeNode *node;
@@ -808,6 +1448,7 @@ CamKeypoint *camFindKeypointKdTree(CamKeypoint *point, CamFPKdTreeNode *kdTreeRo
     int *descriptor_heap, descriptor_heap_pos = 0, descriptor_heap_size;
     CamFPKdTreeBranch *branches_pqueue, branch, cbr, *br;
     int nbBranches = 0, explored = 0;
+    CamKeypointQuery query;
 #define MAX_NB_BRANCHES 1000
 
     const int nbBytes = point->size * sizeof(int);
@@ -820,7 +1461,8 @@ CamKeypoint *camFindKeypointKdTree(CamKeypoint *point, CamFPKdTreeNode *kdTreeRo
 	else node = node->right;
     }
     best = (CamKeypoint*)node->right;
-    firstDistance = camCompareKeypoints(best, point);
+    camKeypointQueryInit(&query, point);
+    firstDistance = camKeypointQueryCompareLeaf(&query, node);
 
     // OK. Now we can start again from the root
     descriptor_heap_size = point->size * MAX_NB_BRANCHES * 10;
@@ -841,7 +1483,7 @@ CamKeypoint *camFindKeypointKdTree(CamKeypoint *point, CamFPKdTreeNode *kdTreeRo
 	    // Is this a leaf ?
 	    if (br->node->i == -1) {
 		// Yes. Let's see whether it is better or not...
-		distance = camCompareKeypoints((CamKeypoint*)br->node->right, point);
+		distance = camKeypointQueryCompareLeaf(&query, br->node);
 		if (bestDistance == -1 || distance <= bestDistance) {
 		    secondBestDistance = bestDistance;
 		    bestDistance = distance;
@@ -916,50 +1558,14 @@ CamKeypoint *camFindKeypointKdTree(CamKeypoint *point, CamFPKdTreeNode *kdTreeRo
 
 int camKeypointsMatchingKdTree(CamKeypoints *target, CamFPKdTreeNode *kdTreeRoot, CamKeypointsMatches *matches, int explore)
 {
-    int i, c, model, best, nbModels = 0;
-    int bestDistance, secondBestDistance;
-    CamKeypoint *point, *bestMatch;
-    int results[MAX_NB_MODELS], best4Target[2048];
+    CamKeypointsMatchingJob job;
 
-    CAM_CHECK_ARGS(camKeypointsMatchingKdTree, target->nbPoints <= 2048);
     CAM_CHECK_ARGS(camKeypointsMatchingKdTree, matches->allocated != 0);
-
-    for (model = 0; model < MAX_NB_MODELS; model++) results[model] = 0;
-    matches->nbMatches = 0;
-    matches->nbOutliers = 0;
-
-    for (c = 0; c < target->nbPoints; c++) {
-	point = target->keypoint[c];
-	bestMatch = camFindKeypointKdTree(point, kdTreeRoot, explore, &bestDistance, &secondBestDistance);
-	//printf("%d %d %d\n", bestMatch->set->id, bestDistance, secondBestDistance);
-	// Final test...
-	if (secondBestDistance == -1 || bestDistance < 0.8 * secondBestDistance) {
-	    if (bestMatch->set->id >= 0 && bestMatch->set->id < MAX_NB_MODELS) {
-		results[bestMatch->set->id]++;
-		if (bestMatch->set->id + 1 > nbModels) nbModels = bestMatch->set->id + 1;
-	    }
-    	    matches->pairs[matches->nbMatches].p1 = bestMatch;
-    	    matches->pairs[matches->nbMatches].p2 = point;
-    	    matches->pairs[matches->nbMatches].mark = bestDistance;
-	    best4Target[matches->nbMatches] = bestMatch->set->id;
-	    matches->nbMatches++;
-	    if (matches->nbMatches == matches->allocated) break;
-	}	    
-    }
-
-    best = 0;
-    for (i = 1; i < nbModels; i++) {
-	if (results[i] > results[best]) best = i;
-    }
-    
-    c = 0;
-    for (i = 0; i < matches->nbMatches; i++) {
-	if (best4Target[i] == best) {
-	    matches->pairs[c++] = matches->pairs[i];
-	}
-    }
-    matches->nbMatches = results[best];
-    return best;
+    job.mode = CAM_MATCHING_KDTREE;
+    job.target = target;
+    job.kdTreeRoot = kdTreeRoot;
+    job.explore = explore;
+    return camKeypointsMatchingRun(&job, matches);
 }
 
 int camFPKdTreeCompare(const void *fp1x, const void *fp2x)
@@ -1074,7 +1680,7 @@ CamFPKdTreeNode *camFPKdTreeRecurs(CamFPKdTreeNode *node, double deviation[128],
 
 CamFPKdTreeNode *camKeypointsCompileKdTree(CamKeypoints **models, int nbModels)
 {
-    CamFPKdTreeNode *kdTree, *kdTreeCheck;
+    CamFPKdTreeNode *kdTree, *kdTreeCheck, *node;
     CamKeypoint **points;
     double deviation[128], tmpdev;
     int index[128], tmpidx; 
@@ -1124,7 +1730,499 @@ CamFPKdTreeNode *camKeypointsCompileKdTree(CamKeypoints **models, int nbModels)
     // Recursively call kdTreeRecurs
     kdTreeCheck = camFPKdTreeRecurs(kdTree, deviation, index, points, nbPoints);
     assert(kdTreeCheck <= kdTree + nbPoints * 2);
+
+    // The leaves keep the index of their keypoint, to find its quantized descriptor
+    for (i = 0; i < nbModels; i++) {
+	for (j = 0; j < models[i]->nbPoints; j++) {
+	    models[i]->keypoint[j]->internal = (void*)(size_t)j;
+	}
+    }
+    for (node = kdTree; node != kdTreeCheck; node++) {
+	if (node->i == -1) node->m = (int)(size_t)((CamKeypoint*)node->right)->internal;
+    }
     free(points);
     return kdTree;
 }
 
+// Randomized kd-trees index (several kd-trees searched with one priority queue, as in FLANN)
+// Each tree splits the rows of a keypoints database on the mean of a dimension picked at random
+// among the CAM_INDEX_RANDOM_DIMS ones with the largest variance, so that the trees complement each other
+#define CAM_INDEX_SAMPLES     100 // Number of rows used to compute the mean and variance of a node
+#define CAM_INDEX_RANDOM_DIMS 5
+#define CAM_INDEX_LEAF_SIZE   16  // Maximum number of rows of a leaf : they are compared one after the other, with less overhead
+#define CAM_INDEX_MAX_TREES   64
+
+static int camKeypointsIndexValue(const void *row, int depth, int i)
+{
+    if (depth == CAM_DEPTH_8U) return ((const unsigned char*)row)[i];
+    if (depth == CAM_DEPTH_16S) return ((const short*)row)[i];
+    return ((const int*)row)[i];
+}
+
+static int camKeypointsIndexRandom(unsigned int *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return (int)((*seed >> 16) & 0x7fff);
+}
+
+// Choice of the cut of a node. Returns the number of rows on the left side, which are moved first
+static int camKeypointsIndexSplit(CamKeypointsIndexNode *node, CamKeypointsDatabase *db, int *rows, int nbRows, unsigned int *seed)
+{
+    double mean[128], var[128], x;
+    int dims[CAM_INDEX_RANDOM_DIMS], nbDims = 0;
+    int i, j, k, n, left, tmp;
+    const int rowBytes = camKeypointsDatabaseRowBytes(db->depth, db->size);
+    const char *descriptors = (const char*)db->descriptors;
+
+    // Mean and variance of each dimension, on the first rows (they are shuffled)
+    n = (nbRows < CAM_INDEX_SAMPLES) ? nbRows : CAM_INDEX_SAMPLES;
+    for (i = 0; i < db->size; i++) {
+	mean[i] = 0;
+	var[i] = 0;
+    }
+    for (j = 0; j < n; j++) {
+	for (i = 0; i < db->size; i++) mean[i] += camKeypointsIndexValue(descriptors + rows[j] * rowBytes, db->depth, i);
+    }
+    for (i = 0; i < db->size; i++) mean[i] /= n;
+    for (j = 0; j < n; j++) {
+	for (i = 0; i < db->size; i++) {
+	    x = camKeypointsIndexValue(descriptors + rows[j] * rowBytes, db->depth, i) - mean[i];
+	    var[i] += x * x;
+	}
+    }
+
+    // Random choice among the dimensions with the largest variance
+    for (i = 0; i < db->size; i++) {
+	if (nbDims < CAM_INDEX_RANDOM_DIMS || var[i] > var[dims[nbDims - 1]]) {
+	    if (nbDims < CAM_INDEX_RANDOM_DIMS) nbDims++;
+	    for (k = nbDims - 1; k > 0 && var[i] > var[dims[k - 1]]; k--) dims[k] = dims[k - 1];
+	    dims[k] = i;
+	}
+    }
+    node->i = dims[camKeypointsIndexRandom(seed) % nbDims];
+    node->m = (int)(mean[node->i] + 0.5);
+
+    // Partition of the rows around the mean
+    for (i = 0, left = 0; i < nbRows; i++) {
+	if (camKeypointsIndexValue(descriptors + rows[i] * rowBytes, db->depth, node->i) < node->m) {
+	    tmp = rows[i]; rows[i] = rows[left]; rows[left] = tmp;
+	    left++;
+	}
+    }
+    if (left == 0 || left == nbRows) left = nbRows / 2; // All the rows are on the same side : arbitrary split
+    return left;
+}
+
+// Builds the subtree of the rows from node n. Returns the next free node. The leaves hold -i rows, from rows[m]
+static int camKeypointsIndexRecurs(CamKeypointsIndexNode *nodes, int n, CamKeypointsDatabase *db, int *allRows, int *rows, int nbRows, unsigned int *seed)
+{
+    int left;
+    if (nbRows <= CAM_INDEX_LEAF_SIZE) {
+	nodes[n].i = -nbRows;
+	nodes[n].m = (int)(rows - allRows);
+	nodes[n].right = 0;
+	return n + 1;
+    }
+    left = camKeypointsIndexSplit(&nodes[n], db, rows, nbRows, seed);
+    nodes[n].right = camKeypointsIndexRecurs(nodes, n + 1, db, allRows, rows, left, seed);
+    return camKeypointsIndexRecurs(nodes, nodes[n].right, db, allRows, rows + left, nbRows - left, seed);
+}
+
+int camKeypointsCompileIndex(CamKeypointsIndex *index, CamKeypointsDatabase *db, int nbTrees)
+{
+    int i, j, t, tmp, n, *rows, *allRows, roots[CAM_INDEX_MAX_TREES];
+    unsigned int seed;
+    CamKeypointsIndexNode *nodes;
+
+    CAM_CHECK_ARGS(camKeypointsCompileIndex, index != NULL);
+    CAM_CHECK_ARGS(camKeypointsCompileIndex, db->descriptors != NULL);
+    CAM_CHECK_ARGS2(camKeypointsCompileIndex, nbTrees > 0 && nbTrees <= CAM_INDEX_MAX_TREES, "The number of trees must be between 1 and 64");
+
+    index->nbTrees = 0;
+    index->nbNodes = 0;
+    index->nodes = NULL;
+    index->trees = NULL;
+    index->rows = NULL;
+    index->db = db;
+    index->buffer = NULL;
+    if (db->nbPoints == 0) return 1;
+
+    // The trees are built one after the other in temporary arrays (less than 2 nodes per row in each tree)
+    nodes = (CamKeypointsIndexNode*)malloc(nbTrees * (2 * db->nbPoints - 1) * sizeof(CamKeypointsIndexNode));
+    allRows = (int*)malloc(nbTrees * db->nbPoints * sizeof(int));
+    if (nodes == NULL || allRows == NULL) {
+	if (nodes) free(nodes);
+	if (allRows) free(allRows);
+	camError("camKeypointsCompileIndex", "Memory allocation error");
+	return 0;
+    }
+    for (t = 0, n = 0; t < nbTrees; t++) {
+	// Each tree has its own (reproducible) random sequence, and starts from shuffled rows
+	seed = t + 1;
+	rows = allRows + t * db->nbPoints;
+	for (i = 0; i < db->nbPoints; i++) rows[i] = i;
+	for (i = db->nbPoints - 1; i > 0; i--) {
+	    j = (camKeypointsIndexRandom(&seed) * 32768 + camKeypointsIndexRandom(&seed)) % (i + 1);
+	    tmp = rows[i]; rows[i] = rows[j]; rows[j] = tmp;
+	}
+	roots[t] = n;
+	n = camKeypointsIndexRecurs(nodes, n, db, allRows, rows, db->nbPoints, &seed);
+    }
+
+    // One memory block : the nodes, the roots of the trees and the rows of the leaves
+    index->buffer = malloc(n * sizeof(CamKeypointsIndexNode) + nbTrees * sizeof(int) + nbTrees * db->nbPoints * sizeof(int));
+    if (index->buffer == NULL) {
+	free(nodes);
+	free(allRows);
+	camError("camKeypointsCompileIndex", "Memory allocation error");
+	return 0;
+    }
+    index->nodes = (CamKeypointsIndexNode*)index->buffer;
+    index->trees = (int*)(index->nodes + n);
+    index->rows = index->trees + nbTrees;
+    memcpy(index->nodes, nodes, n * sizeof(CamKeypointsIndexNode));
+    memcpy(index->trees, roots, nbTrees * sizeof(int));
+    memcpy(index->rows, allRows, nbTrees * db->nbPoints * sizeof(int));
+    index->nbTrees = nbTrees;
+    index->nbNodes = n;
+    free(nodes);
+    free(allRows);
+    return 1;
+}
+
+int camFreeKeypointsIndex(CamKeypointsIndex *index)
+{
+    CAM_CHECK_ARGS(camFreeKeypointsIndex, index != NULL);
+    if (index->buffer) free(index->buffer);
+    index->nbTrees = 0;
+    index->nbNodes = 0;
+    index->nodes = NULL;
+    index->trees = NULL;
+    index->rows = NULL;
+    index->db = NULL;
+    index->buffer = NULL;
+    return 1;
+}
+
+static void camKeypointsIndexPush(CamKeypointsIndexBranch *pqueue, int *N, int distance, int node)
+{
+    int k = (*N)++;
+    while (k > 0 && pqueue[(k-1)/2].distance > distance) {
+	pqueue[k] = pqueue[(k-1)/2];
+	k = (k-1)/2;
+    }
+    pqueue[k].distance = distance;
+    pqueue[k].node = node;
+}
+
+static CamKeypointsIndexBranch camKeypointsIndexPop(CamKeypointsIndexBranch *pqueue, int *N)
+{
+    int j, k = 0;
+    const int n = --(*N);
+    CamKeypointsIndexBranch top = pqueue[0], last = pqueue[n];
+    while (2*k+1 < n) {
+	j = 2*k+1;
+	if (j < n-1 && pqueue[j+1].distance < pqueue[j].distance) j++;
+	if (!(pqueue[j].distance < last.distance)) break;
+	pqueue[k] = pqueue[j];
+	k = j;
+    }
+    pqueue[k] = last;
+    return top;
+}
+
+// Descent from a node to a leaf : the other children are queued, with the distance to their cut as a priority.
+// Then the rows of the leaf that were not checked yet (in another tree) are compared to the query
+#define CAM_INDEX_DESCEND \
+    while (node->i >= 0) { \
+	diff = camKeypointsIndexValue(query, db->depth, node->i) - node->m; \
+	if (nbBranches == allocated) { \
+	    allocated *= 2; \
+	    pqueue = (CamKeypointsIndexBranch*)realloc(branches_pqueue, allocated * sizeof(CamKeypointsIndexBranch)); \
+	    if (pqueue == NULL) { error = 1; break; } \
+	    branches_pqueue = pqueue; \
+	} \
+	camKeypointsIndexPush(branches_pqueue, &nbBranches, mindist + abs(diff), (diff < 0) ? node->right : (int)(node - index->nodes) + 1); \
+	node = (diff < 0) ? node + 1 : index->nodes + node->right; \
+    } \
+    if (error) break; \
+    rows = index->rows + node->m; \
+    for (i = 0; i < -node->i; i++) { \
+	row = rows[i]; \
+	if (visited[row] == generation) continue; \
+	visited[row] = generation; \
+	if (db->depth == CAM_DEPTH_8U) { \
+	    d = CAM_QDISTANCE_8U(compare8u((const unsigned char*)descriptors + row * rowBytes, (const unsigned char*)query, db->size)); \
+	} else if (db->depth == CAM_DEPTH_16S) { \
+	    d = CAM_QDISTANCE_16S(compare16s((const short*)(descriptors + row * rowBytes), (const short*)query, db->size)); \
+	} else { \
+	    d = CAM_QDISTANCE_32S(camCompareDescriptors32s((const int*)(descriptors + row * rowBytes), (const int*)query, db->size)); \
+	} \
+	if (bestDistance == -1 || d <= bestDistance) { \
+	    secondBestDistance = bestDistance; \
+	    bestDistance = d; \
+	    best = row; \
+	} else if (secondBestDistance == -1 || d <= secondBestDistance) { \
+	    secondBestDistance = d; \
+	} \
+	checked++; \
+    }
+
+static int camKeypointsIndexSearchAllocate(CamKeypointsIndexSearch *search, CamKeypointsIndex *index)
+{
+    search->allocated = 256;
+    search->generation = 0;
+    search->pqueue = (CamKeypointsIndexBranch*)malloc(search->allocated * sizeof(CamKeypointsIndexBranch));
+    search->visited = (index->nbTrees) ? (unsigned char*)calloc(index->db->nbPoints, 1) : NULL;
+    if (search->pqueue == NULL || (index->nbTrees && search->visited == NULL)) {
+	camKeypointsIndexSearchFree(search);
+	camError("camFindKeypointIndex", "Memory allocation error");
+	return 0;
+    }
+    return 1;
+}
+
+static void camKeypointsIndexSearchFree(CamKeypointsIndexSearch *search)
+{
+    if (search->pqueue) free(search->pqueue);
+    if (search->visited) free(search->visited);
+    search->pqueue = NULL;
+    search->visited = NULL;
+}
+
+// Nearest row of the database (-1 if none)
+static int camKeypointsIndexNearest(CamKeypointsIndex *index, CamKeypointsIndexSearch *search, CamKeypoint *point, int checks, int *dist1, int *dist2)
+{
+    CamKeypointsDatabase *db = index->db;
+    CamKeypointsIndexNode *node;
+    CamKeypointsIndexBranch *branches_pqueue, *pqueue, branch;
+    int i, t, d, diff, row, *rows, mindist, best = -1, checked = 0, error = 0, nbBranches = 0, allocated;
+    int bestDistance = -1, secondBestDistance = -1;
+    int query[128];
+    unsigned char *visited, generation;
+    const int rowBytes = (index->nbTrees) ? camKeypointsDatabaseRowBytes(db->depth, db->size) : 0;
+    const char *descriptors = (index->nbTrees) ? (const char*)db->descriptors : NULL;
+    int (*compare8u)(const unsigned char *d1, const unsigned char *d2, int s) = camCompareDescriptors8u;
+    int (*compare16s)(const short *d1, const short *d2, int s) = camCompareDescriptors16s;
+#if defined(CAM_AVX2) && !defined(CAM_EUCLIDIAN_DISTANCE)
+    if (camGetCPUFeatures() & CAM_CPU_AVX2) {
+	compare8u = camInternalCompareDescriptors8uAVX2;
+	compare16s = camInternalCompareDescriptors16sAVX2;
+    }
+#endif
+
+    *dist1 = -1;
+    *dist2 = -1;
+    if (index->nbTrees == 0) return -1;
+    branches_pqueue = search->pqueue;
+    allocated = search->allocated;
+    visited = search->visited;
+    // A row is visited by this query if its mark is the current generation : the marks are cleared only when it wraps around
+    if (++search->generation == 0) {
+	memset(visited, 0, db->nbPoints);
+	search->generation = 1;
+    }
+    generation = search->generation;
+    camKeypointsDatabaseRow(point, db->depth, db->size, query);
+
+    // A first leaf in each tree...
+    for (t = 0; t < index->nbTrees; t++) {
+	node = index->nodes + index->trees[t];
+	mindist = 0;
+	CAM_INDEX_DESCEND;
+    }
+    // ... and then the nearest branches of all the trees, until enough rows are checked
+    while (!error && checked < checks && nbBranches != 0) {
+	branch = camKeypointsIndexPop(branches_pqueue, &nbBranches);
+	node = index->nodes + branch.node;
+	mindist = branch.distance;
+	CAM_INDEX_DESCEND;
+    }
+
+    // The queue may have been reallocated
+    search->pqueue = branches_pqueue;
+    search->allocated = allocated;
+    if (error) {
+	camError("camFindKeypointIndex", "Memory allocation error");
+	return -1;
+    }
+    *dist1 = bestDistance;
+    *dist2 = secondBestDistance;
+    return best;
+}
+
+CamKeypoint *camFindKeypointIndex(CamKeypoint *point, CamKeypointsIndex *index, int checks, int *dist1, int *dist2)
+{
+    CamKeypointsIndexSearch search;
+    int row;
+
+    *dist1 = -1;
+    *dist2 = -1;
+    if (!camKeypointsIndexSearchAllocate(&search, index)) return NULL;
+    row = camKeypointsIndexNearest(index, &search, point, checks, dist1, dist2);
+    camKeypointsIndexSearchFree(&search);
+    return (row == -1) ? NULL : index->db->keypoint[row];
+}
+
+// Writes data at offset, after the padding
+static int camKeypointsFileWrite(FILE *f, CAM_INT64 *pos, CAM_INT64 offset, const void *data, CAM_INT64 size)
+{
+    static const char zeros[64] = {0};
+    if (offset > *pos && fwrite(zeros, (size_t)(offset - *pos), 1, f) != 1) return 0;
+    if (size && fwrite(data, (size_t)size, 1, f) != 1) return 0;
+    *pos = offset + size;
+    return 1;
+}
+
+int camKeypointsSaveDatabase(CamKeypointsDatabase *db, CamKeypointsIndex *index, const char *filename)
+{
+    CamKeypointsFileHeader header;
+    CamKeypoint point;
+    CAM_INT64 pos = 0;
+    FILE *f;
+    int i, ok;
+    const int rowBytes = camKeypointsDatabaseRowBytes(db->depth, db->size);
+
+    CAM_CHECK_ARGS(camKeypointsSaveDatabase, db->descriptors != NULL);
+    CAM_CHECK_ARGS2(camKeypointsSaveDatabase, index == NULL || index->db == db, "The index must be compiled on this database");
+
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, CAM_KEYPOINTS_FILE_MAGIC);
+    header.version = CAM_KEYPOINTS_FILE_VERSION;
+    header.byteOrder = CAM_KEYPOINTS_FILE_ORDER;
+    header.keypointSize = sizeof(CamKeypoint);
+    header.nbPoints = db->nbPoints;
+    header.size = db->size;
+    header.depth = db->depth;
+    header.keypoints = CAM_ALIGN64_SIZE(sizeof(header));
+    header.descriptors = CAM_ALIGN64_SIZE(header.keypoints + (CAM_INT64)db->nbPoints * sizeof(CamKeypoint));
+    header.id = CAM_ALIGN64_SIZE(header.descriptors + (CAM_INT64)db->nbPoints * rowBytes);
+    header.fileSize = header.id + (CAM_INT64)db->nbPoints * sizeof(int);
+    if (index && index->nbTrees) {
+	header.nbTrees = index->nbTrees;
+	header.nbNodes = index->nbNodes;
+	header.nodes = CAM_ALIGN64_SIZE(header.fileSize);
+	header.trees = CAM_ALIGN64_SIZE(header.nodes + (CAM_INT64)index->nbNodes * sizeof(CamKeypointsIndexNode));
+	header.rows = CAM_ALIGN64_SIZE(header.trees + (CAM_INT64)index->nbTrees * sizeof(int));
+	header.fileSize = header.rows + (CAM_INT64)index->nbTrees * db->nbPoints * sizeof(int);
+    }
+
+    f = fopen(filename, "wb");
+    if (f == NULL) {
+	camError("camKeypointsSaveDatabase", "Unable to open the file");
+	return 0;
+    }
+    ok = camKeypointsFileWrite(f, &pos, 0, &header, sizeof(header));
+    for (i = 0; ok && i < db->nbPoints; i++) {
+	point = *db->keypoint[i];
+	point.set = NULL;
+	point.internal = NULL;
+	ok = camKeypointsFileWrite(f, &pos, (i == 0) ? header.keypoints : pos, &point, sizeof(CamKeypoint));
+    }
+    if (ok) ok = camKeypointsFileWrite(f, &pos, header.descriptors, db->descriptors, (CAM_INT64)db->nbPoints * rowBytes);
+    if (ok) ok = camKeypointsFileWrite(f, &pos, header.id, db->id, (CAM_INT64)db->nbPoints * sizeof(int));
+    if (ok && header.nbTrees) {
+	ok = camKeypointsFileWrite(f, &pos, header.nodes, index->nodes, (CAM_INT64)index->nbNodes * sizeof(CamKeypointsIndexNode));
+	if (ok) ok = camKeypointsFileWrite(f, &pos, header.trees, index->trees, (CAM_INT64)index->nbTrees * sizeof(int));
+	if (ok) ok = camKeypointsFileWrite(f, &pos, header.rows, index->rows, (CAM_INT64)index->nbTrees * db->nbPoints * sizeof(int));
+    }
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) {
+	camError("camKeypointsSaveDatabase", "Unable to write the file");
+	return 0;
+    }
+    return 1;
+}
+
+// Checks that a section lies in the file, after the header, and is aligned like the saved ones
+static int camKeypointsFileSection(CamKeypointsFileHeader *header, CAM_INT64 offset, CAM_INT64 length)
+{
+    return offset >= (CAM_INT64)sizeof(CamKeypointsFileHeader) && (offset & 63) == 0 && offset <= header->fileSize - length;
+}
+
+int camKeypointsMapDatabase(CamKeypointsDatabase *db, CamKeypointsIndex *index, const char *filename)
+{
+    CamKeypointsFileHeader *header;
+    CAM_INT64 size;
+    CamKeypoint *keypoints;
+    int i, valid;
+
+    CAM_CHECK_ARGS(camKeypointsMapDatabase, db != NULL);
+
+    db->nbPoints = 0;
+    db->size = 0;
+    db->depth = 0;
+    db->descriptors = NULL;
+    db->keypoint = NULL;
+    db->id = NULL;
+    db->buffer = NULL;
+    db->file = NULL;
+    if (index) {
+	index->nbTrees = 0;
+	index->nbNodes = 0;
+	index->nodes = NULL;
+	index->trees = NULL;
+	index->rows = NULL;
+	index->db = NULL;
+	index->buffer = NULL;
+    }
+
+    header = (CamKeypointsFileHeader*)camInternalMapFile(filename, &size);
+    if (header == NULL) {
+	camError("camKeypointsMapDatabase", "Unable to map the file");
+	return 0;
+    }
+    // Only the header is checked (the sections must lie in the file) : their contents are used as they are
+    valid = size >= (CAM_INT64)sizeof(CamKeypointsFileHeader) && !strncmp(header->magic, CAM_KEYPOINTS_FILE_MAGIC, 8);
+    if (valid && (header->version != CAM_KEYPOINTS_FILE_VERSION || header->byteOrder != CAM_KEYPOINTS_FILE_ORDER || header->keypointSize != sizeof(CamKeypoint))) {
+	camInternalUnmapFile(header, size);
+	camError("camKeypointsMapDatabase", "Incompatible file (version, byte order or platform)");
+	return 0;
+    }
+    valid = valid && header->fileSize == size && header->nbPoints >= 0
+	&& (header->depth == CAM_DEPTH_8U || header->depth == CAM_DEPTH_16S || header->depth == CAM_DEPTH_32S)
+	&& header->size > 0 && header->size <= 128 && header->size % 32 == 0
+	&& header->nbTrees >= 0 && header->nbTrees <= CAM_INDEX_MAX_TREES && header->nbNodes >= 0 && (header->nbTrees == 0 || header->nbNodes > 0)
+	&& camKeypointsFileSection(header, header->keypoints, (CAM_INT64)header->nbPoints * header->keypointSize)
+	&& camKeypointsFileSection(header, header->descriptors, (CAM_INT64)header->nbPoints * camKeypointsDatabaseRowBytes(header->depth, header->size))
+	&& camKeypointsFileSection(header, header->id, (CAM_INT64)header->nbPoints * sizeof(int))
+	&& (header->nbTrees == 0 || (camKeypointsFileSection(header, header->nodes, (CAM_INT64)header->nbNodes * sizeof(CamKeypointsIndexNode))
+	    && camKeypointsFileSection(header, header->trees, (CAM_INT64)header->nbTrees * sizeof(int))
+	    && camKeypointsFileSection(header, header->rows, (CAM_INT64)header->nbTrees * header->nbPoints * sizeof(int))));
+    if (!valid) {
+	camInternalUnmapFile(header, size);
+	camError("camKeypointsMapDatabase", "Not a keypoints database file");
+	return 0;
+    }
+    if (index && header->nbTrees == 0) {
+	camInternalUnmapFile(header, size);
+	camError("camKeypointsMapDatabase", "The file has no index");
+	return 0;
+    }
+
+    // The keypoints array is the only thing to allocate
+    db->buffer = malloc((header->nbPoints ? header->nbPoints : 1) * sizeof(CamKeypoint*));
+    if (db->buffer == NULL) {
+	camInternalUnmapFile(header, size);
+	camError("camKeypointsMapDatabase", "Memory allocation error");
+	return 0;
+    }
+    db->keypoint = (CamKeypoint**)db->buffer;
+    keypoints = (CamKeypoint*)((char*)header + header->keypoints);
+    for (i = 0; i < header->nbPoints; i++) db->keypoint[i] = &keypoints[i];
+    db->nbPoints = header->nbPoints;
+    db->size = header->size;
+    db->depth = header->depth;
+    db->descriptors = (char*)header + header->descriptors;
+    db->id = (int*)((char*)header + header->id);
+    db->file = header;
+    if (index) {
+	index->nbTrees = header->nbTrees;
+	index->nbNodes = header->nbNodes;
+	index->nodes = (CamKeypointsIndexNode*)((char*)header + header->nodes);
+	index->trees = (int*)((char*)header + header->trees);
+	index->rows = (int*)((char*)header + header->rows);
+	index->db = db;
+    }
+    return 1;
+}
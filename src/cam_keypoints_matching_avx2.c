@@ -0,0 +1,87 @@
+/***************************************
+ *
+ *  Camellia Image Processing Library
+ *
+
+    The Camellia Image Processing Library is an open source low-level image processing library.
+    As it uses the IplImage structure to describe images, it is a good replacement to the IPL (Intel) library
+    and a good complement to the OpenCV library. It includes a lot of functions for image processing
+    (filtering, morphological mathematics, labeling, warping, loading/saving images, etc.),
+    some of them being highly optimized; It is also cross-platform and robust. It is doxygen-documented
+    and examples of use are provided.
+
+    This software library is an outcome of the Camellia european project (IST-2001-34410).
+    It was developped by the Ecole des Mines de Paris (ENSMP), in coordination with
+    the other partners of the project.
+
+  ==========================================================================
+
+    Copyright (c) 2002-2006, Ecole des Mines de Paris - Centre de Robotique
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer
+          in the documentation and/or other materials provided with the distribution.
+        * Neither the name of the Ecole des Mines de Paris nor the names of
+          its contributors may be used to endorse or promote products
+          derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+    EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+    PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+    PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+    LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  ==========================================================================
+*/
+
+/* Keypoints matching
+ * AVX2 code */
+
+#include "camellia.h"
+#include "camellia_internals.h"
+#ifdef CAM_AVX2
+#include <immintrin.h>
+
+// Sum of absolute differences of 8-bit descriptors, 32 bytes at once
+CAM_AVX2_TARGET int camInternalCompareDescriptors8uAVX2(const unsigned char *desc1, const unsigned char *desc2, int size)
+{
+    int i;
+    __m256i sum=_mm256_setzero_si256();
+    __m128i s;
+    for (i=0;i!=size;i+=32) {
+        sum=_mm256_add_epi64(sum,_mm256_sad_epu8(_mm256_loadu_si256((__m256i*)(desc1+i)),_mm256_loadu_si256((__m256i*)(desc2+i))));
+    }
+    s=_mm_add_epi64(_mm256_castsi256_si128(sum),_mm256_extracti128_si256(sum,1));
+    return _mm_cvtsi128_si32(s)+_mm_cvtsi128_si32(_mm_srli_si128(s,8));
+}
+
+// Sum of absolute differences of 16-bit descriptors, 16 elements at once. |a-b|=max(a,b)-min(a,b) fits in 16 bits
+CAM_AVX2_TARGET int camInternalCompareDescriptors16sAVX2(const short *desc1, const short *desc2, int size)
+{
+    int i;
+    __m256i sum=_mm256_setzero_si256(),ones=_mm256_set1_epi16(1),a,b;
+    __m128i s;
+    for (i=0;i!=size;i+=16) {
+        a=_mm256_loadu_si256((__m256i*)(desc1+i));
+        b=_mm256_loadu_si256((__m256i*)(desc2+i));
+        sum=_mm256_add_epi32(sum,_mm256_madd_epi16(_mm256_sub_epi16(_mm256_max_epi16(a,b),_mm256_min_epi16(a,b)),ones));
+    }
+    s=_mm_add_epi32(_mm256_castsi256_si128(sum),_mm256_extracti128_si256(sum,1));
+    s=_mm_add_epi32(s,_mm_srli_si128(s,8));
+    s=_mm_add_epi32(s,_mm_srli_si128(s,4));
+    return _mm_cvtsi128_si32(s);
+}
+
+#endif // CAM_AVX2
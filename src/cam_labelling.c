@@ -48,7 +48,10 @@
 
 /* Labelling Kernel
  * C code */
+#include <stdlib.h>
+#include <string.h>
 #include "camellia.h"
+#include "camellia_internals.h"
 
 /* v1.1 : Added error checking regarding to CAM_LABEL_MAX_BLOBS
  * v1.2 : 19th of November 2002 
@@ -107,7 +110,7 @@ int camLabelling(CamImage *source, CamImage *dest, CamLabellingResults *results)
 	    // This is a new blob
 	    equivTable[nbLabels]=nbLabels;
 	    *(dstptr++)=nbLabels++;
-	    if (nbLabels>=CAM_LABEL_MAX_BLOBS) return 0;
+	    if (nbLabels>=CAM_LABEL_MAX_LABELS) return 0;
 	    nbBlobs++;
 	} else {
 	    *dstptr=*CAM_LABEL_PIXEL_ACCESS(dstptr,0,-1);
@@ -134,7 +137,7 @@ int camLabelling(CamImage *source, CamImage *dest, CamLabellingResults *results)
 	    // This is a new blob
 	    equivTable[nbLabels]=nbLabels;
 	    *(dstptr++)=nbLabels++;
-	    if (nbLabels>=CAM_LABEL_MAX_BLOBS) return 0;
+	    if (nbLabels>=CAM_LABEL_MAX_LABELS) return 0;
 	    nbBlobs++;
 	    optimize1valid=1; // Label optimization is valid : this is a new blob
 	}
@@ -209,7 +212,7 @@ int camLabelling(CamImage *source, CamImage *dest, CamLabellingResults *results)
 		    // No! Then this is a new blob
 		    equivTable[nbLabels]=nbLabels;
 		    *(dstptr++)=nbLabels++;
-		    if (nbLabels>=CAM_LABEL_MAX_BLOBS) return 0;
+		    if (nbLabels>=CAM_LABEL_MAX_LABELS) return 0;
 		    nbBlobs++;
 		    optimize1valid=1; // Label optimization is valid : this is a new blob
 		}
@@ -263,3 +266,473 @@ int camLabelling2ndScan(CamImage *image, CamLabellingResults *results)
     }
     return 1;    
 }
+
+/* Union-find pixel labeling
+ * The lines are processed as runs of identical non-zero pixels : each run is connected to the
+ * runs of the previous line that touch it (union-find with path compression), and the blobs
+ * statistics are accumulated as the runs are found. The lines are split into horizontal strips
+ * that are labelled independently on several threads, then merged along the strips boundaries.
+ * A second pass, also done by strips, writes the final labels into the destination image.
+ */
+#define RANGE_SUM(x,w) ((CAM_INT64)(w)*(2*(x) + (w)-1) / 2)
+#define MIN(x,y) (((x)<(y))?(x):(y))
+#define MAX(x,y) (((x)>(y))?(x):(y))
+
+typedef struct {
+    int start,end;	    // Pixels [start,end[
+    int value;
+    int label;
+} CamLabelingRun;
+
+typedef struct {
+    int left,right;	    // Horizontal extent [left,right[
+    int top,bottom;	    // Vertical extent [top,bottom]
+    int surface;
+    int value;
+    int min,max;	    // Min and max values in the original image
+    CAM_INT64 sx,sy;	    // Centroids accumulators
+    CAM_INT64 sum;	    // Sum of the values in the original image
+} CamLabelingBlob;
+
+typedef struct {
+    int top,bottom;	    // Lines of the strip : [top,bottom[
+    int nbLabels;	    // Number of labels, or -1 if an error occured
+    int allocated;
+    int *root;		    // Union-find forest of the labels
+    CamLabelingBlob *blobs; // Statistics of the labels (valid for the roots only)
+    CamLabelingRun *runs;   // Runs of the strip, with their label
+    int nbRuns,allocatedRuns;
+    int *lines;		    // Index of the first run of each line of the strip
+    int base;		    // Index of the first label of the strip in the whole image
+} CamLabelingStrip;
+
+typedef struct {
+    unsigned char *srcptr,*optr; // First lines of the source and original ROIs
+    int *dstptr;		 // First line of the destination ROI (or NULL)
+    int srcinc,oinc;
+    int srclinc,olinc,dstlinc;
+    int pixelSize,opixelSize;
+    int width,height;
+    int connectivity;
+    int *eq;		    // Union-find forest of all the labels
+    int *ids;		    // Final blob number of each label
+    int nbStrips;
+    CamLabelingStrip strip[CAM_MAX_THREADS];
+} CamLabelingJob;
+
+static int camLabelingFind(int *root, int n)
+{
+    while (root[n]!=n) n=root[n]=root[root[n]];
+    return n;
+}
+
+// Runs of identical non-zero pixels of a line
+static int camLabelingLineRuns(unsigned char *srcptr, int width, int inc, int pixelSize, CamLabelingRun *runs)
+{
+    int x,s,v,n=0;
+    if ((pixelSize==1)&&(inc==1)) {
+	// Runs are extended 8 pixels at a time
+	CAM_UINT64 w,pattern;
+	for (x=0; x<width;) {
+	    v=srcptr[x];
+	    pattern=v; pattern|=pattern<<8; pattern|=pattern<<16; pattern|=pattern<<32;
+	    for (s=x++; x+8<=width; x+=8) {
+		memcpy(&w,srcptr+x,8);
+		if (w!=pattern) break;
+	    }
+	    for (; (x<width)&&(srcptr[x]==v); x++);
+	    if (v==0) continue;
+	    runs[n].start=s;
+	    runs[n].end=x;
+	    runs[n++].value=v;
+	}
+    } else if (pixelSize==1) {
+	unsigned char *ptr=srcptr;
+	for (x=0; x<width;) {
+	    v=*ptr;
+	    ptr+=inc;
+	    if (v==0) {x++; continue;}
+	    for (s=x++; (x<width)&&(*ptr==v); x++, ptr+=inc);
+	    runs[n].start=s;
+	    runs[n].end=x;
+	    runs[n++].value=v;
+	}
+    } else {
+	unsigned short *ptr16=(unsigned short*)srcptr;
+	for (x=0; x<width;) {
+	    v=*ptr16;
+	    ptr16+=inc;
+	    if (v==0) {x++; continue;}
+	    for (s=x++; (x<width)&&(*ptr16==v); x++, ptr16+=inc);
+	    runs[n].start=s;
+	    runs[n].end=x;
+	    runs[n++].value=v;
+	}
+    }
+    return n;
+}
+
+// Accumulates the values of the original image over [start,end[
+static void camLabelingMeasures(CamLabelingBlob *b, unsigned char *ptr, int inc, int pixelSize, int start, int end)
+{
+    int x,v,min=b->min,max=b->max;
+    CAM_INT64 sum=0;
+    for (x=start; x<end; x++) {
+	v=(pixelSize==1)?ptr[x*inc]:((unsigned short*)ptr)[x*inc];
+	sum+=v;
+	if (v<min) min=v;
+	if (v>max) max=v;
+    }
+    b->sum+=sum;
+    b->min=min;
+    b->max=max;
+}
+
+// Labels the runs of line y of a strip, connecting them to the runs of the previous line
+static int camLabelingConnect(CamLabelingJob *job, CamLabelingStrip *s, CamLabelingRun *runs, int nbRuns, CamLabelingRun *prevRuns, int nbPrevRuns, int y, unsigned char *optr)
+{
+    int i,j,n,a,c,k;
+    int e=(job->connectivity==8)?1:0; // Diagonal neighbours
+    int *newRoot;
+    CamLabelingBlob *newBlobs,*blob,*other;
+
+    for (i=0,j=0; i<nbRuns; i++) {
+	// Skip the runs of the previous line that end before this one
+	while ((j<nbPrevRuns)&&(prevRuns[j].end+e<=runs[i].start)) j++;
+	a=-1;
+	for (n=j; (n<nbPrevRuns)&&(prevRuns[n].start<runs[i].end+e); n++) {
+	    if (prevRuns[n].value!=runs[i].value) continue;
+	    c=camLabelingFind(s->root,prevRuns[n].label);
+	    if (a<0) a=c;
+	    else if (c!=a) {
+		// Union : the smaller label becomes the root, and collects the statistics of the other one
+		if (c<a) {k=a; a=c; c=k;}
+		s->root[c]=a;
+		blob=&s->blobs[a]; other=&s->blobs[c];
+		blob->left=MIN(blob->left,other->left);
+		blob->right=MAX(blob->right,other->right);
+		blob->top=MIN(blob->top,other->top);
+		blob->bottom=MAX(blob->bottom,other->bottom);
+		blob->surface+=other->surface;
+		blob->sx+=other->sx;
+		blob->sy+=other->sy;
+		blob->sum+=other->sum;
+		blob->min=MIN(blob->min,other->min);
+		blob->max=MAX(blob->max,other->max);
+	    }
+	}
+	if (a<0) {
+	    // New label
+	    if (s->nbLabels==s->allocated) {
+		k=(s->allocated)?s->allocated*2:CAM_LABEL_MAX_BLOBS;
+		newRoot=(int*)realloc(s->root,k*sizeof(int));
+		if (newRoot) s->root=newRoot;
+		newBlobs=(CamLabelingBlob*)realloc(s->blobs,k*sizeof(CamLabelingBlob));
+		if (newBlobs) s->blobs=newBlobs;
+		if ((newRoot==NULL)||(newBlobs==NULL)) return 0;
+		s->allocated=k;
+	    }
+	    a=s->nbLabels++;
+	    s->root[a]=a;
+	    blob=&s->blobs[a];
+	    blob->left=runs[i].start; blob->right=runs[i].end;
+	    blob->top=blob->bottom=y;
+	    blob->surface=0;
+	    blob->value=runs[i].value;
+	    blob->sx=blob->sy=blob->sum=0;
+	    blob->min=(optr)?0xffff:runs[i].value;
+	    blob->max=(optr)?0:runs[i].value;
+	} else {
+	    blob=&s->blobs[a];
+	    blob->left=MIN(blob->left,runs[i].start);
+	    blob->right=MAX(blob->right,runs[i].end);
+	    blob->bottom=y;
+	}
+	k=runs[i].end-runs[i].start;
+	blob->surface+=k;
+	blob->sx+=RANGE_SUM(runs[i].start,k);
+	blob->sy+=(CAM_INT64)y*k;
+	if (optr) camLabelingMeasures(blob,optr,job->oinc,job->opixelSize,runs[i].start,runs[i].end);
+	runs[i].label=a;
+    }
+    return 1;
+}
+
+// First pass on a strip : the runs are found and labelled
+static void camLabelingStripTask(void *arg, int index)
+{
+    CamLabelingJob *job=(CamLabelingJob*)arg;
+    CamLabelingStrip *s=&job->strip[index];
+    CamLabelingRun *runs;
+    unsigned char *srcptr=job->srcptr+s->top*job->srclinc;
+    unsigned char *optr=(job->optr)?job->optr+s->top*job->olinc:NULL;
+    int y,k,nbRuns;
+
+    s->lines=(int*)malloc((s->bottom-s->top+1)*sizeof(int));
+    if (s->lines==NULL) {
+	s->nbLabels=-1;
+	return;
+    }
+    for (y=s->top; y<s->bottom; y++) {
+	if ((job->dstptr==NULL)&&(y>=s->top+2)) {
+	    // Without destination image, only the runs of the first and previous lines are needed
+	    k=s->lines[y-s->top-1];
+	    memmove(s->runs+s->lines[1],s->runs+k,(s->nbRuns-k)*sizeof(CamLabelingRun));
+	    s->nbRuns-=k-s->lines[1];
+	    s->lines[y-s->top-1]=s->lines[1];
+	}
+	// Room for one more line
+	if (s->nbRuns+job->width>s->allocatedRuns) {
+	    k=MAX(2*s->allocatedRuns,s->nbRuns+job->width);
+	    runs=(CamLabelingRun*)realloc(s->runs,k*sizeof(CamLabelingRun));
+	    if (runs==NULL) {
+		s->nbLabels=-1;
+		return;
+	    }
+	    s->runs=runs;
+	    s->allocatedRuns=k;
+	}
+	s->lines[y-s->top]=s->nbRuns;
+	runs=s->runs+s->nbRuns;
+	nbRuns=camLabelingLineRuns(srcptr,job->width,job->srcinc,job->pixelSize,runs);
+	if (y==s->top) k=camLabelingConnect(job,s,runs,nbRuns,NULL,0,y,optr);
+	else k=camLabelingConnect(job,s,runs,nbRuns,s->runs+s->lines[y-s->top-1],s->nbRuns-s->lines[y-s->top-1],y,optr);
+	if (!k) {
+	    s->nbLabels=-1;
+	    return;
+	}
+	s->nbRuns+=nbRuns;
+	srcptr+=job->srclinc;
+	if (optr) optr+=job->olinc;
+    }
+    s->lines[y-s->top]=s->nbRuns;
+}
+
+// Second pass on a strip : the final labels are written into the destination image
+static void camLabelingRelabelStripTask(void *arg, int index)
+{
+    CamLabelingJob *job=(CamLabelingJob*)arg;
+    CamLabelingStrip *s=&job->strip[index];
+    CamLabelingRun *runs=s->runs;
+    int *dstptr=(int*)((char*)job->dstptr+s->top*job->dstlinc);
+    int *ids=job->ids+s->base;
+    int x,y,i,label;
+
+    for (y=0; y<s->bottom-s->top; y++) {
+	for (i=s->lines[y],x=0; i<s->lines[y+1]; i++) {
+	    for (; x<runs[i].start; x++) dstptr[x]=0;
+	    label=ids[runs[i].label]+1;
+	    for (; x<runs[i].end; x++) dstptr[x]=label;
+	}
+	for (; x<job->width; x++) dstptr[x]=0;
+	dstptr=(int*)((char*)dstptr+job->dstlinc);
+    }
+}
+
+// Merges the labels of the strips, and fills the blobs information
+static int camLabelingMergeStrips(CamLabelingJob *job, CamBlobAnalysisResults *results)
+{
+    CamLabelingStrip *s;
+    CamLabelingBlob *b;
+    CamBlobInfo *blob;
+    CamLabelingRun *r1,*r2;
+    int n1,n2;
+    CAM_INT64 (*sums)[3];
+    int *eq,*ids;
+    int i,j,k,g,n,p,nbLabels,nbBlobs;
+    int e=(job->connectivity==8)?1:0;
+
+    for (nbLabels=0, k=0; k<job->nbStrips; k++) {
+	if (job->strip[k].nbLabels<0) {
+	    camError("camLabelingUnionFind","Memory allocation error");
+	    return 0;
+	}
+	job->strip[k].base=nbLabels;
+	nbLabels+=job->strip[k].nbLabels;
+    }
+    if (nbLabels==0) {
+	// No blob at all : just clear the destination image
+	job->ids=NULL;
+	if (job->dstptr) camInternalParallelRun(camLabelingRelabelStripTask,job,job->nbStrips);
+	return 1;
+    }
+    eq=(int*)malloc(2*nbLabels*sizeof(int));
+    if (eq==NULL) {
+	camError("camLabelingUnionFind","Memory allocation error");
+	return 0;
+    }
+    ids=job->ids=eq+nbLabels;
+    for (k=0; k<job->nbStrips; k++) {
+	s=&job->strip[k];
+	for (i=0; i<s->nbLabels; i++) eq[s->base+i]=s->base+s->root[i];
+    }
+
+    // Merge the labels along the strips boundaries
+    for (k=1; k<job->nbStrips; k++) {
+	s=&job->strip[k];
+	r1=s->runs+s->lines[0];
+	n1=s->lines[1]-s->lines[0];
+	s=&job->strip[k-1];
+	r2=s->runs+s->lines[s->bottom-s->top-1];
+	n2=s->lines[s->bottom-s->top]-s->lines[s->bottom-s->top-1];
+	for (i=0,j=0; i<n1; i++) {
+	    while ((j<n2)&&(r2[j].end+e<=r1[i].start)) j++;
+	    for (p=j; (p<n2)&&(r2[p].start<r1[i].end+e); p++) {
+		if (r2[p].value!=r1[i].value) continue;
+		n=camLabelingFind(eq,job->strip[k].base+r1[i].label);
+		g=camLabelingFind(eq,job->strip[k-1].base+r2[p].label);
+		// Keep the smaller, so that the blobs are numbered in the order of their first pixel
+		if (n<g) eq[g]=n; else eq[n]=g;
+	    }
+	}
+    }
+
+    // Number the blobs
+    for (nbBlobs=0, g=0; g<nbLabels; g++) {
+	if (eq[g]==g) {
+	    ids[g]=nbBlobs++;
+	} else {
+	    eq[g]=eq[eq[g]];
+	    ids[g]=ids[eq[g]];
+	}
+    }
+    if (!camBlobsReserve(results,nbBlobs)) {
+	free(eq);
+	return 0;
+    }
+    sums=(CAM_INT64(*)[3])malloc(nbBlobs*sizeof(*sums));
+    if (sums==NULL) {
+	free(eq);
+	camError("camLabelingUnionFind","Memory allocation error");
+	return 0;
+    }
+
+    // Reduce the statistics of the labels of each strip (only the roots of the strip have some)
+    for (k=0; k<job->nbStrips; k++) {
+	s=&job->strip[k];
+	for (i=0; i<s->nbLabels; i++) {
+	    if (s->root[i]!=i) continue;
+	    g=s->base+i;
+	    b=&s->blobs[i];
+	    n=ids[g];
+	    blob=&results->blobInfo[n];
+	    if (eq[g]==g) {
+		blob->id=n;
+		blob->left=b->left;
+		blob->width=b->right; // Right for now
+		blob->top=b->top;
+		blob->height=b->bottom; // Bottom for now
+		blob->surface=b->surface;
+		blob->value=b->value;
+		blob->min=b->min;
+		blob->max=b->max;
+		blob->first=NULL;
+		blob->last=NULL;
+		sums[n][0]=b->sx;
+		sums[n][1]=b->sy;
+		sums[n][2]=b->sum;
+	    } else {
+		blob->left=MIN(b->left,blob->left);
+		blob->width=MAX(b->right,blob->width);
+		blob->height=MAX(b->bottom,blob->height);
+		blob->surface+=b->surface;
+		blob->min=MIN(b->min,blob->min);
+		blob->max=MAX(b->max,blob->max);
+		sums[n][0]+=b->sx;
+		sums[n][1]+=b->sy;
+		sums[n][2]+=b->sum;
+	    }
+	}
+    }
+    for (i=0; i<nbBlobs; i++) {
+	blob=&results->blobInfo[i];
+	blob->width-=blob->left;
+	blob->height-=blob->top-1;
+	blob->cx=(int)(sums[i][0]/blob->surface);
+	blob->cy=(int)(sums[i][1]/blob->surface);
+	if (job->optr) blob->value=(int)(sums[i][2]/blob->surface);
+    }
+    free(sums);
+
+    // Write the final labels
+    if (job->dstptr) camInternalParallelRun(camLabelingRelabelStripTask,job,job->nbStrips);
+    free(eq);
+    results->nbBlobs=nbBlobs;
+    return 1;
+}
+
+int camLabelingUnionFind(CamImage *source, CamImage *dest, int connectivity, CamImage *original, CamBlobAnalysisResults *results)
+{
+    CamInternalROIPolicyStruct iROI,oROI;
+    CamLabelingJob job;
+    int k,ok;
+
+    results->nbBlobs=0; // Just in case it would fail...
+    results->features=0;
+    CAM_CHECK_ARGS(camLabelingUnionFind,(connectivity==4)||(connectivity==8));
+    CAM_CHECK(camLabelingUnionFind,camInternalROIPolicy(source,NULL,&iROI,0));
+    CAM_CHECK_ARGS(camLabelingUnionFind,iROI.nChannels==1);
+    CAM_CHECK_ARGS(camLabelingUnionFind,(source->depth&CAM_DEPTH_MASK)<=16);
+    CAM_CHECK_ARGS(camLabelingUnionFind,(source->depth&CAM_DEPTH_MASK)>=8);
+    job.width=iROI.srcroi.width;
+    job.height=iROI.srcroi.height;
+    job.pixelSize=((source->depth&CAM_DEPTH_MASK)==8)?1:2;
+    job.srcptr=(unsigned char*)iROI.srcptr;
+    job.srcinc=iROI.srcinc;
+    job.srclinc=source->widthStep;
+    job.connectivity=connectivity;
+    job.optr=NULL;
+    if (original) {
+	CAM_CHECK(camLabelingUnionFind,camInternalROIPolicy(original,NULL,&oROI,0));
+	CAM_CHECK_ARGS(camLabelingUnionFind,oROI.nChannels==1);
+	CAM_CHECK_ARGS(camLabelingUnionFind,(original->depth&CAM_DEPTH_MASK)<=16);
+	CAM_CHECK_ARGS(camLabelingUnionFind,(original->depth&CAM_DEPTH_MASK)>=8);
+	CAM_CHECK_ARGS(camLabelingUnionFind,(oROI.srcroi.width==job.width)&&(oROI.srcroi.height==job.height));
+	job.opixelSize=((original->depth&CAM_DEPTH_MASK)==8)?1:2;
+	job.optr=(unsigned char*)oROI.srcptr;
+	job.oinc=oROI.srcinc;
+	job.olinc=original->widthStep;
+    }
+    job.dstptr=NULL;
+    if (dest) {
+	CAM_CHECK_ARGS2(camLabelingUnionFind,(dest->depth&CAM_DEPTH_MASK)==32,"destination image must be 32 bits deep");
+	CAM_CHECK_ARGS(camLabelingUnionFind,dest->nChannels==1);
+	if (dest->roi) {
+	    CAM_CHECK_ARGS(camLabelingUnionFind,(dest->roi->width==job.width)&&(dest->roi->height==job.height));
+	    job.dstptr=(int*)(dest->imageData+dest->roi->yOffset*dest->widthStep+dest->roi->xOffset*sizeof(int));
+	} else {
+	    CAM_CHECK_ARGS(camLabelingUnionFind,(dest->width==job.width)&&(dest->height==job.height));
+	    job.dstptr=(int*)dest->imageData;
+	}
+	job.dstlinc=dest->widthStep;
+    }
+    if (job.width==0) return 1;
+
+    job.nbStrips=camGetNumThreads();
+    if (job.nbStrips>job.height/CAM_MIN_BAND_HEIGHT) job.nbStrips=job.height/CAM_MIN_BAND_HEIGHT;
+    if (job.nbStrips<1) job.nbStrips=1;
+    for (k=0; k<job.nbStrips; k++) {
+	job.strip[k].top=job.height*k/job.nbStrips;
+	job.strip[k].bottom=job.height*(k+1)/job.nbStrips;
+	job.strip[k].nbLabels=0;
+	job.strip[k].allocated=0;
+	job.strip[k].root=NULL;
+	job.strip[k].blobs=NULL;
+	job.strip[k].runs=NULL;
+	job.strip[k].nbRuns=0;
+	job.strip[k].allocatedRuns=0;
+	job.strip[k].lines=NULL;
+    }
+
+    // Label the strips independently, then merge them
+    camInternalParallelRun(camLabelingStripTask,&job,job.nbStrips);
+    ok=camLabelingMergeStrips(&job,results);
+
+    for (k=0; k<job.nbStrips; k++) {
+	free(job.strip[k].root);
+	free(job.strip[k].blobs);
+	free(job.strip[k].runs);
+	free(job.strip[k].lines);
+    }
+    return ok;
+}
@@ -60,6 +60,9 @@
 #undef CAM_PIXEL_DST
 #define CAM_PIXEL char
 #define CAM_PIXEL_DST unsigned char
+#ifdef CAM_AVX2
+#define CAM_LF_SIMD
+#endif
 
 // 3x3 Kernel Linear Filtering code generation
 #define camLinearFilter camLinearFilter3x38
@@ -91,6 +94,8 @@
 #undef CAM_LF_NEIGHB_X
 #undef CAM_LF_NEIGHB_Y
 
+#undef CAM_LF_SIMD
+
 // 3x3 Sobel Filter
 #define CAM_SOBEL
 #define camLinearFilter camSobel8
@@ -108,6 +113,8 @@
 #undef camLinearFilterKernelPtr
 #undef CAM_LF_NEIGHB_X
 #undef CAM_LF_NEIGHB_Y
+#undef vertical_edges
+#undef CAM_SOBEL
 
 #undef CAM_PIXEL
 #undef CAM_PIXEL_DST
@@ -161,11 +168,16 @@
 #undef camLinearFilterKernelPtr
 #undef CAM_LF_NEIGHB_X
 #undef CAM_LF_NEIGHB_Y
+#undef vertical_edges
+#undef CAM_SOBEL
 
 #undef CAM_PIXEL
 #undef CAM_PIXEL_DST
 #define CAM_PIXEL char
 #define CAM_PIXEL_DST unsigned short
+#ifdef CAM_AVX2
+#define CAM_LF_SIMD
+#endif
 
 // 3x3 Kernel Linear Filtering code generation
 #define camLinearFilter camLinearFilter3x38to16
@@ -198,6 +210,8 @@
 #undef CAM_LF_NEIGHB_X
 #undef CAM_LF_NEIGHB_Y
 
+#undef CAM_LF_SIMD
+
 // 3x3 Sobel Filter
 #define CAM_SOBEL
 #define camLinearFilter camSobel8to16
@@ -215,6 +229,8 @@
 #undef camLinearFilterKernelPtr
 #undef CAM_LF_NEIGHB_X
 #undef CAM_LF_NEIGHB_Y
+#undef vertical_edges
+#undef CAM_SOBEL
 
 #undef CAM_PIXEL
 #undef CAM_PIXEL_DST
@@ -269,8 +285,10 @@
 #undef camLinearFilterKernelPtr
 #undef CAM_LF_NEIGHB_X
 #undef CAM_LF_NEIGHB_Y
+#undef vertical_edges
+#undef CAM_SOBEL
 
-int camLinearFilter3x3(CamImage* source, CamImage* dest, CamLinearFilterKernel *params)
+static int camLinearFilter3x3Serial(CamImage* source, CamImage* dest, CamLinearFilterKernel *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         if ((dest->depth&CAM_DEPTH_MASK)==8) {
@@ -283,7 +301,7 @@ int camLinearFilter3x3(CamImage* source, CamImage* dest, CamLinearFilterKernel *
     }
 }
 
-int camLinearFilterAbs3x3(CamImage* source, CamImage* dest, CamLinearFilterKernel *params)
+static int camLinearFilterAbs3x3Serial(CamImage* source, CamImage* dest, CamLinearFilterKernel *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         if ((dest->depth&CAM_DEPTH_MASK)==8) {
@@ -296,7 +314,7 @@ int camLinearFilterAbs3x3(CamImage* source, CamImage* dest, CamLinearFilterKerne
     }
 }
 
-int camLinearFilter5x5(CamImage* source, CamImage* dest, CamLinearFilterKernel *params)
+static int camLinearFilter5x5Serial(CamImage* source, CamImage* dest, CamLinearFilterKernel *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         if ((dest->depth&CAM_DEPTH_MASK)==8) {
@@ -309,7 +327,7 @@ int camLinearFilter5x5(CamImage* source, CamImage* dest, CamLinearFilterKernel *
     }
 }
 
-int camLinearFilterAbs5x5(CamImage* source, CamImage* dest, CamLinearFilterKernel *params)
+static int camLinearFilterAbs5x5Serial(CamImage* source, CamImage* dest, CamLinearFilterKernel *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         if ((dest->depth&CAM_DEPTH_MASK)==8) {
@@ -322,6 +340,11 @@ int camLinearFilterAbs5x5(CamImage* source, CamImage* dest, CamLinearFilterKerne
     }
 }
 
+CAM_PARALLEL_BANDS_FUNCTION(camLinearFilter3x3, CamLinearFilterKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camLinearFilterAbs3x3, CamLinearFilterKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camLinearFilter5x5, CamLinearFilterKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camLinearFilterAbs5x5, CamLinearFilterKernel*, CAM_BANDS_SUM)
+
 int camSobel(CamImage* source, CamImage* dest, int vert_edges)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
@@ -746,7 +769,7 @@ int camSobelAbs(CamImage* source, CamImage* dest, int vert_edges)
 #undef CAM_LF_NEIGHB_X
 #undef CAM_LF_NEIGHB_Y
 
-int camSepFilter3x3(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
+static int camSepFilter3x3Serial(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         if ((dest->depth&CAM_DEPTH_MASK)==8) {
@@ -759,7 +782,7 @@ int camSepFilter3x3(CamImage* source, CamImage* dest, CamSepFilterKernel *params
     }
 }
 
-int camSepFilterAbs3x3(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
+static int camSepFilterAbs3x3Serial(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         if ((dest->depth&CAM_DEPTH_MASK)==8) {
@@ -772,7 +795,7 @@ int camSepFilterAbs3x3(CamImage* source, CamImage* dest, CamSepFilterKernel *par
     }
 }
 
-int camSepFilter5x5(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
+static int camSepFilter5x5Serial(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         if ((dest->depth&CAM_DEPTH_MASK)==8) {
@@ -785,7 +808,7 @@ int camSepFilter5x5(CamImage* source, CamImage* dest, CamSepFilterKernel *params
     }
 }
 
-int camSepFilterAbs5x5(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
+static int camSepFilterAbs5x5Serial(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         if ((dest->depth&CAM_DEPTH_MASK)==8) {
@@ -798,7 +821,7 @@ int camSepFilterAbs5x5(CamImage* source, CamImage* dest, CamSepFilterKernel *par
     }
 }
 
-int camSepFilter7x7(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
+static int camSepFilter7x7Serial(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         if ((dest->depth&CAM_DEPTH_MASK)==8) {
@@ -811,7 +834,7 @@ int camSepFilter7x7(CamImage* source, CamImage* dest, CamSepFilterKernel *params
     }
 }
 
-int camSepFilterAbs7x7(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
+static int camSepFilterAbs7x7Serial(CamImage* source, CamImage* dest, CamSepFilterKernel *params)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         if ((dest->depth&CAM_DEPTH_MASK)==8) {
@@ -824,6 +847,13 @@ int camSepFilterAbs7x7(CamImage* source, CamImage* dest, CamSepFilterKernel *par
     }
 }
 
+CAM_PARALLEL_BANDS_FUNCTION(camSepFilter3x3, CamSepFilterKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camSepFilterAbs3x3, CamSepFilterKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camSepFilter5x5, CamSepFilterKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camSepFilterAbs5x5, CamSepFilterKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camSepFilter7x7, CamSepFilterKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camSepFilterAbs7x7, CamSepFilterKernel*, CAM_BANDS_SUM)
+
 int camSobelH(CamImage* source, CamImage* dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
@@ -1034,7 +1064,7 @@ int camScharrVAbs(CamImage* source, CamImage* dest)
 #undef CAM_LF_NEIGHB_Y
 #undef CAM_FIXED_FILTER
 
-int camFixedFilter(CamImage *source, CamImage *dest, int filter)
+static int camFixedFilterSerial(CamImage *source, CamImage *dest, int filter)
 {
     switch (filter) {
 	case CAM_SOBEL_H :
@@ -1111,6 +1141,16 @@ int camFixedFilter(CamImage *source, CamImage *dest, int filter)
     return 0;
 }
 
+static int camFixedFilterBand(CamImage *source, CamImage *dest, void *params)
+{
+    return camFixedFilterSerial(source,dest,*(int*)params);
+}
+
+int camFixedFilter(CamImage *source, CamImage *dest, int filter)
+{
+    return camInternalParallelBands(source,dest,&filter,camFixedFilterBand,0);
+}
+
 #else
 
 #undef CAM_PIXEL
@@ -0,0 +1,293 @@
+/***************************************
+ *
+ *  Camellia Image Processing Library
+ *
+
+    The Camellia Image Processing Library is an open source low-level image processing library.
+    As it uses the IplImage structure to describe images, it is a good replacement to the IPL (Intel) library
+    and a good complement to the OpenCV library. It includes a lot of functions for image processing
+    (filtering, morphological mathematics, labeling, warping, loading/saving images, etc.),
+    some of them being highly optimized; It is also cross-platform and robust. It is doxygen-documented
+    and examples of use are provided.
+
+    This software library is an outcome of the Camellia european project (IST-2001-34410).
+    It was developped by the Ecole des Mines de Paris (ENSMP), in coordination with
+    the other partners of the project.
+
+  ==========================================================================
+
+    Copyright (c) 2002-2006, Ecole des Mines de Paris - Centre de Robotique
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer
+          in the documentation and/or other materials provided with the distribution.
+        * Neither the name of the Ecole des Mines de Paris nor the names of
+          its contributors may be used to endorse or promote products
+          derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+    EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+    PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+    PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+    LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  ==========================================================================
+*/
+
+/* Linear Filtering Kernel
+ * AVX2 code */
+
+#include "camellia.h"
+#include "camellia_internals.h"
+#ifdef CAM_AVX2
+#include <immintrin.h>
+#endif
+
+int camInternalLinearFilterPrepareSIMD(CamLinearFilterSIMDKernel *k, int nbk, int *xpk, int *ypk, int *valk, int coeff1, int coeff2, int valmin, int valmax, int options)
+{
+    int j,c0,c1;
+
+    if ((nbk==0)||(nbk>CAM_LF_SIMD_MAX_TAPS)) return 0;
+    for (j=0;j<nbk;j++) {
+        // Coefficients are multiplied as 16-bit integers
+        if ((valk[j]<-32768)||(valk[j]>32767)) return 0;
+    }
+    // Taps are processed by pairs. An odd tap is paired with a null coefficient
+    k->nbPairs=(nbk+1)>>1;
+    for (j=0;j<(k->nbPairs<<1);j++) {
+        k->xp[j]=xpk[(j<nbk)?j:nbk-1];
+        k->yp[j]=ypk[(j<nbk)?j:nbk-1];
+    }
+    for (j=0;j<k->nbPairs;j++) {
+        c0=valk[j<<1];
+        c1=((j<<1)+1<nbk)?valk[(j<<1)+1]:0;
+        k->coeffs[j]=(int)((c0&0xffff)|((unsigned int)c1<<16));
+    }
+    k->nbh=0;
+    k->coeff1=coeff1;
+    k->coeff2=coeff2;
+    k->valmin=valmin;
+    k->valmax=valmax;
+    k->options=options;
+    return 1;
+}
+
+int camInternalSepFilterPrepareSIMD(CamLinearFilterSIMDKernel *k, int nbx, const int *x, int nby, const int *y, int coeff1, int coeff2, int valmin, int valmax, int options)
+{
+    int i,nbk,sum=0;
+    int xpk[CAM_LF_SIMD_MAX_TAPS],ypk[CAM_LF_SIMD_MAX_TAPS],valk[CAM_LF_SIMD_MAX_TAPS];
+
+    if ((nbx>CAM_LF_SIMD_MAX_TAPS)||(nby>CAM_LF_SIMD_MAX_TAPS)) return 0;
+    // The horizontal pass must fit in 16-bit integers
+    for (i=0;i<nbx;i++) {
+        sum+=(x[i]<0)?-x[i]:x[i];
+    }
+    if (sum*((options&CAM_LF_SIMD_SRC_SIGNED)?128:255)>32767) return 0;
+
+    // The vertical pass is a 2D kernel with one column
+    nbk=0;
+    for (i=0;i<nby;i++) {
+        if (y[i]) {
+            xpk[nbk]=0;
+            ypk[nbk]=i;
+            valk[nbk]=y[i];
+            nbk++;
+        }
+    }
+    if (nbk==0) {
+        // Null kernel : a single null tap
+        xpk[0]=0; ypk[0]=0; valk[0]=0; nbk=1;
+    }
+    if (!camInternalLinearFilterPrepareSIMD(k,nbk,xpk,ypk,valk,coeff1,coeff2,valmin,valmax,options)) return 0;
+
+    // Horizontal taps, null coefficients being skipped
+    for (i=0;i<nbx;i++) {
+        if (x[i]) {
+            k->xh[k->nbh]=i;
+            k->hcoeffs[k->nbh]=x[i];
+            k->nbh++;
+        }
+    }
+    return 1;
+}
+
+#ifdef CAM_AVX2
+
+// Scaling, saturation and storage of 16 results (lo holds pixels 0-3 and 8-11, hi holds pixels 4-7 and 12-15,
+// as unpack instructions work within 128-bit lanes). Returns the saturated results, to be accumulated
+static CAM_AVX2_TARGET __m256i camLinearFilterStoreAVX2(__m256i lo, __m256i hi, void *dstptr, int x, CamLinearFilterSIMDKernel *k)
+{
+    __m256i res,vmin,vmax;
+
+    if (k->coeff1!=1) {
+        lo=_mm256_mullo_epi32(lo,_mm256_set1_epi32(k->coeff1));
+        hi=_mm256_mullo_epi32(hi,_mm256_set1_epi32(k->coeff1));
+    }
+    if (k->coeff2!=0) {
+        lo=_mm256_sra_epi32(lo,_mm_cvtsi32_si128(k->coeff2));
+        hi=_mm256_sra_epi32(hi,_mm_cvtsi32_si128(k->coeff2));
+    }
+    if (k->options&CAM_LF_SIMD_ABS) {
+        lo=_mm256_abs_epi32(lo);
+        hi=_mm256_abs_epi32(hi);
+    }
+    // Saturation
+    vmin=_mm256_set1_epi32(k->valmin);
+    vmax=_mm256_set1_epi32(k->valmax);
+    lo=_mm256_min_epi32(_mm256_max_epi32(lo,vmin),vmax);
+    hi=_mm256_min_epi32(_mm256_max_epi32(hi,vmin),vmax);
+
+    // Store the results in destination image. Packing restores the order of the pixels
+    if (k->options&CAM_LF_SIMD_DEST16) {
+        if (k->options&CAM_LF_SIMD_SIGNED) res=_mm256_packs_epi32(lo,hi);
+        else res=_mm256_packus_epi32(lo,hi);
+        _mm256_storeu_si256((__m256i*)((unsigned short*)dstptr+x),res);
+    } else {
+        res=_mm256_packs_epi32(lo,hi);
+        if (k->options&CAM_LF_SIMD_SIGNED) res=_mm256_packs_epi16(res,res);
+        else res=_mm256_packus_epi16(res,res);
+        res=_mm256_permute4x64_epi64(res,0x08);
+        _mm_storeu_si128((__m128i*)((unsigned char*)dstptr+x),_mm256_castsi256_si128(res));
+    }
+    return _mm256_add_epi32(lo,hi);
+}
+
+static CAM_AVX2_TARGET int camLinearFilterSumAVX2(__m256i vacc)
+{
+    __m128i sum;
+    sum=_mm_add_epi32(_mm256_castsi256_si128(vacc),_mm256_extracti128_si256(vacc,1));
+    sum=_mm_add_epi32(sum,_mm_shuffle_epi32(sum,0x4e));
+    sum=_mm_add_epi32(sum,_mm_shuffle_epi32(sum,0xb1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+CAM_AVX2_TARGET int camInternalLinearFilterLineAVX2(unsigned char **lines, int offset, int width, void *dstptr, CamLinearFilterSIMDKernel *k, int *acc)
+{
+    int x,p;
+    unsigned char *ptr[CAM_LF_SIMD_MAX_TAPS];
+    __m256i coeffs[CAM_LF_SIMD_MAX_TAPS/2];
+    __m256i a,b,lo,hi,vacc;
+
+    for (p=0;p<(k->nbPairs<<1);p++) {
+        ptr[p]=lines[k->yp[p]]+offset+k->xp[p];
+    }
+    for (p=0;p<k->nbPairs;p++) {
+        coeffs[p]=_mm256_set1_epi32(k->coeffs[p]);
+    }
+    vacc=_mm256_setzero_si256();
+
+    for (x=0;x+16<=width;x+=16) {
+        // 16 pixels are processed at once, in two sets of 32-bit accumulators
+        lo=_mm256_setzero_si256();
+        hi=_mm256_setzero_si256();
+        for (p=0;p<k->nbPairs;p++) {
+            a=_mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(ptr[p<<1]+x)));
+            b=_mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(ptr[(p<<1)+1]+x)));
+            lo=_mm256_add_epi32(lo,_mm256_madd_epi16(_mm256_unpacklo_epi16(a,b),coeffs[p]));
+            hi=_mm256_add_epi32(hi,_mm256_madd_epi16(_mm256_unpackhi_epi16(a,b),coeffs[p]));
+        }
+        vacc=_mm256_add_epi32(vacc,camLinearFilterStoreAVX2(lo,hi,dstptr,x,k));
+    }
+
+    *acc+=camLinearFilterSumAVX2(vacc);
+    return x;
+}
+
+// Horizontal pass of separable filters : 16-bit results
+CAM_AVX2_TARGET void camInternalSepFilterLineHAVX2(unsigned char *src, short *dst, int width, CamLinearFilterSIMDKernel *k)
+{
+    int x,i,result;
+    __m256i coeffs[CAM_LF_SIMD_MAX_TAPS];
+    __m256i pix,sum;
+
+    for (i=0;i<k->nbh;i++) {
+        coeffs[i]=_mm256_set1_epi16((short)k->hcoeffs[i]);
+    }
+    for (x=0;x+16<=width;x+=16) {
+        sum=_mm256_setzero_si256();
+        for (i=0;i<k->nbh;i++) {
+            if (k->options&CAM_LF_SIMD_SRC_SIGNED) {
+                pix=_mm256_cvtepi8_epi16(_mm_loadu_si128((__m128i*)(src+x+k->xh[i])));
+            } else {
+                pix=_mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(src+x+k->xh[i])));
+            }
+            sum=_mm256_add_epi16(sum,_mm256_mullo_epi16(pix,coeffs[i]));
+        }
+        _mm256_storeu_si256((__m256i*)(dst+x),sum);
+    }
+    for (;x<width;x++) {
+        result=0;
+        for (i=0;i<k->nbh;i++) {
+            if (k->options&CAM_LF_SIMD_SRC_SIGNED) {
+                result+=k->hcoeffs[i]*(int)((signed char*)src)[x+k->xh[i]];
+            } else {
+                result+=k->hcoeffs[i]*(int)src[x+k->xh[i]];
+            }
+        }
+        dst[x]=(short)result;
+    }
+}
+
+// Vertical pass of separable filters, on the 16-bit lines produced by the horizontal pass
+CAM_AVX2_TARGET void camInternalSepFilterLineVAVX2(short **lines, int offset, int width, void *dstptr, CamLinearFilterSIMDKernel *k, int *acc)
+{
+    int x,p,result,sum;
+    short *ptr[CAM_LF_SIMD_MAX_TAPS];
+    __m256i coeffs[CAM_LF_SIMD_MAX_TAPS/2];
+    __m256i a,b,lo,hi,vacc;
+
+    for (p=0;p<(k->nbPairs<<1);p++) {
+        ptr[p]=lines[k->yp[p]]+offset;
+    }
+    for (p=0;p<k->nbPairs;p++) {
+        coeffs[p]=_mm256_set1_epi32(k->coeffs[p]);
+    }
+    vacc=_mm256_setzero_si256();
+
+    for (x=0;x+16<=width;x+=16) {
+        lo=_mm256_setzero_si256();
+        hi=_mm256_setzero_si256();
+        for (p=0;p<k->nbPairs;p++) {
+            a=_mm256_loadu_si256((__m256i*)(ptr[p<<1]+x));
+            b=_mm256_loadu_si256((__m256i*)(ptr[(p<<1)+1]+x));
+            lo=_mm256_add_epi32(lo,_mm256_madd_epi16(_mm256_unpacklo_epi16(a,b),coeffs[p]));
+            hi=_mm256_add_epi32(hi,_mm256_madd_epi16(_mm256_unpackhi_epi16(a,b),coeffs[p]));
+        }
+        vacc=_mm256_add_epi32(vacc,camLinearFilterStoreAVX2(lo,hi,dstptr,x,k));
+    }
+    sum=camLinearFilterSumAVX2(vacc);
+
+    // Remaining pixels
+    for (;x<width;x++) {
+        result=0;
+        for (p=0;p<k->nbPairs;p++) {
+            result+=(int)ptr[p<<1][x]*(short)(k->coeffs[p]&0xffff)+(int)ptr[(p<<1)+1][x]*(k->coeffs[p]>>16);
+        }
+        if (k->coeff1!=1) result*=k->coeff1;
+        if (k->coeff2!=0) result>>=k->coeff2;
+        if ((k->options&CAM_LF_SIMD_ABS)&&(result<0)) result=-result;
+        if (result<k->valmin) result=k->valmin;
+        else if (result>k->valmax) result=k->valmax;
+        if (k->options&CAM_LF_SIMD_DEST16) {
+            ((unsigned short*)dstptr)[x]=(unsigned short)result;
+        } else {
+            ((unsigned char*)dstptr)[x]=(unsigned char)result;
+        }
+        sum+=result;
+    }
+    if (acc) *acc+=sum;
+}
+
+#endif // CAM_AVX2
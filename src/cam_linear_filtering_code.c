@@ -59,7 +59,9 @@ int camLinearFilter(CamImage *source, CamImage *dest, camLinearFilterKernelPtr p
     CAM_PIXEL *srcptr,*tmpptr,*cpsrcptr;
     CAM_PIXEL_DST *dstptr,*cpdstptr;
     unsigned CAM_PIXEL *linesPtr[CAM_LF_NEIGHB_Y];
-    CAM_PIXEL linesBuffer[CAM_LF_NEIGHB_Y][((CAM_MAX_SCANLINE+CAM_LF_NEIGHB_X-1+CAM_ALIGN)&~15)+16];
+    CAM_PIXEL linesStack[CAM_LF_NEIGHB_Y][((CAM_MAX_SCANLINE+CAM_LF_NEIGHB_X-1+CAM_ALIGN)&~15)+16];
+    CAM_PIXEL *linesBuffer;
+    int lineSize;
     int valmax;
 #ifndef CAM_SOBEL
     int xp,yp;
@@ -70,6 +72,10 @@ int camLinearFilter(CamImage *source, CamImage *dest, camLinearFilterKernelPtr p
     int valk[CAM_LF_NEIGHB_X*CAM_LF_NEIGHB_Y];
 #else
     int results[3];
+#endif
+#ifdef CAM_LF_SIMD
+    CamLinearFilterSIMDKernel simdk;
+    int simd;
 #endif
     DECLARE_MASK_MANAGEMENT;
 
@@ -104,12 +110,21 @@ int camLinearFilter(CamImage *source, CamImage *dest, camLinearFilterKernelPtr p
     CAM_CHECK_ARGS(camLinearFilter,(width>CAM_LF_NEIGHB_X/2));
     CAM_CHECK_ARGS(camLinearFilter,(height>CAM_LF_NEIGHB_Y/2));    
     
+    // Line buffers (on the stack up to CAM_MAX_SCANLINE)
+    lineSize=((source->width-left+CAM_LF_NEIGHB_X-1+CAM_ALIGN)&~15)+16;
+    linesBuffer=(CAM_PIXEL*)camInternalScratchAlloc(linesStack,sizeof(linesStack),CAM_LF_NEIGHB_Y*lineSize*sizeof(CAM_PIXEL));
+    if (linesBuffer==NULL) {
+        camInternalROIPolicyExit(&iROI);
+        camError("camLinearFilter","Memory allocation error");
+        return 0;
+    }
+
     // Mask management
     INIT_MASK_MANAGEMENT;
 
     // Initialize algorithm
     for (i=0;i<CAM_LF_NEIGHB_Y;i++) {
-        linesPtr[i]=linesBuffer[i];
+        linesPtr[i]=(unsigned CAM_PIXEL*)linesBuffer+i*lineSize;
     }
     if (dest->depth&CAM_DEPTH_SIGN) {
         valmax>>=1;
@@ -130,6 +145,20 @@ int camLinearFilter(CamImage *source, CamImage *dest, camLinearFilterKernelPtr p
         }
     }
 #endif
+
+#ifdef CAM_LF_SIMD
+    // Vectorized code path, for unsigned source pixels and contiguous destination pixels
+    simd=((camGetCPUFeatures()&CAM_CPU_AVX2)&&(!(source->depth&CAM_DEPTH_SIGN))&&(iROI.dstinc==1));
+    if (simd) {
+#ifdef CAM_LF_ABS
+        simd=camInternalLinearFilterPrepareSIMD(&simdk,nbk,xpk,ypk,valk,params->coeff1,params->coeff2,0,valmax,
+            CAM_LF_SIMD_ABS|((sizeof(CAM_PIXEL_DST)==2)?CAM_LF_SIMD_DEST16:0)|((dest->depth&CAM_DEPTH_SIGN)?CAM_LF_SIMD_SIGNED:0));
+#else
+        simd=camInternalLinearFilterPrepareSIMD(&simdk,nbk,xpk,ypk,valk,params->coeff1,params->coeff2,(dest->depth&CAM_DEPTH_SIGN)?-valmax:0,valmax,
+            ((sizeof(CAM_PIXEL_DST)==2)?CAM_LF_SIMD_DEST16:0)|((dest->depth&CAM_DEPTH_SIGN)?CAM_LF_SIMD_SIGNED:0));
+#endif
+    }
+#endif
     
     // Initialize neighbourhood
     
@@ -332,8 +361,18 @@ int camLinearFilter(CamImage *source, CamImage *dest, camLinearFilterKernelPtr p
 		}
 #endif
 
+	    x=startx+CAM_LF_NEIGHB_X-1;
+#ifdef CAM_LF_SIMD
+	    if (simd) {
+		// Vectorized processing of the run. The remaining pixels are processed by the C code
+		i=camInternalLinearFilterLineAVX2(linesPtr,startx+CAM_ALIGN,endx-startx,dstptr,&simdk,&acc);
+		x+=i;
+		dstptr+=i;
+	    }
+#endif
+
 	    // Process all the pixels in the line
-	    for (x=startx+CAM_LF_NEIGHB_X-1;x<endx+CAM_LF_NEIGHB_X-1;x++) {   
+	    for (;x<endx+CAM_LF_NEIGHB_X-1;x++) {   
 
 #ifdef CAM_SOBEL
 		if (vertical_edges) {
@@ -400,6 +439,7 @@ int camLinearFilter(CamImage *source, CamImage *dest, camLinearFilterKernelPtr p
         linesPtr[CAM_LF_NEIGHB_Y-1]=tmpptr;
     }
     
+    camInternalScratchFree(linesStack,linesBuffer);
     camInternalROIPolicyExit(&iROI);
     return acc;
 }
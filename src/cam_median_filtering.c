@@ -50,6 +50,7 @@
  * C code */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "camellia.h"
 #include "camellia_internals.h"
@@ -98,7 +99,7 @@
 #undef camMedianFilterParams
 #undef CAM_MF_NEIGHB
 
-int camMedianFilter3x3(CamImage *source, CamImage *dest)
+static int camMedianFilter3x3Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camMedianFilter3x316(source,dest);
@@ -107,7 +108,7 @@ int camMedianFilter3x3(CamImage *source, CamImage *dest)
     }
 }
 
-int camMedianFilter5x5(CamImage *source, CamImage *dest)
+static int camMedianFilter5x5Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camMedianFilter5x516(source,dest);
@@ -115,6 +116,9 @@ int camMedianFilter5x5(CamImage *source, CamImage *dest)
         return camMedianFilter5x58(source,dest);
     }
 }
+
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camMedianFilter3x3, 0)
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camMedianFilter5x5, 0)
 #else
 
 // 3x3 Kernel Median Filtering code generation
@@ -137,3 +141,202 @@ int camMedianFilter5x5(CamImage *source, CamImage *dest)
 
 #endif
 
+// Constant-time median filtering (Perreault & Hebert algorithm), for any odd neighbourhood size
+// Each column of the line buffer keeps the histogram of the pixels of the vertical window, in 16 coarse bins
+// (4 upper bits) and 256 fine bins. The kernel histogram is updated by adding the column entering the window
+// and subtracting the one leaving it. Fine bins are only brought up to date for the coarse bin holding the median.
+
+#define CAM_MF_COARSE 16
+#define CAM_MF_FINE 256
+
+// Fills a line of the neighbourhood with the source line y, which may be out of frame
+static void camMedianFilterNxNLine(CamImage *source, CamInternalROIPolicyStruct *iROI, unsigned char *line, int y, int left, int width, int half)
+{
+    int x,xs,side;
+    unsigned char *srcptr;
+
+    if ((y<0)||(y>=source->height)) {
+        side=(y<0)?CAM_SIDE_TOP_INDEX:CAM_SIDE_BOTTOM_INDEX;
+        if (source->borderMode[side]!=CAM_BORDER_REPLICATE) {
+            memset(line,source->borderConst[side],width+2*half);
+            return;
+        }
+        y=(y<0)?0:source->height-1;
+    }
+    srcptr=(unsigned char*)(source->imageData+iROI->srcchoffset+y*source->widthStep);
+    for (x=0;(x<width+2*half)&&(left+x-half<0);x++) {
+        // Out of frame : fill with border color
+        if (source->borderMode[CAM_SIDE_LEFT_INDEX]==CAM_BORDER_REPLICATE) {
+            line[x]=*srcptr;
+        } else {
+            line[x]=source->borderConst[CAM_SIDE_LEFT_INDEX];
+        }
+    }
+    for (xs=x;(x<width+2*half)&&(left+x-half<source->width);x++);
+    if (iROI->srcinc==1) {
+        // Fast transfer with memcpy
+        memcpy(line+xs,srcptr+left+xs-half,x-xs);
+    } else {
+        for (;xs<x;xs++) {
+            line[xs]=srcptr[(left+xs-half)*iROI->srcinc];
+        }
+    }
+    for (;x<width+2*half;x++) {
+        // Out of frame : fill with border color
+        if (source->borderMode[CAM_SIDE_RIGHT_INDEX]==CAM_BORDER_REPLICATE) {
+            line[x]=srcptr[(source->width-1)*iROI->srcinc];
+        } else {
+            line[x]=source->borderConst[CAM_SIDE_RIGHT_INDEX];
+        }
+    }
+}
+
+// Adds (inc=1) or removes (inc=-1) a line to the column histograms
+static void camMedianFilterNxNColumns(unsigned short *hcoarse, unsigned short *hfine, unsigned char *line, int lineSize, int inc)
+{
+    int x;
+    for (x=0;x<lineSize;x++) {
+        hcoarse[x*CAM_MF_COARSE+(line[x]>>4)]+=inc;
+        hfine[x*CAM_MF_FINE+line[x]]+=inc;
+    }
+}
+
+static int camMedianFilterNxNSerial(CamImage *source, CamImage *dest, int size)
+{
+    int i,b,c,x,y,rank;
+    int width,height,left,top,half,lineSize;
+    unsigned char *dstptr,*cpdstptr,*tmpptr,*buffer;
+    unsigned char **linesPtr;
+    unsigned short *hcoarse,*hfine,*hptr,*hold,*hnew; // Column histograms
+    unsigned short kcoarse[CAM_MF_COARSE],kfine[CAM_MF_FINE]; // Kernel histogram
+    int kstamp[CAM_MF_COARSE]; // Column of the last update of the fine bins, for each coarse bin
+    CamInternalROIPolicyStruct iROI;
+
+    // ROI (Region Of Interest) management
+    CAM_CHECK(camMedianFilterNxN,camInternalROIPolicy(source, dest, &iROI, 1));
+    CAM_CHECK_ARGS(camMedianFilterNxN,iROI.nChannels==1);
+    CAM_CHECK_ARGS(camMedianFilterNxN,(source->depth&CAM_DEPTH_MASK)==8);
+    CAM_CHECK_ARGS(camMedianFilterNxN,(dest->depth&CAM_DEPTH_MASK)==8);
+    // Kernel histogram counts must fit in 16 bits
+    CAM_CHECK_ARGS(camMedianFilterNxN,(size&1)&&(size>=3)&&(size<=255));
+
+    width=iROI.srcroi.width;
+    height=iROI.srcroi.height;
+    if (source->roi) {
+        left=iROI.srcroi.xOffset;
+        top=iROI.srcroi.yOffset;
+    } else {
+        left=0;
+        top=0;
+    }
+    dstptr=(unsigned char*)iROI.dstptr;
+    half=size/2;
+    lineSize=width+size-1;
+
+    // Line buffers and column histograms
+    buffer=(unsigned char*)malloc(size*sizeof(unsigned char*)+lineSize*(CAM_MF_COARSE+CAM_MF_FINE)*sizeof(unsigned short)+size*lineSize);
+    if (buffer==NULL) {
+        camInternalROIPolicyExit(&iROI);
+        camError("camMedianFilterNxN","Memory allocation error");
+        return 0;
+    }
+    linesPtr=(unsigned char**)buffer;
+    hcoarse=(unsigned short*)(buffer+size*sizeof(unsigned char*));
+    hfine=hcoarse+lineSize*CAM_MF_COARSE;
+    memset(hcoarse,0,lineSize*(CAM_MF_COARSE+CAM_MF_FINE)*sizeof(unsigned short));
+    tmpptr=(unsigned char*)(hfine+lineSize*CAM_MF_FINE);
+    for (i=0;i<size;i++) {
+        linesPtr[i]=tmpptr+i*lineSize;
+    }
+
+    // Initialize neighbourhood
+    for (i=0;i<size-1;i++) {
+        camMedianFilterNxNLine(source,&iROI,linesPtr[i],top+i-half,left,width,half);
+        camMedianFilterNxNColumns(hcoarse,hfine,linesPtr[i],lineSize,1);
+    }
+
+    // Now process the whole image
+    // This is the main loop
+    for (y=0;y<height;y++) {
+        cpdstptr=dstptr;
+
+        // Start a new line
+        camMedianFilterNxNLine(source,&iROI,linesPtr[size-1],top+y+half,left,width,half);
+        camMedianFilterNxNColumns(hcoarse,hfine,linesPtr[size-1],lineSize,1);
+
+        // Kernel histogram of the first pixel of the line
+        for (b=0;b<CAM_MF_COARSE;b++) {
+            kcoarse[b]=0;
+            kstamp[b]=-size;
+        }
+        for (c=0;c<size-1;c++) {
+            hptr=hcoarse+c*CAM_MF_COARSE;
+            for (b=0;b<CAM_MF_COARSE;b++) kcoarse[b]+=hptr[b];
+        }
+
+        // Process all the pixels in the line
+        for (x=0;x<width;x++) {
+            // Add the column entering the neighbourhood, and remove the one leaving it
+            hnew=hcoarse+(x+size-1)*CAM_MF_COARSE;
+            if (x) {
+                hold=hcoarse+(x-1)*CAM_MF_COARSE;
+                for (b=0;b<CAM_MF_COARSE;b++) kcoarse[b]+=hnew[b]-hold[b];
+            } else {
+                for (b=0;b<CAM_MF_COARSE;b++) kcoarse[b]+=hnew[b];
+            }
+
+            // Find the coarse bin holding the median
+            rank=size*size/2;
+            for (b=0;rank>=kcoarse[b];b++) rank-=kcoarse[b];
+
+            // Bring its fine bins up to date
+            if (2*(x-kstamp[b])>=size) {
+                // Compute them from scratch
+                for (i=0;i<16;i++) kfine[b*16+i]=0;
+                for (c=x;c<x+size;c++) {
+                    hptr=hfine+c*CAM_MF_FINE+b*16;
+                    for (i=0;i<16;i++) kfine[b*16+i]+=hptr[i];
+                }
+            } else {
+                for (c=kstamp[b]+1;c<=x;c++) {
+                    hnew=hfine+(c+size-1)*CAM_MF_FINE+b*16;
+                    hold=hfine+(c-1)*CAM_MF_FINE+b*16;
+                    for (i=0;i<16;i++) kfine[b*16+i]+=hnew[i]-hold[i];
+                }
+            }
+            kstamp[b]=x;
+
+            // Retrieve the median value
+            for (i=b*16;rank>=kfine[i];i++) rank-=kfine[i];
+
+            // Store the result in destination image
+            *dstptr=(unsigned char)i;
+            dstptr+=iROI.dstinc;
+        }
+
+        // Go to next line
+        dstptr=cpdstptr+dest->widthStep;
+
+        // Remove the top line from the column histograms, and reset neighborhood line pointers
+        camMedianFilterNxNColumns(hcoarse,hfine,linesPtr[0],lineSize,-1);
+        tmpptr=linesPtr[0];
+        for (i=0;i<size-1;i++) {
+            linesPtr[i]=linesPtr[i+1];
+        }
+        linesPtr[size-1]=tmpptr;
+    }
+
+    free(buffer);
+    camInternalROIPolicyExit(&iROI);
+    return 1;
+}
+
+static int camMedianFilterNxNBand(CamImage *source, CamImage *dest, void *params)
+{
+    return camMedianFilterNxNSerial(source,dest,*(int*)params);
+}
+
+int camMedianFilterNxN(CamImage *source, CamImage *dest, int size)
+{
+    return camInternalParallelBands(source,dest,&size,camMedianFilterNxNBand,0);
+}
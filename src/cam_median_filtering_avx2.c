@@ -0,0 +1,89 @@
+/***************************************
+ *
+ *  Camellia Image Processing Library
+ *
+
+    The Camellia Image Processing Library is an open source low-level image processing library.
+    As it uses the IplImage structure to describe images, it is a good replacement to the IPL (Intel) library
+    and a good complement to the OpenCV library. It includes a lot of functions for image processing
+    (filtering, morphological mathematics, labeling, warping, loading/saving images, etc.),
+    some of them being highly optimized; It is also cross-platform and robust. It is doxygen-documented
+    and examples of use are provided.
+
+    This software library is an outcome of the Camellia european project (IST-2001-34410).
+    It was developped by the Ecole des Mines de Paris (ENSMP), in coordination with
+    the other partners of the project.
+
+  ==========================================================================
+
+    Copyright (c) 2002-2006, Ecole des Mines de Paris - Centre de Robotique
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer
+          in the documentation and/or other materials provided with the distribution.
+        * Neither the name of the Ecole des Mines de Paris nor the names of
+          its contributors may be used to endorse or promote products
+          derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+    EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+    PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+    PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+    LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  ==========================================================================
+*/
+
+/* Median Filtering Kernel
+ * AVX2 code */
+
+#include "camellia.h"
+#include "camellia_internals.h"
+#ifdef CAM_AVX2
+#include <immintrin.h>
+
+#define CAM_MF_SORT_AVX2(a,b) t=p[a]; p[a]=_mm256_min_epu8(t,p[b]); p[b]=_mm256_max_epu8(t,p[b]);
+
+// 3x3 or 5x5 median filtering of 8-bit pixels, 32 pixels at once
+CAM_AVX2_TARGET int camInternalMedianFilterLineAVX2(unsigned char **lines, int width, unsigned char *dstptr, int neighb)
+{
+    int x,xp,yp;
+    __m256i p[25],t;
+
+    if (neighb==3) {
+        for (x=0;x+32<=width;x+=32) {
+            for (yp=0;yp<3;yp++) {
+                for (xp=0;xp<3;xp++) {
+                    p[yp*3+xp]=_mm256_loadu_si256((__m256i*)(lines[yp]+x+xp));
+                }
+            }
+            CAM_MF_NETWORK9(CAM_MF_SORT_AVX2)
+            _mm256_storeu_si256((__m256i*)(dstptr+x),p[4]);
+        }
+    } else {
+        for (x=0;x+32<=width;x+=32) {
+            for (yp=0;yp<5;yp++) {
+                for (xp=0;xp<5;xp++) {
+                    p[yp*5+xp]=_mm256_loadu_si256((__m256i*)(lines[yp]+x+xp));
+                }
+            }
+            CAM_MF_NETWORK25(CAM_MF_SORT_AVX2)
+            _mm256_storeu_si256((__m256i*)(dstptr+x),p[12]);
+        }
+    }
+    return x;
+}
+
+#endif // CAM_AVX2
@@ -57,12 +57,15 @@ int camMedianFilter(CamImage *source, CamImage *dest)
     int left,top;
     CAM_PIXEL *srcptr,*dstptr,*tmpptr,*cpsrcptr,*cpdstptr;
     CAM_PIXEL *linesPtr[CAM_MF_NEIGHB];
-    CAM_PIXEL linesBuffer[CAM_MF_NEIGHB][CAM_MAX_SCANLINE+CAM_MF_NEIGHB-1];
+    CAM_PIXEL linesStack[CAM_MF_NEIGHB][CAM_MAX_SCANLINE+CAM_MF_NEIGHB-1];
+    CAM_PIXEL *linesBuffer;
+    int lineSize;
     
-    // Data for sorting pixels in the neighbourhood
-    int values[CAM_MF_NEIGHB*CAM_MF_NEIGHB];
-    int next[CAM_MF_NEIGHB*CAM_MF_NEIGHB];
-    int first,last,nb,prev;
+    // Pixels in the neighbourhood, sorted by the selection network
+    int p[CAM_MF_NEIGHB*CAM_MF_NEIGHB];
+#ifdef CAM_AVX2
+    int simd;
+#endif
     
     CamInternalROIPolicyStruct iROI;
     
@@ -91,10 +94,22 @@ int camMedianFilter(CamImage *source, CamImage *dest)
     dstptr=(CAM_PIXEL*)iROI.dstptr;
     CAM_CHECK_ARGS(camMedianFilter,(width>CAM_MF_NEIGHB/2));
     CAM_CHECK_ARGS(camMedianFilter,(height>CAM_MF_NEIGHB/2));    
+#ifdef CAM_AVX2
+    simd=((camGetCPUFeatures()&CAM_CPU_AVX2)&&(sizeof(CAM_PIXEL)==1)&&(iROI.dstinc==1));
+#endif
 	
+    // Line buffers (on the stack up to CAM_MAX_SCANLINE)
+    lineSize=source->width-left+CAM_MF_NEIGHB-1;
+    linesBuffer=(CAM_PIXEL*)camInternalScratchAlloc(linesStack,sizeof(linesStack),CAM_MF_NEIGHB*lineSize*sizeof(CAM_PIXEL));
+    if (linesBuffer==NULL) {
+        camInternalROIPolicyExit(&iROI);
+        camError("camMedianFilter","Memory allocation error");
+        return 0;
+    }
+
     // Initialize algorithm
     for (i=0;i<CAM_MF_NEIGHB;i++) {
-	linesPtr[i]=linesBuffer[i];
+	linesPtr[i]=linesBuffer+i*lineSize;
     }
 
     // Initialize neighbourhood
@@ -104,15 +119,10 @@ int camMedianFilter(CamImage *source, CamImage *dest)
         // Out of frame : fill with border color
         if (source->borderMode[CAM_SIDE_TOP_INDEX]==CAM_BORDER_REPLICATE) {
             cpsrcptr=srcptr;
-            for (x=0;x<CAM_MF_NEIGHB/2;x++) {
-                linesPtr[y][x]=*srcptr;
-            }
-            for (;x<width+CAM_MF_NEIGHB/2;x++) {
+            for (x=0;x<width+CAM_MF_NEIGHB-1;x++) {
                 linesPtr[y][x]=*srcptr;
-                srcptr+=iROI.srcinc;
-            }
-            for (;x<width+CAM_MF_NEIGHB-1;x++) {
-                linesPtr[y][x]=*(srcptr-iROI.srcinc);
+                // Stay on the first and last pixels of the line
+                if ((left+x-CAM_MF_NEIGHB/2>=0)&&(left+x-CAM_MF_NEIGHB/2<source->width-1)) srcptr+=iROI.srcinc;
             }
             srcptr=cpsrcptr;
         } else {
@@ -173,15 +183,10 @@ int camMedianFilter(CamImage *source, CamImage *dest)
                 // Go up one line (in order to stay on the last line)
                 cpsrcptr=(CAM_PIXEL*)(((char*)cpsrcptr)-source->widthStep);
                 srcptr=cpsrcptr;
-                for (x=0;x<CAM_MF_NEIGHB/2;x++) {
+                for (x=0;x<width+CAM_MF_NEIGHB-1;x++) {
                     linesPtr[CAM_MF_NEIGHB-1][x]=*srcptr;
-                }
-                for (;x<width+CAM_MF_NEIGHB/2;x++) {
-                    linesPtr[CAM_MF_NEIGHB-1][x]=*srcptr;
-                    srcptr+=iROI.srcinc;
-                }
-                for (;x<width+CAM_MF_NEIGHB-1;x++) {
-                    linesPtr[CAM_MF_NEIGHB-1][x]=*(srcptr-iROI.srcinc);
+                    // Stay on the first and last pixels of the line
+                    if ((left+x-CAM_MF_NEIGHB/2>=0)&&(left+x-CAM_MF_NEIGHB/2<source->width-1)) srcptr+=iROI.srcinc;
                 }
             } else {
                 for (x=0;x<width+CAM_MF_NEIGHB-1;x++) {
@@ -207,6 +212,7 @@ int camMedianFilter(CamImage *source, CamImage *dest)
             // Fast transfer with memcpy
             if (iROI.srcinc==1) {
                 memcpy(&linesPtr[CAM_MF_NEIGHB-1][x],srcptr,(source->width-left+CAM_MF_NEIGHB/2-x)<<(sizeof(CAM_PIXEL)-1));
+                srcptr+=source->width-left+CAM_MF_NEIGHB/2-x;
                 x=source->width-left+CAM_MF_NEIGHB/2;
             } else {
                 for (;x<source->width-left+CAM_MF_NEIGHB/2;x++) {
@@ -218,7 +224,7 @@ int camMedianFilter(CamImage *source, CamImage *dest)
             for (;x<width+CAM_MF_NEIGHB-1;x++) {
                 // Out of frame : fill with border color
                 if (source->borderMode[CAM_SIDE_RIGHT_INDEX]==CAM_BORDER_REPLICATE) {
-                    linesPtr[CAM_MF_NEIGHB-1][x]=*(srcptr+(source->width-1)*iROI.srcinc);
+                    linesPtr[CAM_MF_NEIGHB-1][x]=*(srcptr-iROI.srcinc);
                 } else {
                     linesPtr[CAM_MF_NEIGHB-1][x]=source->borderConst[CAM_SIDE_RIGHT_INDEX];
                 }
@@ -226,60 +232,35 @@ int camMedianFilter(CamImage *source, CamImage *dest)
         }
 
 	// Process all the pixels in the line
-	for (x=CAM_MF_NEIGHB-1;x<width+CAM_MF_NEIGHB-1;x++) {
+	x=CAM_MF_NEIGHB-1;
+#ifdef CAM_AVX2
+	if (simd) {
+	    i=camInternalMedianFilterLineAVX2((unsigned char**)linesPtr,width,(unsigned char*)dstptr,CAM_MF_NEIGHB);
+	    x+=i;
+	    dstptr+=i;
+	}
+#endif
+	for (;x<width+CAM_MF_NEIGHB-1;x++) {
 
-	    // Now, let's sort the pixels in the neighbourhood
-	    first=0;
-	    last=0;
-	    nb=1;
+	    // Get the pixels in the neighbourhood
 	    i=x-CAM_MF_NEIGHB+1;
-	    // Get the first pixel
-	    value=linesPtr[0][i];
-	    // And put it in the sorted list
-	    values[0]=value;
-	    next[0]=-1;
-
-#define INSERT_VALUE(value)				\
-	    values[nb]=value;				\
-	    if (value>values[first]) {			\
-		prev=first;				\
-		j=next[first];				\
-		while ((j!=-1)&&(value>values[j])) {	\
-		    prev=j;				\
-		    j=next[j];				\
-		}					\
-		if (j==-1) {				\
-		    next[last]=nb;			\
-		    last=nb;				\
-		    next[nb]=-1;			\
-		} else {				\
-		    next[nb]=j;				\
-		    next[prev]=nb;			\
-		}					\
-	    } else {					\
-		next[nb]=first;				\
-		first=nb;				\
-	    }						\
-	    nb++;			
-
-    	    for (xp=1;xp<CAM_MF_NEIGHB;xp++) {
-		value=linesPtr[0][i+xp];
-		INSERT_VALUE(value);
-	    }
-
-	    for (yp=1;yp<CAM_MF_NEIGHB;yp++) {
+	    for (yp=0;yp<CAM_MF_NEIGHB;yp++) {
 		for (xp=0;xp<CAM_MF_NEIGHB;xp++) {
-		    value=linesPtr[yp][i+xp];
-		    INSERT_VALUE(value);
+		    p[yp*CAM_MF_NEIGHB+xp]=linesPtr[yp][i+xp];
 		}
 	    }
 
+	    // And sort them with the selection network (no branches)
+#define CAM_MF_SORT(a,b) value=p[a]; p[a]=CAM_MIN(value,p[b]); p[b]=CAM_MAX(value,p[b]);
+#if CAM_MF_NEIGHB==3
+	    CAM_MF_NETWORK9(CAM_MF_SORT)
+#else
+	    CAM_MF_NETWORK25(CAM_MF_SORT)
+#endif
+#undef CAM_MF_SORT
+
 	    // Retrieve the median value
-	    j=first;
-	    for (i=0;i<CAM_MF_NEIGHB*CAM_MF_NEIGHB/2;i++) {
-		j=next[j];
-	    }
-	    result=values[j];
+	    result=p[CAM_MF_NEIGHB*CAM_MF_NEIGHB/2];
 
 	    // Store the result in destination image
 	    *dstptr=result;
@@ -298,6 +279,7 @@ int camMedianFilter(CamImage *source, CamImage *dest)
 	linesPtr[CAM_MF_NEIGHB-1]=tmpptr;
     }
 
+    camInternalScratchFree(linesStack,linesBuffer);
     camInternalROIPolicyExit(&iROI);
     return 1;
 }
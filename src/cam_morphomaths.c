@@ -370,7 +370,7 @@ int camFindLocalMaximaCircle7(CamImage *source, CamKeypoints *points, int thresh
     }
 }
 
-int camErodeCircle7(CamImage *source, CamImage *dest)
+static int camErodeCircle7Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camErodeCircle716(source,dest);
@@ -379,7 +379,7 @@ int camErodeCircle7(CamImage *source, CamImage *dest)
     }
 }
 
-int camErodeCircle5(CamImage *source, CamImage *dest)
+static int camErodeCircle5Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camErodeCircle516(source,dest);
@@ -388,7 +388,7 @@ int camErodeCircle5(CamImage *source, CamImage *dest)
     }
 }
 
-int camErodeSquare3(CamImage *source, CamImage *dest)
+static int camErodeSquare3Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camErodeSquare316(source,dest);
@@ -397,7 +397,7 @@ int camErodeSquare3(CamImage *source, CamImage *dest)
     }
 }
 
-int camDilateCircle7(CamImage *source, CamImage *dest)
+static int camDilateCircle7Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camDilateCircle716(source,dest);
@@ -406,7 +406,7 @@ int camDilateCircle7(CamImage *source, CamImage *dest)
     }
 }
 
-int camDilateCircle5(CamImage *source, CamImage *dest)
+static int camDilateCircle5Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camDilateCircle516(source,dest);
@@ -415,7 +415,7 @@ int camDilateCircle5(CamImage *source, CamImage *dest)
     }
 }
 
-int camDilateSquare3(CamImage *source, CamImage *dest)
+static int camDilateSquare3Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camDilateSquare316(source,dest);
@@ -424,7 +424,7 @@ int camDilateSquare3(CamImage *source, CamImage *dest)
     }
 }
 
-int camMorphoGradientCircle7(CamImage *source, CamImage *dest)
+static int camMorphoGradientCircle7Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camMorphoGradientCircle716(source,dest);
@@ -433,7 +433,7 @@ int camMorphoGradientCircle7(CamImage *source, CamImage *dest)
     }
 }
 
-int camMorphoGradientCircle5(CamImage *source, CamImage *dest)
+static int camMorphoGradientCircle5Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camMorphoGradientCircle516(source,dest);
@@ -442,7 +442,7 @@ int camMorphoGradientCircle5(CamImage *source, CamImage *dest)
     }
 }
 
-int camMorphoGradientSquare3(CamImage *source, CamImage *dest)
+static int camMorphoGradientSquare3Serial(CamImage *source, CamImage *dest)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camMorphoGradientSquare316(source,dest);
@@ -451,7 +451,7 @@ int camMorphoGradientSquare3(CamImage *source, CamImage *dest)
     }
 }
 
-int camMorphoMaths(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
+static int camMorphoMathsSerial(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camMorphoMaths16(source,dest,kernel);
@@ -460,7 +460,7 @@ int camMorphoMaths(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kerne
     }
 }
 
-int camDilate3x3(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
+static int camDilate3x3Serial(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camDilate3x316(source,dest,kernel);
@@ -469,7 +469,7 @@ int camDilate3x3(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
     }
 }
 
-int camDilate5x5(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
+static int camDilate5x5Serial(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camDilate5x516(source,dest,kernel);
@@ -478,7 +478,7 @@ int camDilate5x5(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
     }
 }
 
-int camDilate7x7(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
+static int camDilate7x7Serial(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camDilate7x716(source,dest,kernel);
@@ -487,7 +487,7 @@ int camDilate7x7(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
     }
 }
 
-int camErode3x3(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
+static int camErode3x3Serial(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camErode3x316(source,dest,kernel);
@@ -496,7 +496,7 @@ int camErode3x3(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
     }
 }
 
-int camErode5x5(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
+static int camErode5x5Serial(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camErode5x516(source,dest,kernel);
@@ -505,7 +505,7 @@ int camErode5x5(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
     }
 }
 
-int camErode7x7(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
+static int camErode7x7Serial(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
 {
     if ((source->depth&CAM_DEPTH_MASK)>8) {
         return camErode7x716(source,dest,kernel);
@@ -514,6 +514,23 @@ int camErode7x7(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kernel)
     }
 }
 
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camErodeCircle7, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camErodeCircle5, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camErodeSquare3, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camDilateCircle7, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camDilateCircle5, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camDilateSquare3, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camMorphoGradientCircle7, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camMorphoGradientCircle5, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION_NOPARAMS(camMorphoGradientSquare3, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camMorphoMaths, CamMorphoMathsKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camDilate3x3, CamMorphoMathsKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camDilate5x5, CamMorphoMathsKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camDilate7x7, CamMorphoMathsKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camErode3x3, CamMorphoMathsKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camErode5x5, CamMorphoMathsKernel*, CAM_BANDS_SUM)
+CAM_PARALLEL_BANDS_FUNCTION(camErode7x7, CamMorphoMathsKernel*, CAM_BANDS_SUM)
+
 #else
 
 #define CAM_MM_NEIGHB 5
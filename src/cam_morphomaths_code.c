@@ -96,7 +96,9 @@ int camMorphoMaths(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kerne
 
     unsigned CAM_PIXEL *srcptr,*dstptr,*tmpptr,*cpsrcptr,*cpdstptr,*lptr;
     unsigned CAM_PIXEL *linesPtr[CAM_MM_NEIGHB];
-    CAM_PIXEL linesBuffer[CAM_MM_NEIGHB][CAM_MAX_SCANLINE+CAM_MM_NEIGHB-1];
+    CAM_PIXEL linesStack[CAM_MM_NEIGHB][CAM_MAX_SCANLINE+CAM_MM_NEIGHB-1];
+    CAM_PIXEL *linesBuffer;
+    int lineSize;
 
     DECLARE_MASK_MANAGEMENT;
     CamInternalROIPolicyStruct iROI;
@@ -138,12 +140,21 @@ int camMorphoMaths(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kerne
     CAM_CHECK_ARGS(CamMorphoMathsKernel,(width>CAM_MM_NEIGHB/2));
     CAM_CHECK_ARGS(CamMorphoMathsKernel,(height>CAM_MM_NEIGHB/2));    
 	
+    // Line buffers (on the stack up to CAM_MAX_SCANLINE)
+    lineSize=source->width-left+CAM_MM_NEIGHB-1;
+    linesBuffer=(CAM_PIXEL*)camInternalScratchAlloc(linesStack,sizeof(linesStack),CAM_MM_NEIGHB*lineSize*sizeof(CAM_PIXEL));
+    if (linesBuffer==NULL) {
+        camInternalROIPolicyExit(&iROI);
+        camError("CamMorphoMathsKernel","Memory allocation error");
+        return 0;
+    }
+
     // Mask management
     INIT_MASK_MANAGEMENT;
 
     // Initialize algorithm
     for (i=0;i<CAM_MM_NEIGHB;i++) {
-	linesPtr[i]=linesBuffer[i];
+	linesPtr[i]=(unsigned CAM_PIXEL*)linesBuffer+i*lineSize;
     }
     
     // Analyze the parameters
@@ -408,6 +419,7 @@ int camMorphoMaths(CamImage *source, CamImage *dest, CamMorphoMathsKernel *kerne
 	linesPtr[CAM_MM_NEIGHB-1]=tmpptr;
     }
 
+    camInternalScratchFree(linesStack,linesBuffer);
     camInternalROIPolicyExit(&iROI);
     return acc;
 }
@@ -431,7 +443,9 @@ int camMorphoMaths1U(CamImage *source, CamImage *dest, CamMorphoMathsKernel *ker
     int idempotence=1;
 #endif
     unsigned char *linesPtr[CAM_MM_NEIGHB],*tmpptr;
-    unsigned char linesBuffer[CAM_MM_NEIGHB][CAM_MAX_SCANLINE/8+2*sizeof(CAM_BIT_BLOCK)];
+    CAM_BIT_BLOCK linesStack[CAM_MM_NEIGHB][CAM_MAX_SCANLINE/CAM_BIT_BLOCK_SIZE+3];
+    CAM_BIT_BLOCK *linesBuffer;
+    int lineSize;
 #define NEIGHBORHOOD_SIZE ((CAM_MM_NEIGHB*16)/CAM_BIT_BLOCK_SIZE+1)
     CAM_BIT_BLOCK fillValue[2],neighborhood[NEIGHBORHOOD_SIZE];
 #ifdef CAM_MM_DO_EROSION
@@ -472,9 +486,17 @@ int camMorphoMaths1U(CamImage *source, CamImage *dest, CamMorphoMathsKernel *ker
 	dstptr=(CAM_BIT_BLOCK*)dest->imageData;
     }
 	
+    // Line buffers (on the stack up to CAM_MAX_SCANLINE), in bit blocks
+    lineSize=((((left-nlb)%CAM_BIT_BLOCK_SIZE)+nlb+width+CAM_MM_NEIGHB)>>CAM_BIT_BLOCK_SIZE_SHIFT)+3;
+    linesBuffer=(CAM_BIT_BLOCK*)camInternalScratchAlloc(linesStack,sizeof(linesStack),CAM_MM_NEIGHB*lineSize*sizeof(CAM_BIT_BLOCK));
+    if (linesBuffer==NULL) {
+        camError("CamMorphoMathsKernel","Memory allocation error");
+        return 0;
+    }
+
     // Initialize algorithm
     for (i=0;i<CAM_MM_NEIGHB;i++) {
-	linesPtr[i]=linesBuffer[i];
+	linesPtr[i]=(unsigned char*)(linesBuffer+i*lineSize);
     }
 
     // Analyze the parameters
@@ -819,6 +841,7 @@ int camMorphoMaths1U(CamImage *source, CamImage *dest, CamMorphoMathsKernel *ker
 	linesPtr[CAM_MM_NEIGHB-1]=tmpptr;
     }
 
+    camInternalScratchFree(linesStack,linesBuffer);
 #ifdef CAM_MM_ONE_OP
     return 1;
 #else
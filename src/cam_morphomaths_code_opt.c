@@ -129,7 +129,9 @@ int camDilateCircle7(CamImage *source, CamImage *dest)
 
     CAM_PIXEL *srcptr,*dstptr,*tmpptr,*cpsrcptr,*cpdstptr;
     unsigned CAM_PIXEL *linesPtr[CAM_MM_NEIGHB];
-    CAM_PIXEL linesBuffer[CAM_MM_NEIGHB][CAM_MAX_SCANLINE+CAM_MM_NEIGHB-1];
+    CAM_PIXEL linesStack[CAM_MM_NEIGHB][CAM_MAX_SCANLINE+CAM_MM_NEIGHB-1];
+    CAM_PIXEL *linesBuffer;
+    int lineSize;
 
     DECLARE_MASK_MANAGEMENT;
 
@@ -249,12 +251,21 @@ int camDilateCircle7(CamImage *source, CamImage *dest)
     CAM_CHECK_ARGS(camMorphoMathsKernel,(width>CAM_MM_NEIGHB/2));
     CAM_CHECK_ARGS(camMorphoMathsKernel,(height>CAM_MM_NEIGHB/2));    
 	
+    // Line buffers (on the stack up to CAM_MAX_SCANLINE)
+    lineSize=source->width-left+CAM_MM_NEIGHB-1;
+    linesBuffer=(CAM_PIXEL*)camInternalScratchAlloc(linesStack,sizeof(linesStack),CAM_MM_NEIGHB*lineSize*sizeof(CAM_PIXEL));
+    if (linesBuffer==NULL) {
+        camInternalROIPolicyExit(&iROI);
+        camError("camMorphoMathsKernel","Memory allocation error");
+        return 0;
+    }
+
     // Mask management
     INIT_MASK_MANAGEMENT;
 
     // Initialize algorithm
     for (i=0;i<CAM_MM_NEIGHB;i++) {
-	linesPtr[i]=linesBuffer[i];
+	linesPtr[i]=(unsigned CAM_PIXEL*)linesBuffer+i*lineSize;
     }
     
     // Initialize neighbourhood
@@ -458,6 +469,7 @@ int camDilateCircle7(CamImage *source, CamImage *dest)
 				points->nbPoints++;
 				acc += valdil[0];
 			    } else {
+				camInternalScratchFree(linesStack,linesBuffer);
 				camInternalROIPolicyExit(&iROI);
 				return 0;
 			    }
@@ -550,6 +562,7 @@ int camDilateCircle7(CamImage *source, CamImage *dest)
 				points->nbPoints++;
 				acc += valdil[0];
 			    } else {
+				camInternalScratchFree(linesStack,linesBuffer);
 				camInternalROIPolicyExit(&iROI);
 				return 0;
 			    }
@@ -586,6 +599,7 @@ int camDilateCircle7(CamImage *source, CamImage *dest)
 	linesPtr[CAM_MM_NEIGHB-1]=tmpptr;
     }
 
+    camInternalScratchFree(linesStack,linesBuffer);
     camInternalROIPolicyExit(&iROI);
     return acc;
 }
@@ -0,0 +1,545 @@
+/***************************************
+ *
+ *  Camellia Image Processing Library
+ *
+
+    The Camellia Image Processing Library is an open source low-level image processing library.
+    As it uses the IplImage structure to describe images, it is a good replacement to the IPL (Intel) library
+    and a good complement to the OpenCV library. It includes a lot of functions for image processing
+    (filtering, morphological mathematics, labeling, warping, loading/saving images, etc.),
+    some of them being highly optimized; It is also cross-platform and robust. It is doxygen-documented
+    and examples of use are provided.
+
+    This software library is an outcome of the Camellia european project (IST-2001-34410).
+    It was developped by the Ecole des Mines de Paris (ENSMP), in coordination with
+    the other partners of the project.
+
+  ==========================================================================
+
+    Copyright (c) 2002-2006, Ecole des Mines de Paris - Centre de Robotique
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer
+          in the documentation and/or other materials provided with the distribution.
+        * Neither the name of the Ecole des Mines de Paris nor the names of
+          its contributors may be used to endorse or promote products
+          derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+    EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+    PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+    PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+    LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  ==========================================================================
+*/
+
+/* Rectangle Morphology Kernel
+ * C code */
+
+#include <stdlib.h>
+#include <string.h>
+#include "camellia.h"
+#include "camellia_internals.h"
+
+// Operations
+#define CAM_MM_RECT_EROSION     0
+#define CAM_MM_RECT_DILATION    1
+#define CAM_MM_RECT_GRADIENT    2
+#define CAM_MM_RECT_OPENING     3
+#define CAM_MM_RECT_CLOSING     4
+#define CAM_MM_RECT_TOPHAT      5
+#define CAM_MM_RECT_BLACKTOPHAT 6
+#define CAM_MM_RECT_ASF_OC      7
+#define CAM_MM_RECT_ASF_CO      8
+
+// Passes
+#define CAM_MM_RECT_ERODE       1
+#define CAM_MM_RECT_DILATE      2
+
+typedef struct {
+    int width,height;   // Size of the structuring element (order of the alternating sequential filters)
+    int operation;
+} CamMorphoRectParams;
+
+// 8 and 16 bits pixel size code generation
+
+#undef CAM_PIXEL
+#define CAM_PIXEL unsigned char
+#define camMorphoRect camMorphoRect8
+#define camMorphoRectLine camMorphoRectLine8
+#define camMorphoRectRows camMorphoRectRows8
+#define CamMorphoRectStage CamMorphoRectStage8
+#define _CamMorphoRectStage _CamMorphoRectStage8
+#define camMorphoRectStageInit camMorphoRectStageInit8
+#define camMorphoRectStageFree camMorphoRectStageFree8
+#define camMorphoRectFetch camMorphoRectFetch8
+#define camMorphoRectStageRow camMorphoRectStageRow8
+#include "cam_morphomaths_rect_code.c"
+#undef CAM_PIXEL
+#undef camMorphoRect
+#undef camMorphoRectLine
+#undef camMorphoRectRows
+#undef CamMorphoRectStage
+#undef _CamMorphoRectStage
+#undef camMorphoRectStageInit
+#undef camMorphoRectStageFree
+#undef camMorphoRectFetch
+#undef camMorphoRectStageRow
+
+#define CAM_PIXEL unsigned short
+#define camMorphoRect camMorphoRect16
+#define camMorphoRectLine camMorphoRectLine16
+#define camMorphoRectRows camMorphoRectRows16
+#define CamMorphoRectStage CamMorphoRectStage16
+#define _CamMorphoRectStage _CamMorphoRectStage16
+#define camMorphoRectStageInit camMorphoRectStageInit16
+#define camMorphoRectStageFree camMorphoRectStageFree16
+#define camMorphoRectFetch camMorphoRectFetch16
+#define camMorphoRectStageRow camMorphoRectStageRow16
+#include "cam_morphomaths_rect_code.c"
+#undef CAM_PIXEL
+#undef camMorphoRect
+#undef camMorphoRectLine
+#undef camMorphoRectRows
+#undef CamMorphoRectStage
+#undef _CamMorphoRectStage
+#undef camMorphoRectStageInit
+#undef camMorphoRectStageFree
+#undef camMorphoRectFetch
+#undef camMorphoRectStageRow
+
+// Binary images (CAM_DEPTH_1U) : the same pipeline of passes, on lines of bit blocks.
+// Pixel x of a line is the bit CAM_BIT_BLOCK_SIZE-1-(x%CAM_BIT_BLOCK_SIZE) of the block x/CAM_BIT_BLOCK_SIZE (same order as in the image).
+// The horizontal erosion (resp. dilation) by k pixels is a sequence of shifts and ANDs (resp. ORs) of whole blocks,
+// doubling the width of the structuring element at each step. The vertical pass is the van Herk/Gil-Werman algorithm on blocks.
+typedef struct _CamMorphoRect1UStage {
+    // Input
+    CamImage *frame;        // Image giving the frame size and the border settings
+    unsigned char *ptr;     // Pointer to the image data
+    struct _CamMorphoRect1UStage *prev; // Previous pass (NULL if the input is the image)
+    int prevY;              // Next output line of the previous pass (frame coordinates)
+    // Output
+    int ox,oy,ow,oh;        // Output rectangle (frame coordinates)
+    int sew,seh,ax,ay;      // Structuring element and its anchor
+    int ops;                // CAM_MM_RECT_ERODE | CAM_MM_RECT_DILATE
+    int nw,nwl;             // Number of blocks of an output line, and of an input line
+    CAM_BIT_BLOCK *out[2];  // Last output line of the erosion and of the dilation
+    // Line buffers
+    int p,i,b;
+    CAM_BIT_BLOCK *line,*tmp,*blocks[2][2],*prefix[2],*res[2];
+} CamMorphoRect1UStage;
+
+// Returns the CAM_BIT_BLOCK_SIZE pixels starting at pixel p of a line of nw blocks (0 out of the line)
+static CAM_BIT_BLOCK camMorphoRect1UGet(CAM_BIT_BLOCK *line, int p, int nw)
+{
+    int q,r;
+    CAM_BIT_BLOCK a,b;
+    if (p<0) {
+        if (p<=-(int)CAM_BIT_BLOCK_SIZE) return 0;
+        return camMorphoRect1UGet(line,0,nw)>>(-p);
+    }
+    q=p>>CAM_BIT_BLOCK_SIZE_SHIFT;
+    r=p&(CAM_BIT_BLOCK_SIZE-1);
+    a=(q<nw)?line[q]:0;
+    if (r==0) return a;
+    b=(q+1<nw)?line[q+1]:0;
+    return (a<<r)|(b>>(CAM_BIT_BLOCK_SIZE-r));
+}
+
+// Same, from an image line (nbytes bytes)
+static CAM_BIT_BLOCK camMorphoRect1ULoad(unsigned char *ptr, int p, int nbytes)
+{
+    int i,b=p>>3,r=p&7;
+    CAM_BIT_BLOCK v=0;
+    if (b+(int)sizeof(CAM_BIT_BLOCK)<nbytes) {
+        memcpy(&v,ptr+b,sizeof(CAM_BIT_BLOCK));
+        v=CAM_BIT_BLOCK_SWAP(v);
+        if (r) v=(v<<r)|(ptr[b+sizeof(CAM_BIT_BLOCK)]>>(8-r));
+        return v;
+    }
+    // End of the line
+    for (i=0;i<(int)sizeof(CAM_BIT_BLOCK);i++) {
+        v=(v<<8)|((b+i<nbytes)?ptr[b+i]:0);
+    }
+    if ((r)&&(b+(int)sizeof(CAM_BIT_BLOCK)<nbytes)) v=(v<<r)|(ptr[b+sizeof(CAM_BIT_BLOCK)]>>(8-r));
+    else v<<=r;
+    return v;
+}
+
+static int camMorphoRect1UCount(CAM_BIT_BLOCK v)
+{
+    int n;
+    for (n=0;v;n++) v&=v-1;
+    return n;
+}
+
+// dst[x] is the AND (erosion) or OR (dilation) of src[x..x+k-1]. src is a line of nwl blocks, and is overwritten.
+static void camMorphoRect1ULine(CAM_BIT_BLOCK *src, CAM_BIT_BLOCK *dst, int nw, int nwl, int k, int dilation)
+{
+    int i,c;
+    for (c=1;2*c<=k;c*=2) {
+        // src[x] becomes the AND/OR of 2*c pixels
+        if (dilation) {
+            for (i=0;i<nwl;i++) src[i]|=camMorphoRect1UGet(src,(i<<CAM_BIT_BLOCK_SIZE_SHIFT)+c,nwl);
+        } else {
+            for (i=0;i<nwl;i++) src[i]&=camMorphoRect1UGet(src,(i<<CAM_BIT_BLOCK_SIZE_SHIFT)+c,nwl);
+        }
+    }
+    if (c==k) {
+        memcpy(dst,src,nw*sizeof(CAM_BIT_BLOCK));
+    } else if (dilation) {
+        // Two overlapping windows of c pixels
+        for (i=0;i<nw;i++) dst[i]=src[i]|camMorphoRect1UGet(src,(i<<CAM_BIT_BLOCK_SIZE_SHIFT)+k-c,nwl);
+    } else {
+        for (i=0;i<nw;i++) dst[i]=src[i]&camMorphoRect1UGet(src,(i<<CAM_BIT_BLOCK_SIZE_SHIFT)+k-c,nwl);
+    }
+}
+
+static void camMorphoRect1URows(CAM_BIT_BLOCK *dst, CAM_BIT_BLOCK *a, CAM_BIT_BLOCK *b, int nw, int dilation)
+{
+    int i;
+    if (dilation) {
+        for (i=0;i<nw;i++) dst[i]=a[i]|b[i];
+    } else {
+        for (i=0;i<nw;i++) dst[i]=a[i]&b[i];
+    }
+}
+
+static int camMorphoRect1UStageInit(CamMorphoRect1UStage *s, int ox, int oy, int ow, int oh, int sew, int seh, int ax, int ay, int ops)
+{
+    int o,size;
+
+    s->ox=ox; s->oy=oy; s->ow=ow; s->oh=oh;
+    s->sew=sew; s->seh=seh; s->ax=ax; s->ay=ay;
+    s->ops=ops;
+    s->prev=NULL;
+    s->p=0; s->i=0; s->b=0;
+    s->nw=(ow+CAM_BIT_BLOCK_SIZE-1)>>CAM_BIT_BLOCK_SIZE_SHIFT;
+    s->nwl=(ow+sew-1+CAM_BIT_BLOCK_SIZE-1)>>CAM_BIT_BLOCK_SIZE_SHIFT;
+    size=2*s->nwl+2*(2*seh+2)*s->nw;
+    s->line=(CAM_BIT_BLOCK*)malloc(size*sizeof(CAM_BIT_BLOCK));
+    if (s->line==NULL) return 0;
+    s->tmp=s->line+s->nwl;
+    for (o=0;o<2;o++) {
+        s->blocks[o][0]=s->tmp+s->nwl+o*(2*seh+2)*s->nw;
+        s->blocks[o][1]=s->blocks[o][0]+seh*s->nw;
+        s->prefix[o]=s->blocks[o][1]+seh*s->nw;
+        s->res[o]=s->prefix[o]+s->nw;
+    }
+    return 1;
+}
+
+static void camMorphoRect1UStageRow(CamMorphoRect1UStage *s);
+
+// Fills the line buffer with the input line y (frame coordinates), which may be out of frame
+static void camMorphoRect1UFetch(CamMorphoRect1UStage *s, int y)
+{
+    int i,j,p,c,side,nbytes=0,offset=0;
+    CAM_BIT_BLOCK v,left,right,*src=NULL;
+    unsigned char *ptr=NULL;
+    CamImage *frame=s->frame;
+
+    if ((y<0)||(y>=frame->height)) {
+        side=(y<0)?CAM_SIDE_TOP_INDEX:CAM_SIDE_BOTTOM_INDEX;
+        if (frame->borderMode[side]!=CAM_BORDER_REPLICATE) {
+            v=(frame->borderConst[side])?~(CAM_BIT_BLOCK)0:0;
+            for (i=0;i<s->nwl;i++) s->line[i]=v;
+            return;
+        }
+        y=(y<0)?0:frame->height-1;
+    }
+#define CAM_MM_RECT_1U_PIXEL(x) ((src)?(camMorphoRect1UGet(src,(x)-offset,s->prev->nw)>>(CAM_BIT_BLOCK_SIZE-1)):((ptr[(x)>>3]>>(7-((x)&7)))&1))
+    if (s->prev) {
+        while (s->prevY<=y) {
+            camMorphoRect1UStageRow(s->prev);
+            s->prevY++;
+        }
+        src=s->prev->out[s->prev->ops>>1];
+        offset=s->prev->ox;
+    } else {
+        ptr=s->ptr+y*frame->widthStep;
+        nbytes=(frame->width+7)>>3;
+    }
+    // Border colors
+    if (frame->borderMode[CAM_SIDE_LEFT_INDEX]==CAM_BORDER_REPLICATE) {
+        left=CAM_MM_RECT_1U_PIXEL(0);
+    } else left=(frame->borderConst[CAM_SIDE_LEFT_INDEX])?1:0;
+    if (frame->borderMode[CAM_SIDE_RIGHT_INDEX]==CAM_BORDER_REPLICATE) {
+        right=CAM_MM_RECT_1U_PIXEL(frame->width-1);
+    } else right=(frame->borderConst[CAM_SIDE_RIGHT_INDEX])?1:0;
+    left=-left; right=-right; // All ones or all zeros
+
+    c=s->ox-s->ax;
+    for (i=0;i<s->nwl;i++) {
+        p=c+(i<<CAM_BIT_BLOCK_SIZE_SHIFT);
+        if ((p>=0)&&(p+(int)CAM_BIT_BLOCK_SIZE<=frame->width)) {
+            // Within the frame
+            s->line[i]=(src)?camMorphoRect1UGet(src,p-offset,s->prev->nw):camMorphoRect1ULoad(ptr,p,nbytes);
+        } else if (p+(int)CAM_BIT_BLOCK_SIZE<=0) {
+            s->line[i]=left;
+        } else if (p>=frame->width) {
+            s->line[i]=right;
+        } else {
+            // Crossing the frame border
+            for (v=0,j=0;j<(int)CAM_BIT_BLOCK_SIZE;j++) {
+                v=(v<<1)|((p+j<0)?(left&1):(p+j>=frame->width)?(right&1):CAM_MM_RECT_1U_PIXEL(p+j));
+            }
+            s->line[i]=v;
+        }
+    }
+#undef CAM_MM_RECT_1U_PIXEL
+}
+
+static void camMorphoRect1UStageRow(CamMorphoRect1UStage *s)
+{
+    int o,r,nw=s->nw;
+    CAM_BIT_BLOCK *h,*block;
+
+    do {
+        camMorphoRect1UFetch(s,s->oy-s->ay+s->p);
+        for (o=0;o<2;o++) {
+            if (!(s->ops&(1<<o))) continue;
+            block=s->blocks[o][s->b];
+            h=block+s->i*nw;
+            // Horizontal pass
+            memcpy(s->tmp,s->line,s->nwl*sizeof(CAM_BIT_BLOCK));
+            camMorphoRect1ULine(s->tmp,h,nw,s->nwl,s->sew,o);
+            // Vertical pass
+            if (s->i==0) {
+                memcpy(s->prefix[o],h,nw*sizeof(CAM_BIT_BLOCK));
+            } else {
+                camMorphoRect1URows(s->prefix[o],s->prefix[o],h,nw,o);
+            }
+            if (s->i==s->seh-1) {
+                for (r=s->seh-2;r>=0;r--) {
+                    camMorphoRect1URows(block+r*nw,block+r*nw,block+(r+1)*nw,nw,o);
+                }
+                s->out[o]=block;
+            } else if (s->p>=s->seh-1) {
+                camMorphoRect1URows(s->res[o],s->blocks[o][s->b^1]+(s->i+1)*nw,s->prefix[o],nw,o);
+                s->out[o]=s->res[o];
+            }
+        }
+        s->p++;
+        if (++s->i==s->seh) {
+            s->i=0;
+            s->b^=1;
+        }
+    } while (s->p<s->seh);
+}
+
+static int camMorphoRect1U(CamImage *source, CamImage *dest, CamMorphoRectParams *params)
+{
+    int i,k,x,y,np,nw,nbytes,width,height,left,top,dx,acc=0;
+    int ex0,ey0,ex1,ey1,rx0,ry0,rx1,ry1;
+    CAM_BIT_BLOCK v,m,*res,*res2,*srcline;
+    unsigned char *dstptr;
+    CamMorphoRect1UStage *stages,*last;
+    static const int asfOps[2][4]={
+        {CAM_MM_RECT_ERODE,CAM_MM_RECT_DILATE,CAM_MM_RECT_DILATE,CAM_MM_RECT_ERODE},
+        {CAM_MM_RECT_DILATE,CAM_MM_RECT_ERODE,CAM_MM_RECT_ERODE,CAM_MM_RECT_DILATE}};
+    CamInternalROIPolicyStruct iROI;
+
+    // ROI (Region Of Interest) management. Masks are not supported on binary images
+    CAM_CHECK(camMorphoRect,camInternalROIPolicy(source, dest, &iROI, 0));
+    CAM_CHECK_ARGS(camMorphoRect,dest->depth==CAM_DEPTH_1U);
+    CAM_CHECK_ARGS(camMorphoRect,iROI.nChannels==1);
+    CAM_CHECK_ARGS(camMorphoRect,(params->width>=1)&&(params->height>=1));
+
+    width=iROI.srcroi.width;
+    height=iROI.srcroi.height;
+    left=iROI.srcroi.xOffset;
+    top=iROI.srcroi.yOffset;
+
+    switch (params->operation) {
+    case CAM_MM_RECT_EROSION:
+    case CAM_MM_RECT_DILATION:
+    case CAM_MM_RECT_GRADIENT: np=1; break;
+    case CAM_MM_RECT_ASF_OC:
+    case CAM_MM_RECT_ASF_CO: np=4*params->width; break;
+    default: np=2; break;
+    }
+    stages=(CamMorphoRect1UStage*)malloc(np*sizeof(CamMorphoRect1UStage)+((width+CAM_BIT_BLOCK_SIZE-1)>>CAM_BIT_BLOCK_SIZE_SHIFT)*sizeof(CAM_BIT_BLOCK));
+    if (stages==NULL) {
+        camInternalROIPolicyExit(&iROI);
+        camError("camMorphoRect","Memory allocation error");
+        return 0;
+    }
+    srcline=(CAM_BIT_BLOCK*)(stages+np);
+    for (i=0;i<np;i++) {
+        stages[i].line=NULL;
+        stages[i].sew=params->width; stages[i].seh=params->height;
+        stages[i].ax=params->width/2; stages[i].ay=params->height/2;
+    }
+    switch (params->operation) {
+    case CAM_MM_RECT_EROSION: stages[0].ops=CAM_MM_RECT_ERODE; break;
+    case CAM_MM_RECT_DILATION: stages[0].ops=CAM_MM_RECT_DILATE; break;
+    case CAM_MM_RECT_GRADIENT: stages[0].ops=CAM_MM_RECT_ERODE|CAM_MM_RECT_DILATE; break;
+    case CAM_MM_RECT_OPENING:
+    case CAM_MM_RECT_TOPHAT: stages[0].ops=CAM_MM_RECT_ERODE; stages[1].ops=CAM_MM_RECT_DILATE; break;
+    case CAM_MM_RECT_CLOSING:
+    case CAM_MM_RECT_BLACKTOPHAT: stages[0].ops=CAM_MM_RECT_DILATE; stages[1].ops=CAM_MM_RECT_ERODE; break;
+    default:
+        for (k=0;k<params->width;k++) {
+            for (i=4*k;i<4*k+4;i++) {
+                stages[i].sew=stages[i].seh=2*k+3;
+                stages[i].ax=stages[i].ay=k+1;
+                stages[i].ops=asfOps[params->operation==CAM_MM_RECT_ASF_CO][i&3];
+            }
+        }
+        break;
+    }
+    if ((np==2)||(params->operation>=CAM_MM_RECT_ASF_OC)) {
+        for (i=1;i<np;i+=2) {
+            stages[i].ax=stages[i].sew-1-stages[i].ax;
+            stages[i].ay=stages[i].seh-1-stages[i].ay;
+        }
+    }
+
+    rx0=left; ry0=top; rx1=left+width; ry1=top+height;
+    for (i=np-1;i>=0;i--) {
+        if (!camMorphoRect1UStageInit(&stages[i],rx0,ry0,rx1-rx0,ry1-ry0,stages[i].sew,stages[i].seh,stages[i].ax,stages[i].ay,stages[i].ops)) {
+            for (i++;i<np;i++) free(stages[i].line);
+            free(stages);
+            camInternalROIPolicyExit(&iROI);
+            camError("camMorphoRect","Memory allocation error");
+            return 0;
+        }
+        stages[i].frame=source;
+        stages[i].ptr=(unsigned char*)source->imageData;
+        if (i) {
+            stages[i].prev=&stages[i-1];
+            ex0=rx0-stages[i].ax; if (ex0<0) ex0=0;
+            ey0=ry0-stages[i].ay; if (ey0<0) ey0=0;
+            ex1=rx1+stages[i].sew-1-stages[i].ax; if (ex1>source->width) ex1=source->width;
+            ey1=ry1+stages[i].seh-1-stages[i].ay; if (ey1>source->height) ey1=source->height;
+            rx0=ex0; ry0=ey0; rx1=ex1; ry1=ey1;
+            stages[i].prevY=ey0;
+        }
+    }
+    last=&stages[np-1];
+    nw=last->nw;
+    nbytes=(source->width+7)>>3;
+    dx=iROI.dstroi.xOffset;
+
+    // This is the main loop
+    for (y=0;y<height;y++) {
+        camMorphoRect1UStageRow(last);
+        res=last->out[last->ops>>1];
+        res2=last->out[0];
+        if ((params->operation==CAM_MM_RECT_TOPHAT)||(params->operation==CAM_MM_RECT_BLACKTOPHAT)) {
+            for (i=0;i<nw;i++) {
+                srcline[i]=camMorphoRect1ULoad((unsigned char*)source->imageData+(top+y)*source->widthStep,left+(i<<CAM_BIT_BLOCK_SIZE_SHIFT),nbytes);
+            }
+        }
+        for (i=0;i<nw;i++) {
+            switch (params->operation) {
+            case CAM_MM_RECT_GRADIENT: v=res[i]&~res2[i]; break;
+            case CAM_MM_RECT_TOPHAT: v=srcline[i]&~res[i]; break;
+            case CAM_MM_RECT_BLACKTOPHAT: v=res[i]&~srcline[i]; break;
+            default: v=res[i]; break;
+            }
+            if (i==nw-1) {
+                // Clear the pixels after the end of the line
+                v&=~(CAM_BIT_BLOCK)0<<((CAM_BIT_BLOCK_SIZE-(width&(CAM_BIT_BLOCK_SIZE-1)))&(CAM_BIT_BLOCK_SIZE-1));
+            }
+            acc+=camMorphoRect1UCount(v);
+            srcline[i]=v;
+        }
+        // Store the line in the destination image, byte by byte, keeping the pixels out of the ROI
+        dstptr=(unsigned char*)dest->imageData+(iROI.dstroi.yOffset+y)*dest->widthStep;
+        x=dx>>3;
+        if ((dx&7)==0) {
+            // Aligned on a byte : whole blocks
+            for (i=0;(i+1)<<CAM_BIT_BLOCK_SIZE_SHIFT<=width;i++,x+=sizeof(CAM_BIT_BLOCK)) {
+                v=CAM_BIT_BLOCK_SWAP(srcline[i]);
+                memcpy(dstptr+x,&v,sizeof(CAM_BIT_BLOCK));
+            }
+        }
+        for (;x<=(dx+width-1)>>3;x++) {
+            m=0xff;
+            if (x==(dx>>3)) m&=0xff>>(dx&7);
+            if (x==((dx+width-1)>>3)) m&=0xff<<(7-((dx+width-1)&7));
+            v=camMorphoRect1UGet(srcline,(x<<3)-dx,nw)>>(CAM_BIT_BLOCK_SIZE-8);
+            dstptr[x]=(unsigned char)((dstptr[x]&~m)|(v&m));
+        }
+    }
+
+    for (i=0;i<np;i++) free(stages[i].line);
+    free(stages);
+    camInternalROIPolicyExit(&iROI);
+    return acc;
+}
+
+static int camMorphoRectBand(CamImage *source, CamImage *dest, void *params)
+{
+    if (source->depth==CAM_DEPTH_1U) {
+        return camMorphoRect1U(source,dest,(CamMorphoRectParams*)params);
+    } else if ((source->depth&CAM_DEPTH_MASK)>8) {
+        return camMorphoRect16(source,dest,(CamMorphoRectParams*)params);
+    } else {
+        return camMorphoRect8(source,dest,(CamMorphoRectParams*)params);
+    }
+}
+
+static int camMorphoRect(CamImage *source, CamImage *dest, int width, int height, int operation)
+{
+    CamMorphoRectParams params;
+    params.width=width;
+    params.height=height;
+    params.operation=operation;
+    return camInternalParallelBands(source,dest,&params,camMorphoRectBand,CAM_BANDS_SUM);
+}
+
+int camErodeRect(CamImage *source, CamImage *dest, int width, int height)
+{
+    return camMorphoRect(source,dest,width,height,CAM_MM_RECT_EROSION);
+}
+
+int camDilateRect(CamImage *source, CamImage *dest, int width, int height)
+{
+    return camMorphoRect(source,dest,width,height,CAM_MM_RECT_DILATION);
+}
+
+int camMorphoGradientRect(CamImage *source, CamImage *dest, int width, int height)
+{
+    return camMorphoRect(source,dest,width,height,CAM_MM_RECT_GRADIENT);
+}
+
+int camOpenRect(CamImage *source, CamImage *dest, int width, int height)
+{
+    return camMorphoRect(source,dest,width,height,CAM_MM_RECT_OPENING);
+}
+
+int camCloseRect(CamImage *source, CamImage *dest, int width, int height)
+{
+    return camMorphoRect(source,dest,width,height,CAM_MM_RECT_CLOSING);
+}
+
+int camTopHatRect(CamImage *source, CamImage *dest, int width, int height)
+{
+    return camMorphoRect(source,dest,width,height,CAM_MM_RECT_TOPHAT);
+}
+
+int camBlackTopHatRect(CamImage *source, CamImage *dest, int width, int height)
+{
+    return camMorphoRect(source,dest,width,height,CAM_MM_RECT_BLACKTOPHAT);
+}
+
+int camAlternatingSequentialFilterRect(CamImage *source, CamImage *dest, int order, int closingFirst)
+{
+    return camMorphoRect(source,dest,order,order,(closingFirst)?CAM_MM_RECT_ASF_CO:CAM_MM_RECT_ASF_OC);
+}
@@ -0,0 +1,389 @@
+/***************************************
+ *
+ *  Camellia Image Processing Library
+ *
+
+    The Camellia Image Processing Library is an open source low-level image processing library.
+    As it uses the IplImage structure to describe images, it is a good replacement to the IPL (Intel) library
+    and a good complement to the OpenCV library. It includes a lot of functions for image processing
+    (filtering, morphological mathematics, labeling, warping, loading/saving images, etc.),
+    some of them being highly optimized; It is also cross-platform and robust. It is doxygen-documented
+    and examples of use are provided.
+
+    This software library is an outcome of the Camellia european project (IST-2001-34410).
+    It was developped by the Ecole des Mines de Paris (ENSMP), in coordination with
+    the other partners of the project.
+
+  ==========================================================================
+
+    Copyright (c) 2002-2006, Ecole des Mines de Paris - Centre de Robotique
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer
+          in the documentation and/or other materials provided with the distribution.
+        * Neither the name of the Ecole des Mines de Paris nor the names of
+          its contributors may be used to endorse or promote products
+          derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+    EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+    PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+    PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+    LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  ==========================================================================
+*/
+
+/* Rectangle Morphology Kernel
+ * C code */
+
+// Running minimum (erosion) or maximum (dilation) along a line of width+k-1 pixels (van Herk/Gil-Werman algorithm)
+// dst[x] is the min/max of src[x..x+k-1]. It costs 3 comparisons per pixel, whatever the size k
+static void camMorphoRectLine(CAM_PIXEL *src, CAM_PIXEL *dst, CAM_PIXEL *tmp, int width, int k, int dilation)
+{
+    int x,b,e,c,n=width+k-1;
+    CAM_PIXEL g;
+
+    if (k==1) {
+        memcpy(dst,src,width*sizeof(CAM_PIXEL));
+        return;
+    }
+
+#define CAM_MM_RECT_LINE(OP) \
+    /* Suffixes within the blocks of k pixels */ \
+    for (b=0;b<n;b+=k) { \
+        e=b+k; if (e>n) e=n; \
+        tmp[e-1]=src[e-1]; \
+        for (x=e-2;x>=b;x--) tmp[x]=OP(src[x],tmp[x+1]); \
+    } \
+    /* Prefixes, combined with the suffixes of the previous block */ \
+    g=src[0]; \
+    for (x=1;x<k-1;x++) g=OP(g,src[x]); \
+    for (x=0,c=k-1;x<width;x++,c++) { \
+        if (c==k) { \
+            c=0; \
+            g=src[x+k-1]; \
+        } else g=OP(g,src[x+k-1]); \
+        dst[x]=OP(tmp[x],g); \
+    }
+
+    if (dilation) {
+        CAM_MM_RECT_LINE(CAM_MAX)
+    } else {
+        CAM_MM_RECT_LINE(CAM_MIN)
+    }
+}
+
+// dst=min(a,b) or max(a,b), pixel per pixel
+static void camMorphoRectRows(CAM_PIXEL *dst, CAM_PIXEL *a, CAM_PIXEL *b, int width, int dilation)
+{
+    int x;
+    if (dilation) {
+        for (x=0;x<width;x++) dst[x]=CAM_MAX(a[x],b[x]);
+    } else {
+        for (x=0;x<width;x++) dst[x]=CAM_MIN(a[x],b[x]);
+    }
+}
+
+// A pass of rectangle morphology (erosion and/or dilation), producing its output lines one by one.
+// The input is an image, or the previous pass of a pipeline, which is then run on demand, line by line :
+// no intermediate image is ever written. Signed pixels are processed with their sign bit flipped,
+// so that they are ordered as unsigned pixels.
+typedef struct _CamMorphoRectStage {
+    // Input
+    CamImage *frame;        // Image giving the frame size and the border settings
+    CAM_PIXEL *ptr;         // Pointer to the input pixel (x0,y0)
+    int x0,y0,step,inc;     // Position of ptr in the frame, line and pixel increments (in pixels)
+    int dataFlip,constFlip; // Flips the sign bit of the input pixels, and of the border constants
+    struct _CamMorphoRectStage *prev; // Previous pass (NULL if the input is the image)
+    int prevY;              // Next output line of the previous pass (frame coordinates)
+    // Output
+    int ox,oy,ow,oh;        // Output rectangle (frame coordinates)
+    int sew,seh,ax,ay;      // Structuring element and its anchor
+    int ops;                // CAM_MM_RECT_ERODE | CAM_MM_RECT_DILATE
+    CAM_PIXEL *out[2];      // Last output line of the erosion and of the dilation
+    // Line buffers
+    int p,i,b;              // Next input line (from oy-ay), position in its block of seh lines, block index
+    CAM_PIXEL *line,*tmp,*blocks[2][2],*prefix[2],*res[2];
+} CamMorphoRectStage;
+
+static int camMorphoRectStageInit(CamMorphoRectStage *s, int ox, int oy, int ow, int oh, int sew, int seh, int ax, int ay, int ops)
+{
+    int o,size;
+
+    s->ox=ox; s->oy=oy; s->ow=ow; s->oh=oh;
+    s->sew=sew; s->seh=seh; s->ax=ax; s->ay=ay;
+    s->ops=ops;
+    s->prev=NULL;
+    s->p=0; s->i=0; s->b=0;
+    size=2*(ow+sew-1)+2*(2*seh+2)*ow;
+    s->line=(CAM_PIXEL*)malloc(size*sizeof(CAM_PIXEL));
+    if (s->line==NULL) return 0;
+    s->tmp=s->line+ow+sew-1;
+    for (o=0;o<2;o++) {
+        s->blocks[o][0]=s->tmp+ow+sew-1+o*(2*seh+2)*ow;
+        s->blocks[o][1]=s->blocks[o][0]+seh*ow;
+        s->prefix[o]=s->blocks[o][1]+seh*ow;
+        s->res[o]=s->prefix[o]+ow;
+    }
+    return 1;
+}
+
+static void camMorphoRectStageFree(CamMorphoRectStage *s)
+{
+    free(s->line);
+}
+
+static void camMorphoRectStageRow(CamMorphoRectStage *s);
+
+// Fills the line buffer with the input line y (frame coordinates), which may be out of frame
+static void camMorphoRectFetch(CamMorphoRectStage *s, int y)
+{
+    int x,c,start,side,n=s->ow+s->sew-1;
+    CAM_PIXEL *src,v;
+    CamImage *frame=s->frame;
+
+    if ((y<0)||(y>=frame->height)) {
+        side=(y<0)?CAM_SIDE_TOP_INDEX:CAM_SIDE_BOTTOM_INDEX;
+        if (frame->borderMode[side]!=CAM_BORDER_REPLICATE) {
+            v=(CAM_PIXEL)(frame->borderConst[side]^s->constFlip);
+            for (x=0;x<n;x++) s->line[x]=v;
+            return;
+        }
+        y=(y<0)?0:frame->height-1;
+    }
+    if (s->prev) {
+        // Run the previous pass up to line y. Lines are fetched in increasing order, and the
+        // vertical pass keeps the lines it needs, so that only the last output line is used
+        while (s->prevY<=y) {
+            camMorphoRectStageRow(s->prev);
+            s->prevY++;
+        }
+        src=s->prev->out[s->prev->ops>>1]-s->prev->ox;
+    } else {
+        src=s->ptr+(y-s->y0)*s->step-s->x0*s->inc;
+    }
+    c=s->ox-s->ax;
+    for (x=0;(x<n)&&(c+x<0);x++) {
+        // Out of frame : fill with border color
+        if (frame->borderMode[CAM_SIDE_LEFT_INDEX]==CAM_BORDER_REPLICATE) {
+            s->line[x]=src[0]^s->dataFlip;
+        } else {
+            s->line[x]=(CAM_PIXEL)(frame->borderConst[CAM_SIDE_LEFT_INDEX]^s->constFlip);
+        }
+    }
+    if ((s->inc==1)&&(!s->dataFlip)) {
+        // Fast transfer with memcpy
+        for (start=x;(x<n)&&(c+x<frame->width);x++);
+        memcpy(s->line+start,src+c+start,(x-start)*sizeof(CAM_PIXEL));
+    } else {
+        for (;(x<n)&&(c+x<frame->width);x++) {
+            s->line[x]=src[(c+x)*s->inc]^s->dataFlip;
+        }
+    }
+    for (;x<n;x++) {
+        // Out of frame : fill with border color
+        if (frame->borderMode[CAM_SIDE_RIGHT_INDEX]==CAM_BORDER_REPLICATE) {
+            s->line[x]=src[(frame->width-1)*s->inc]^s->dataFlip;
+        } else {
+            s->line[x]=(CAM_PIXEL)(frame->borderConst[CAM_SIDE_RIGHT_INDEX]^s->constFlip);
+        }
+    }
+}
+
+// Computes the next output line of the pass (in s->out)
+// The vertical min/max is computed with the van Herk/Gil-Werman algorithm as well : the input lines
+// are gathered in blocks of seh lines. The suffixes of the previous block are combined with the prefix of the current one
+static void camMorphoRectStageRow(CamMorphoRectStage *s)
+{
+    int o,r,ow=s->ow;
+    CAM_PIXEL *h,*block;
+
+    do {
+        camMorphoRectFetch(s,s->oy-s->ay+s->p);
+        for (o=0;o<2;o++) {
+            if (!(s->ops&(1<<o))) continue;
+            block=s->blocks[o][s->b];
+            h=block+s->i*ow;
+            // Horizontal pass
+            camMorphoRectLine(s->line,h,s->tmp,ow,s->sew,o);
+            // Prefix of the current block
+            if (s->i==0) {
+                memcpy(s->prefix[o],h,ow*sizeof(CAM_PIXEL));
+            } else {
+                camMorphoRectRows(s->prefix[o],s->prefix[o],h,ow,o);
+            }
+            if (s->i==s->seh-1) {
+                // The block is complete : compute its suffixes
+                for (r=s->seh-2;r>=0;r--) {
+                    camMorphoRectRows(block+r*ow,block+r*ow,block+(r+1)*ow,ow,o);
+                }
+                // The output line is the first suffix of the block
+                s->out[o]=block;
+            } else if (s->p>=s->seh-1) {
+                camMorphoRectRows(s->res[o],s->blocks[o][s->b^1]+(s->i+1)*ow,s->prefix[o],ow,o);
+                s->out[o]=s->res[o];
+            }
+        }
+        s->p++;
+        if (++s->i==s->seh) {
+            s->i=0;
+            s->b^=1;
+        }
+    } while (s->p<s->seh);
+}
+
+int camMorphoRect(CamImage *source, CamImage *dest, CamMorphoRectParams *params)
+{
+    int x,y,width,height,left,top;
+    int i,k,np,v,acc=0,flip=0;
+    int ex0,ey0,ex1,ey1,rx0,ry0,rx1,ry1;
+    CAM_PIXEL *srcptr,*dstptr,*cpdstptr,*res,*res2;
+    CamMorphoRectStage *stages,*last;
+    static const int asfOps[2][4]={
+        {CAM_MM_RECT_ERODE,CAM_MM_RECT_DILATE,CAM_MM_RECT_DILATE,CAM_MM_RECT_ERODE},  // Opening, then closing
+        {CAM_MM_RECT_DILATE,CAM_MM_RECT_ERODE,CAM_MM_RECT_ERODE,CAM_MM_RECT_DILATE}}; // Closing, then opening
+    CamInternalROIPolicyStruct iROI;
+    DECLARE_MASK_MANAGEMENT;
+
+    // ROI (Region Of Interest) management
+    CAM_CHECK(camMorphoRect,camInternalROIPolicy(source, dest, &iROI, CAM_MASK_SUPPORT));
+    CAM_CHECK_ARGS(camMorphoRect,(source->depth&CAM_DEPTH_MASK)<=(sizeof(CAM_PIXEL)*8));
+    CAM_CHECK_ARGS(camMorphoRect,(source->depth&CAM_DEPTH_MASK)>=8);
+    CAM_CHECK_ARGS(camMorphoRect,(source->depth&CAM_DEPTH_MASK)==(dest->depth&CAM_DEPTH_MASK));
+    CAM_CHECK_ARGS(camMorphoRect,iROI.nChannels==1);
+    CAM_CHECK_ARGS(camMorphoRect,(params->width>=1)&&(params->height>=1));
+
+    width=iROI.srcroi.width;
+    height=iROI.srcroi.height;
+    left=iROI.srcroi.xOffset;
+    top=iROI.srcroi.yOffset;
+    if (source->depth&CAM_DEPTH_SIGN) flip=1<<((source->depth&CAM_DEPTH_MASK)-1);
+
+    // Build the pipeline of passes. Every pass following another one within an opening or a closing
+    // uses the reflected structuring element (this only matters for even sizes)
+    switch (params->operation) {
+    case CAM_MM_RECT_EROSION:
+    case CAM_MM_RECT_DILATION:
+    case CAM_MM_RECT_GRADIENT: np=1; break;
+    case CAM_MM_RECT_ASF_OC:
+    case CAM_MM_RECT_ASF_CO: np=4*params->width; break;
+    default: np=2; break;
+    }
+    stages=(CamMorphoRectStage*)malloc(np*sizeof(CamMorphoRectStage));
+    if (stages==NULL) {
+        camInternalROIPolicyExit(&iROI);
+        camError("camMorphoRect","Memory allocation error");
+        return 0;
+    }
+    for (i=0;i<np;i++) {
+        stages[i].line=NULL;
+        stages[i].sew=params->width; stages[i].seh=params->height;
+        stages[i].ax=params->width/2; stages[i].ay=params->height/2;
+    }
+    switch (params->operation) {
+    case CAM_MM_RECT_EROSION: stages[0].ops=CAM_MM_RECT_ERODE; break;
+    case CAM_MM_RECT_DILATION: stages[0].ops=CAM_MM_RECT_DILATE; break;
+    case CAM_MM_RECT_GRADIENT: stages[0].ops=CAM_MM_RECT_ERODE|CAM_MM_RECT_DILATE; break;
+    case CAM_MM_RECT_OPENING:
+    case CAM_MM_RECT_TOPHAT: stages[0].ops=CAM_MM_RECT_ERODE; stages[1].ops=CAM_MM_RECT_DILATE; break;
+    case CAM_MM_RECT_CLOSING:
+    case CAM_MM_RECT_BLACKTOPHAT: stages[0].ops=CAM_MM_RECT_DILATE; stages[1].ops=CAM_MM_RECT_ERODE; break;
+    default:
+        // Alternating sequential filter : openings and closings by squares of increasing size 3,5,...
+        for (k=0;k<params->width;k++) {
+            for (i=4*k;i<4*k+4;i++) {
+                stages[i].sew=stages[i].seh=2*k+3;
+                stages[i].ax=stages[i].ay=k+1;
+                stages[i].ops=asfOps[params->operation==CAM_MM_RECT_ASF_CO][i&3];
+            }
+        }
+        break;
+    }
+    if ((np==2)||(params->operation>=CAM_MM_RECT_ASF_OC)) {
+        for (i=1;i<np;i+=2) {
+            stages[i].ax=stages[i].sew-1-stages[i].ax;
+            stages[i].ay=stages[i].seh-1-stages[i].ay;
+        }
+    }
+
+    // Each pass is computed on the neighbourhood (within the frame) of the region needed by the next one.
+    // The first pass reads the image, and the next ones read the previous pass on demand
+    rx0=left; ry0=top; rx1=left+width; ry1=top+height;
+    for (i=np-1;i>=0;i--) {
+        if (!camMorphoRectStageInit(&stages[i],rx0,ry0,rx1-rx0,ry1-ry0,stages[i].sew,stages[i].seh,stages[i].ax,stages[i].ay,stages[i].ops)) {
+            for (i++;i<np;i++) camMorphoRectStageFree(&stages[i]);
+            free(stages);
+            camInternalROIPolicyExit(&iROI);
+            camError("camMorphoRect","Memory allocation error");
+            return 0;
+        }
+        stages[i].frame=source;
+        stages[i].constFlip=flip;
+        if (i==0) {
+            stages[i].ptr=(CAM_PIXEL*)(source->imageData+iROI.srcchoffset);
+            stages[i].x0=0; stages[i].y0=0;
+            stages[i].step=source->widthStep/sizeof(CAM_PIXEL);
+            stages[i].inc=iROI.srcinc;
+            stages[i].dataFlip=flip;
+        } else {
+            stages[i].prev=&stages[i-1];
+            stages[i].inc=1;
+            stages[i].dataFlip=0;
+            ex0=rx0-stages[i].ax; if (ex0<0) ex0=0;
+            ey0=ry0-stages[i].ay; if (ey0<0) ey0=0;
+            ex1=rx1+stages[i].sew-1-stages[i].ax; if (ex1>source->width) ex1=source->width;
+            ey1=ry1+stages[i].seh-1-stages[i].ay; if (ey1>source->height) ey1=source->height;
+            rx0=ex0; ry0=ey0; rx1=ex1; ry1=ey1;
+            stages[i].prevY=ey0;
+        }
+    }
+    last=&stages[np-1];
+
+    // Mask management
+    INIT_MASK_MANAGEMENT;
+
+    // Now process the whole image
+    // This is the main loop
+    srcptr=(CAM_PIXEL*)(source->imageData+iROI.srcchoffset+top*source->widthStep)+left*iROI.srcinc;
+    dstptr=(CAM_PIXEL*)iROI.dstptr;
+    for (y=0;y<height;y++) {
+        cpdstptr=dstptr;
+        camMorphoRectStageRow(last);
+        res=last->out[last->ops>>1];
+        res2=last->out[0];
+        BEGIN_MASK_MANAGEMENT(dstptr=cpdstptr+startx*iROI.dstinc;)
+            for (x=startx;x<endx;x++) {
+                switch (params->operation) {
+                case CAM_MM_RECT_GRADIENT: v=res[x]-res2[x]; break;
+                // With a constant border, the opening (resp. closing) may go above (resp. below) the source : clamp at 0
+                case CAM_MM_RECT_TOPHAT: v=(srcptr[x*iROI.srcinc]^flip)-res[x]; if (v<0) v=0; break;
+                case CAM_MM_RECT_BLACKTOPHAT: v=res[x]-(srcptr[x*iROI.srcinc]^flip); if (v<0) v=0; break;
+                default: v=res[x]-flip; break; // Back to the signed value
+                }
+                *dstptr=(CAM_PIXEL)v;
+                acc+=v;
+                dstptr+=iROI.dstinc;
+            }
+        END_MASK_MANAGEMENT;
+        srcptr=(CAM_PIXEL*)(((char*)srcptr)+source->widthStep);
+        dstptr=(CAM_PIXEL*)(((char*)cpdstptr)+dest->widthStep);
+    }
+
+    for (i=0;i<np;i++) camMorphoRectStageFree(&stages[i]);
+    free(stages);
+    camInternalROIPolicyExit(&iROI);
+    return acc;
+}
@@ -0,0 +1,392 @@
+/***************************************
+ *
+ *  Camellia Image Processing Library
+ *
+
+    The Camellia Image Processing Library is an open source low-level image processing library.
+    As it uses the IplImage structure to describe images, it is a good replacement to the IPL (Intel) library
+    and a good complement to the OpenCV library. It includes a lot of functions for image processing
+    (filtering, morphological mathematics, labeling, warping, loading/saving images, etc.),
+    some of them being highly optimized; It is also cross-platform and robust. It is doxygen-documented
+    and examples of use are provided.
+
+    This software library is an outcome of the Camellia european project (IST-2001-34410).
+    It was developped by the Ecole des Mines de Paris (ENSMP), in coordination with
+    the other partners of the project.
+
+  ==========================================================================
+
+    Copyright (c) 2002-2006, Ecole des Mines de Paris - Centre de Robotique
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer
+          in the documentation and/or other materials provided with the distribution.
+        * Neither the name of the Ecole des Mines de Paris nor the names of
+          its contributors may be used to endorse or promote products
+          derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+    EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+    PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+    PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+    LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  ==========================================================================
+*/
+
+/* Parallel execution of kernels
+ * C code */
+
+#include <stdlib.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include "camellia.h"
+#include "camellia_internals.h"
+
+// The number of threads can be changed by any application thread while others run kernels :
+// it is read atomically, once per job
+#ifdef _WIN32
+static volatile LONG camNbThreads=1;
+#define CAM_NB_THREADS_STORE(n) InterlockedExchange(&camNbThreads,(n))
+#define CAM_NB_THREADS_LOAD() ((int)InterlockedCompareExchange(&camNbThreads,0,0))
+#else
+static int camNbThreads=1;
+#define CAM_NB_THREADS_STORE(n) __atomic_store_n(&camNbThreads,(n),__ATOMIC_RELAXED)
+#define CAM_NB_THREADS_LOAD() __atomic_load_n(&camNbThreads,__ATOMIC_RELAXED)
+#endif
+
+int camSetNumThreads(int nbThreads)
+{
+    if (nbThreads<1) nbThreads=1;
+    if (nbThreads>CAM_MAX_THREADS) nbThreads=CAM_MAX_THREADS;
+    CAM_NB_THREADS_STORE(nbThreads);
+    return nbThreads;
+}
+
+int camGetNumThreads()
+{
+    return CAM_NB_THREADS_LOAD();
+}
+
+void camInternalOnce(CamInternalOnce *once, void (*init)(void))
+{
+#ifdef _WIN32
+    // 0 : not initialized, 1 : initialization in progress, 2 : initialized
+    if (*once!=2) {
+        if (InterlockedCompareExchange(once,1,0)==0) {
+            init();
+            InterlockedExchange(once,2);
+        }
+        while (*once!=2) Sleep(0);
+    }
+#else
+    pthread_once(once,init);
+#endif
+}
+
+/* Worker pool
+ * The pool is shared by all the parallelized kernels. Only one job runs at a time on the pool :
+ * a job submitted while the pool is busy (by another application thread, or from inside a task)
+ * is run serially by the calling thread, so that the cores are never oversubscribed.
+ */
+typedef struct {
+    camInternalTask task;
+    void *arg;
+    int nbTasks;
+    int next;       // Index of the next task to run
+    int remaining;  // Number of tasks not completed yet
+} CamParallelJob;
+
+static CamParallelJob camPoolJob;
+static int camPoolBusy=0;
+static int camPoolNbWorkers=0; // Number of started worker threads
+static int camPoolNbActive=0;  // Number of worker threads allowed to take part in the current job
+
+#ifdef _WIN32
+static CRITICAL_SECTION camPoolMutex;
+static HANDLE camPoolWork=NULL; // Semaphore, released once per active worker for each job
+static HANDLE camPoolDone=NULL; // Auto-reset event, set when the last task of a job is completed
+static LONG camPoolInit=0;
+#define CAM_POOL_LOCK() EnterCriticalSection(&camPoolMutex)
+#define CAM_POOL_UNLOCK() LeaveCriticalSection(&camPoolMutex)
+#else
+static pthread_mutex_t camPoolMutex=PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t camPoolWork=PTHREAD_COND_INITIALIZER;
+static pthread_cond_t camPoolDone=PTHREAD_COND_INITIALIZER;
+static int camPoolGeneration=0;
+#define CAM_POOL_LOCK() pthread_mutex_lock(&camPoolMutex)
+#define CAM_POOL_UNLOCK() pthread_mutex_unlock(&camPoolMutex)
+#endif
+
+// Run the tasks of the current job until there is none left. Called with the pool lock held.
+static void camPoolRunTasks()
+{
+    int i;
+    while (camPoolJob.next<camPoolJob.nbTasks) {
+        i=camPoolJob.next++;
+        CAM_POOL_UNLOCK();
+        camPoolJob.task(camPoolJob.arg,i);
+        CAM_POOL_LOCK();
+        if (--camPoolJob.remaining==0) {
+#ifdef _WIN32
+            SetEvent(camPoolDone);
+#else
+            pthread_cond_signal(&camPoolDone);
+#endif
+        }
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI camPoolWorker(LPVOID p)
+{
+    int id=(int)(size_t)p;
+    for (;;) {
+        WaitForSingleObject(camPoolWork,INFINITE);
+        CAM_POOL_LOCK();
+        if ((camPoolBusy)&&(id<camPoolNbActive)) camPoolRunTasks();
+        CAM_POOL_UNLOCK();
+    }
+    return 0;
+}
+#else
+static void *camPoolWorker(void *p)
+{
+    int id=(int)(size_t)p;
+    int generation;
+    CAM_POOL_LOCK();
+    generation=camPoolGeneration;
+    for (;;) {
+        while (camPoolGeneration==generation) pthread_cond_wait(&camPoolWork,&camPoolMutex);
+        generation=camPoolGeneration;
+        if (id<camPoolNbActive) camPoolRunTasks();
+    }
+    CAM_POOL_UNLOCK();
+    return NULL;
+}
+#endif
+
+// Start worker threads until there are nbWorkers of them. Called with the pool lock held.
+static void camPoolStartWorkers(int nbWorkers)
+{
+#ifdef _WIN32
+    HANDLE thread;
+    while (camPoolNbWorkers<nbWorkers) {
+        thread=CreateThread(NULL,0,camPoolWorker,(LPVOID)(size_t)camPoolNbWorkers,0,NULL);
+        if (thread==NULL) break;
+        CloseHandle(thread);
+        camPoolNbWorkers++;
+    }
+#else
+    pthread_t thread;
+    while (camPoolNbWorkers<nbWorkers) {
+        if (pthread_create(&thread,NULL,camPoolWorker,(void*)(size_t)camPoolNbWorkers)!=0) break;
+        pthread_detach(thread);
+        camPoolNbWorkers++;
+    }
+#endif
+}
+
+int camInternalParallelRun(camInternalTask task, void *arg, int nbTasks)
+{
+    int i,nbThreads=camGetNumThreads();
+
+    if ((nbThreads>1)&&(nbTasks>1)) {
+#ifdef _WIN32
+        if (InterlockedCompareExchange(&camPoolInit,1,0)==0) {
+            InitializeCriticalSection(&camPoolMutex);
+            camPoolWork=CreateSemaphore(NULL,0,CAM_MAX_THREADS,NULL);
+            camPoolDone=CreateEvent(NULL,FALSE,FALSE,NULL);
+            camPoolInit=2;
+        }
+        while (camPoolInit!=2) Sleep(0);
+#endif
+        CAM_POOL_LOCK();
+        if (!camPoolBusy) {
+            camPoolBusy=1;
+            camPoolStartWorkers(nbThreads-1);
+            camPoolJob.task=task;
+            camPoolJob.arg=arg;
+            camPoolJob.nbTasks=nbTasks;
+            camPoolJob.next=0;
+            camPoolJob.remaining=nbTasks;
+            camPoolNbActive=nbThreads-1;
+            if (camPoolNbActive>nbTasks-1) camPoolNbActive=nbTasks-1;
+#ifdef _WIN32
+            ResetEvent(camPoolDone);
+            ReleaseSemaphore(camPoolWork,camPoolNbActive,NULL);
+#else
+            camPoolGeneration++;
+            pthread_cond_broadcast(&camPoolWork);
+#endif
+            // The calling thread takes part in the job
+            camPoolRunTasks();
+            while (camPoolJob.remaining) {
+#ifdef _WIN32
+                CAM_POOL_UNLOCK();
+                WaitForSingleObject(camPoolDone,INFINITE);
+                CAM_POOL_LOCK();
+#else
+                pthread_cond_wait(&camPoolDone,&camPoolMutex);
+#endif
+            }
+            camPoolBusy=0;
+            CAM_POOL_UNLOCK();
+            return 1;
+        }
+        CAM_POOL_UNLOCK();
+    }
+
+    // Serial execution
+    for (i=0;i<nbTasks;i++) {
+        task(arg,i);
+    }
+    return 1;
+}
+
+/* Band-parallel execution of image kernels
+ * The ROI is split into horizontal bands, processed independently. As the kernels read their
+ * neighbourhood (halo rows) directly from the source image, and not only from within the ROI,
+ * the result is exactly the same as the one of the serial processing.
+ */
+typedef struct {
+    camInternalBandKernel kernel;
+    camInternalBandKernel2 kernel2;
+    CamImage *source1;
+    CamImage *source2; // NULL for kernels with a single source
+    CamImage *dest;
+    void *params;
+    CamROI srcroi1;
+    CamROI srcroi2;
+    CamROI dstroi;
+    int nbBands;
+    int results[CAM_MAX_THREADS];
+} CamBandsJob;
+
+static void camBandsTask(void *arg, int index)
+{
+    CamBandsJob *job=(CamBandsJob*)arg;
+    CamImage source1=*job->source1,source2,dest=*job->dest;
+    CamROI srcroi1=job->srcroi1,srcroi2=job->srcroi2,dstroi=job->dstroi;
+    int y0=job->srcroi1.height*index/job->nbBands;
+    int y1=job->srcroi1.height*(index+1)/job->nbBands;
+
+    srcroi1.yOffset+=y0; srcroi1.height=y1-y0;
+    dstroi.yOffset+=y0; dstroi.height=y1-y0;
+    source1.roi=&srcroi1;
+    dest.roi=&dstroi;
+    if (job->source2) {
+        source2=*job->source2;
+        srcroi2.yOffset+=y0; srcroi2.height=y1-y0;
+        source2.roi=&srcroi2;
+        job->results[index]=job->kernel2(&source1,&source2,&dest,job->params);
+    } else {
+        job->results[index]=job->kernel(&source1,&dest,job->params);
+    }
+}
+
+// Images that can't be split into bands : masks (RLE runs cover the whole ROI), 1U images (bit blocks),
+// and destination images not allocated yet (automatic allocation is left to the kernel)
+static int camBandsSupported(CamImage *source, CamImage *dest)
+{
+    return ((dest!=NULL)&&(dest->imageData!=NULL)&&(source->mask==NULL)
+        &&(source->depth!=CAM_DEPTH_1U)&&(dest->depth!=CAM_DEPTH_1U));
+}
+
+// Images sharing the same pixels (in-place processing) have to be processed serially, unless the kernel
+// is pixel to pixel and the source and dest bands are the same lines of the same image
+static int camBandsIndependent(CamImage *source, CamImage *dest, CamROI *srcroi, CamROI *dstroi, int options)
+{
+    if ((source->imageData<dest->imageData+dest->imageSize)&&(dest->imageData<source->imageData+source->imageSize)) {
+        return ((options&CAM_BANDS_INPLACE)&&(source->imageData==dest->imageData)&&(source->widthStep==dest->widthStep)
+            &&(source->height==dest->height)&&(srcroi->yOffset==dstroi->yOffset));
+    }
+    return 1;
+}
+
+// Runs the job on the worker pool. Returns 0 if the ROI is too small to be split
+static int camBandsRun(CamBandsJob *job, int nbThreads, int options, int *result)
+{
+    int i;
+
+    job->nbBands=nbThreads;
+    if (job->nbBands>job->srcroi1.height/CAM_MIN_BAND_HEIGHT) job->nbBands=job->srcroi1.height/CAM_MIN_BAND_HEIGHT;
+    if (job->nbBands<=1) return 0;
+
+    camInternalParallelRun(camBandsTask,job,job->nbBands);
+    if (options&CAM_BANDS_SUM) {
+        for (*result=0,i=0;i<job->nbBands;i++) *result+=job->results[i];
+    } else {
+        for (*result=1,i=0;i<job->nbBands;i++) if (!job->results[i]) *result=0;
+    }
+    return 1;
+}
+
+int camInternalParallelBands(CamImage *source, CamImage *dest, void *params, camInternalBandKernel kernel, int options)
+{
+    CamBandsJob job;
+    CamInternalROIPolicyStruct iROI;
+    int result,nbThreads=camGetNumThreads();
+
+    if ((nbThreads>1)&&(camBandsSupported(source,dest))
+        &&(camInternalROIPolicy(source,dest,&iROI,CAM_IGNORE_COI_MISMATCH))) {
+        camInternalROIPolicyExit(&iROI);
+        if (camBandsIndependent(source,dest,&iROI.srcroi,&iROI.dstroi,options)) {
+            job.kernel=kernel;
+            job.source1=source;
+            job.source2=NULL;
+            job.dest=dest;
+            job.params=params;
+            job.srcroi1=iROI.srcroi;
+            job.dstroi=iROI.dstroi;
+            if (camBandsRun(&job,nbThreads,options,&result)) return result;
+        }
+    }
+    return kernel(source,dest,params);
+}
+
+int camInternalParallelBands2(CamImage *source1, CamImage *source2, CamImage *dest, void *params, camInternalBandKernel2 kernel, int options)
+{
+    CamBandsJob job;
+    CamInternalROIPolicyStruct iROI1,iROI2;
+    int result,nbThreads=camGetNumThreads();
+
+    if ((nbThreads>1)&&(camBandsSupported(source1,dest))&&(camBandsSupported(source2,dest))
+        &&(camInternalROIPolicy(source1,dest,&iROI1,CAM_IGNORE_COI_MISMATCH))
+        &&(camInternalROIPolicy(source2,dest,&iROI2,CAM_IGNORE_COI_MISMATCH))) {
+        camInternalROIPolicyExit(&iROI1);
+        camInternalROIPolicyExit(&iROI2);
+        // The kernel reports an error for sources of different sizes : let it do it
+        if ((iROI1.srcroi.width==iROI2.srcroi.width)&&(iROI1.srcroi.height==iROI2.srcroi.height)
+            &&(iROI1.dstroi.xOffset==iROI2.dstroi.xOffset)&&(iROI1.dstroi.yOffset==iROI2.dstroi.yOffset)
+            &&(iROI1.dstroi.width==iROI2.dstroi.width)&&(iROI1.dstroi.height==iROI2.dstroi.height)
+            &&(camBandsIndependent(source1,dest,&iROI1.srcroi,&iROI1.dstroi,options))
+            &&(camBandsIndependent(source2,dest,&iROI2.srcroi,&iROI2.dstroi,options))) {
+            job.kernel2=kernel;
+            job.source1=source1;
+            job.source2=source2;
+            job.dest=dest;
+            job.params=params;
+            job.srcroi1=iROI1.srcroi;
+            job.srcroi2=iROI2.srcroi;
+            job.dstroi=iROI1.dstroi;
+            if (camBandsRun(&job,nbThreads,options,&result)) return result;
+        }
+    }
+    return kernel(source1,source2,dest,params);
+}
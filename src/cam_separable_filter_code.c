@@ -77,6 +77,37 @@
     for (i=1;i<CAM_LF_NEIGHB_X;i++) linesPtr[y][x]+=kernel->x[i]*tmpLine##sign[x+i];
 #endif
 
+// The fixed filters, as separable kernels (SIMD code path)
+#if CAM_FIXED_FILTER == CAM_SOBEL_H
+#define CAM_SF_KERNEL_X {1,2,1}
+#define CAM_SF_KERNEL_Y {-1,0,1}
+#define CAM_SF_SHIFT 0
+#elif CAM_FIXED_FILTER == CAM_SOBEL_V
+#define CAM_SF_KERNEL_X {-1,0,1}
+#define CAM_SF_KERNEL_Y {1,2,1}
+#define CAM_SF_SHIFT 0
+#elif CAM_FIXED_FILTER == CAM_GAUSSIAN_3x3
+#define CAM_SF_KERNEL_X {1,2,1}
+#define CAM_SF_KERNEL_Y {1,2,1}
+#define CAM_SF_SHIFT 4
+#elif CAM_FIXED_FILTER == CAM_GAUSSIAN_5x5
+#define CAM_SF_KERNEL_X {1,4,6,4,1}
+#define CAM_SF_KERNEL_Y {1,4,6,4,1}
+#define CAM_SF_SHIFT 8
+#elif CAM_FIXED_FILTER == CAM_GAUSSIAN_7x7
+#define CAM_SF_KERNEL_X {1,6,15,20,15,6,1}
+#define CAM_SF_KERNEL_Y {1,6,15,20,15,6,1}
+#define CAM_SF_SHIFT 12
+#elif CAM_FIXED_FILTER == CAM_SCHARR_H
+#define CAM_SF_KERNEL_X {3,10,3}
+#define CAM_SF_KERNEL_Y {-1,0,1}
+#define CAM_SF_SHIFT 2
+#elif CAM_FIXED_FILTER == CAM_SCHARR_V
+#define CAM_SF_KERNEL_X {-1,0,1}
+#define CAM_SF_KERNEL_Y {3,10,3}
+#define CAM_SF_SHIFT 2
+#endif
+
 #if defined(CAM_FIXED_FILTER)
 int camSepFilter(CamImage *source, CamImage *dest)
 #else
@@ -90,9 +121,11 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
     unsigned CAM_PIXEL *srcptr,*cpsrcptr;
     unsigned CAM_PIXEL_DST *dstptr,*cpdstptr;
     int *tmpptr, *linesPtr[CAM_LF_NEIGHB_Y];
-    int linesBuffer[CAM_LF_NEIGHB_Y][CAM_MAX_SCANLINE];
-    unsigned CAM_PIXEL tmpLineU[((CAM_MAX_SCANLINE+CAM_LF_NEIGHB_X-1)&~15)+16];
-    signed CAM_PIXEL *tmpLineS = (signed CAM_PIXEL*) tmpLineU;
+    int linesStack[CAM_LF_NEIGHB_Y][CAM_MAX_SCANLINE];
+    unsigned CAM_PIXEL tmpLineStack[((CAM_MAX_SCANLINE+CAM_LF_NEIGHB_X-1)&~15)+16];
+    int *linesBuffer;
+    unsigned CAM_PIXEL *tmpLineU;
+    signed CAM_PIXEL *tmpLineS;
     int valmax;
 
     CamRun *run;
@@ -100,6 +133,15 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
     CamInternalROIPolicyStruct iROI;
 #ifndef CAM_FIXED_FILTER
     int acc=0;
+#endif
+#ifdef CAM_AVX2
+    CamLinearFilterSIMDKernel simdk;
+    short *lines16[CAM_LF_NEIGHB_Y];
+    int simd,simdvalmin,simdoptions;
+#ifdef CAM_FIXED_FILTER
+    static const int simdx[CAM_LF_NEIGHB_X]=CAM_SF_KERNEL_X;
+    static const int simdy[CAM_LF_NEIGHB_Y]=CAM_SF_KERNEL_Y;
+#endif
 #endif
     
     // ROI (Region Of Interest) management
@@ -130,6 +172,18 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
     CAM_CHECK_ARGS(camSepFilter,(width>CAM_LF_NEIGHB_X/2));
     CAM_CHECK_ARGS(camSepFilter,(height>CAM_LF_NEIGHB_Y/2));    
     
+    // Line buffers (on the stack up to CAM_MAX_SCANLINE)
+    linesBuffer=(int*)camInternalScratchAlloc(linesStack,sizeof(linesStack),CAM_LF_NEIGHB_Y*width*sizeof(int));
+    tmpLineU=(unsigned CAM_PIXEL*)camInternalScratchAlloc(tmpLineStack,sizeof(tmpLineStack),(((source->width-left+CAM_LF_NEIGHB_X-1)&~15)+16)*sizeof(CAM_PIXEL));
+    if ((linesBuffer==NULL)||(tmpLineU==NULL)) {
+        if (linesBuffer) camInternalScratchFree(linesStack,linesBuffer);
+        if (tmpLineU) camInternalScratchFree(tmpLineStack,tmpLineU);
+        camInternalROIPolicyExit(&iROI);
+        camError("camSepFilter","Memory allocation error");
+        return 0;
+    }
+    tmpLineS=(signed CAM_PIXEL*)tmpLineU;
+
     // Mask management
     if (iROI.mask) {
         run=iROI.mask->runs+1; // Skip the first dummy run
@@ -139,11 +193,34 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
 
     // Initialize algorithm
     for (i=0;i<CAM_LF_NEIGHB_Y;i++) {
-        linesPtr[i]=linesBuffer[i];
+        linesPtr[i]=linesBuffer+i*width;
     }
     if (dest->depth&CAM_DEPTH_SIGN) {
         valmax>>=1;
     }
+
+#ifdef CAM_AVX2
+    // Vectorized code path, for 8-bit source pixels and contiguous destination pixels
+    // The lines produced by the horizontal pass then hold 16-bit integers
+    simd=((camGetCPUFeatures()&CAM_CPU_AVX2)&&(sizeof(CAM_PIXEL)==1)&&(iROI.dstinc==1));
+    if (simd) {
+#ifdef CAM_LF_ABS
+        simdvalmin=0;
+        simdoptions=CAM_LF_SIMD_ABS;
+#else
+        simdvalmin=(dest->depth&CAM_DEPTH_SIGN)?-valmax:0;
+        simdoptions=0;
+#endif
+        if (sizeof(CAM_PIXEL_DST)==2) simdoptions|=CAM_LF_SIMD_DEST16;
+        if (dest->depth&CAM_DEPTH_SIGN) simdoptions|=CAM_LF_SIMD_SIGNED;
+        if (source->depth&CAM_DEPTH_SIGN) simdoptions|=CAM_LF_SIMD_SRC_SIGNED;
+#ifdef CAM_FIXED_FILTER
+        simd=camInternalSepFilterPrepareSIMD(&simdk,CAM_LF_NEIGHB_X,simdx,CAM_LF_NEIGHB_Y,simdy,1,CAM_SF_SHIFT,simdvalmin,valmax,simdoptions);
+#else
+        simd=camInternalSepFilterPrepareSIMD(&simdk,CAM_LF_NEIGHB_X,kernel->x,CAM_LF_NEIGHB_Y,kernel->y,kernel->coeff1,kernel->coeff2,simdvalmin,valmax,simdoptions);
+#endif
+    }
+#endif
     
     // Initialize neighbourhood
     
@@ -170,6 +247,11 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
         }
         
         // Process the line
+#ifdef CAM_AVX2
+        if (simd) {
+            camInternalSepFilterLineHAVX2((unsigned char*)tmpLineU,(short*)linesPtr[y],width,&simdk);
+        } else
+#endif
         if (source->depth & CAM_DEPTH_SIGN) {
 	    for (x=0;x<width;x++) {
 		PROCESS_X(S,y);
@@ -220,6 +302,11 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
         srcptr=(unsigned CAM_PIXEL*)(((char*)cpsrcptr)+source->widthStep);
         
         // Process the line
+#ifdef CAM_AVX2
+        if (simd) {
+            camInternalSepFilterLineHAVX2((unsigned char*)tmpLineU,(short*)linesPtr[y],width,&simdk);
+        } else
+#endif
         if (source->depth & CAM_DEPTH_SIGN) {
 	    for (x=0;x<width;x++) {
 		PROCESS_X(S,y);
@@ -298,6 +385,11 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
         }
         
         // Process the line
+#ifdef CAM_AVX2
+        if (simd) {
+            camInternalSepFilterLineHAVX2((unsigned char*)tmpLineU,(short*)linesPtr[CAM_LF_NEIGHB_Y-1],width,&simdk);
+        } else
+#endif
         if (source->depth & CAM_DEPTH_SIGN) {
 	    for (x=0;x<width;x++) {
 		PROCESS_X(S,CAM_LF_NEIGHB_Y-1);
@@ -308,6 +400,12 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
 	    }
 	}
 
+#ifdef CAM_AVX2
+        if (simd) {
+            for (i=0;i<CAM_LF_NEIGHB_Y;i++) lines16[i]=(short*)linesPtr[i];
+        }
+#endif
+
         startx=0;
         do {
             // Mask management
@@ -323,6 +421,16 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
                 dstptr=cpdstptr+startx*iROI.dstinc;
             }
             
+#ifdef CAM_AVX2
+            if (simd) {
+#ifndef CAM_FIXED_FILTER
+                camInternalSepFilterLineVAVX2(lines16,startx,endx-startx,dstptr,&simdk,&acc);
+#else
+                camInternalSepFilterLineVAVX2(lines16,startx,endx-startx,dstptr,&simdk,NULL);
+#endif
+                dstptr+=endx-startx;
+            } else
+#endif
             // Process all the pixels in the line
             for (x=startx;x<endx;x++) {   
                 
@@ -411,6 +519,8 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
         linesPtr[CAM_LF_NEIGHB_Y-1]=tmpptr;
     }
     
+    camInternalScratchFree(linesStack,linesBuffer);
+    camInternalScratchFree(tmpLineStack,tmpLineU);
     camInternalROIPolicyExit(&iROI);
 #ifndef CAM_FIXED_FILTER
     return acc;
@@ -420,4 +530,7 @@ int camSepFilter(CamImage *source, CamImage *dest, CamSepFilterKernel *kernel)
 }
 
 #undef PROCESS_X
+#undef CAM_SF_KERNEL_X
+#undef CAM_SF_KERNEL_Y
+#undef CAM_SF_SHIFT
 
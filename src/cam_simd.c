@@ -0,0 +1,113 @@
+/***************************************
+ *
+ *  Camellia Image Processing Library
+ *
+
+    The Camellia Image Processing Library is an open source low-level image processing library.
+    As it uses the IplImage structure to describe images, it is a good replacement to the IPL (Intel) library
+    and a good complement to the OpenCV library. It includes a lot of functions for image processing
+    (filtering, morphological mathematics, labeling, warping, loading/saving images, etc.),
+    some of them being highly optimized; It is also cross-platform and robust. It is doxygen-documented
+    and examples of use are provided.
+
+    This software library is an outcome of the Camellia european project (IST-2001-34410).
+    It was developped by the Ecole des Mines de Paris (ENSMP), in coordination with
+    the other partners of the project.
+
+  ==========================================================================
+
+    Copyright (c) 2002-2006, Ecole des Mines de Paris - Centre de Robotique
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer
+          in the documentation and/or other materials provided with the distribution.
+        * Neither the name of the Ecole des Mines de Paris nor the names of
+          its contributors may be used to endorse or promote products
+          derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+    EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+    PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+    PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+    LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  ==========================================================================
+*/
+
+/* Run-time detection of the SIMD instruction sets
+ * C code */
+
+#include "camellia.h"
+#include "camellia_internals.h"
+#ifdef CAM_AVX2
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+static int camCPUDetected=0;  // Instruction sets supported by the processor and the operating system
+static int camCPUEnabled=0;   // Instruction sets used by the library
+static CamInternalOnce camCPUOnce=CAM_ONCE_INIT;
+
+static void camDetectCPUFeatures(void)
+{
+#ifdef CAM_AVX2
+    unsigned int eax,ebx,ecx,edx,xcr0;
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs,0);
+    if (regs[0]>=7) {
+        __cpuid(regs,1);
+        ecx=regs[2];
+        // AVX2 is usable only if the OS saves the YMM registers (OSXSAVE and XCR0)
+        if ((ecx&(1<<27))&&(ecx&(1<<28))) {
+            xcr0=(unsigned int)_xgetbv(0);
+            if ((xcr0&6)==6) {
+                __cpuidex(regs,7,0);
+                if (regs[1]&(1<<5)) camCPUDetected|=CAM_CPU_AVX2;
+            }
+        }
+    }
+#else
+    if (__get_cpuid_max(0,NULL)>=7) {
+        __cpuid(1,eax,ebx,ecx,edx);
+        // AVX2 is usable only if the OS saves the YMM registers (OSXSAVE and XCR0)
+        if ((ecx&(1<<27))&&(ecx&(1<<28))) {
+            __asm__ __volatile__("xgetbv" : "=a"(xcr0), "=d"(edx) : "c"(0));
+            if ((xcr0&6)==6) {
+                __cpuid_count(7,0,eax,ebx,ecx,edx);
+                if (ebx&(1<<5)) camCPUDetected|=CAM_CPU_AVX2;
+            }
+        }
+    }
+#endif
+#endif
+    camCPUEnabled=camCPUDetected;
+}
+
+int camSetCPUFeatures(int features)
+{
+    camInternalOnce(&camCPUOnce,camDetectCPUFeatures);
+    camCPUEnabled=features&camCPUDetected;
+    return camCPUEnabled;
+}
+
+int camGetCPUFeatures()
+{
+    camInternalOnce(&camCPUOnce,camDetectCPUFeatures);
+    return camCPUEnabled;
+}
@@ -58,14 +58,20 @@ const char *camVersion()
     return CAM_VERSION;
 }
 
-FILE *camProfilingDataHandle=NULL;
+static FILE *camProfilingDataHandle=NULL;
+static CamInternalOnce camProfilingDataOnce=CAM_ONCE_INIT;
 
-/* Warning : This code is not reentrant. Use only for debugging purpose */
+static void camOpenProfilingData(void)
+{
+    camProfilingDataHandle = fopen("cam_profiling.txt","wt");
+}
+
+/* Use only for debugging purpose. The file is opened once, and each line is written
+ * by a single fprintf (stdio streams are locked), so that threads don't mix their lines up */
 int camLogProfilingData(const char *module, int nbiter) 
 {
-    if (camProfilingDataHandle == NULL) {
-	camProfilingDataHandle = fopen("cam_profiling.txt","wt");
-    }
+    camInternalOnce(&camProfilingDataOnce, camOpenProfilingData);
+    if (camProfilingDataHandle == NULL) return 0;
     fprintf(camProfilingDataHandle, "%s\t%d\n", module, nbiter);
     return 1;
 }
@@ -332,6 +338,19 @@ void camInternalROIPolicyExit(CamInternalROIPolicyStruct *s)
     }
 }
 
+/* Scratch memory for scanline kernels
+ */
+void *camInternalScratchAlloc(void *stackBuffer, int stackSize, int size)
+{
+    if (size<=stackSize) return stackBuffer;
+    return malloc(size);
+}
+
+void camInternalScratchFree(void *stackBuffer, void *buffer)
+{
+    if (buffer!=stackBuffer) free(buffer);
+}
+
 /* Image allocation utility routine
  */
 int camAllocateImageEx(CamImage *image, int width, int height, int depth, int channelseq)
@@ -550,9 +569,9 @@ int camAllocateHLSImage(CamImage *image, int width, int height)
 	image->borderMode[i]=CAM_BORDER_REPLICATE;
 	image->borderConst[i]=0;
     }    
-    psize=8;
+    psize=16;
     image->widthStep=(((image->width+image->align-1)*psize/8/image->align)*image->align);
-    image->imageSize=image->widthStep*3*image->height*psize/8;
+    image->imageSize=image->widthStep*3*image->height;
     if (width & CAM_HEADER_ONLY) {
         image->imageDataOrigin = NULL;
         image->imageData = NULL;
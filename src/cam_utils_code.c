@@ -54,7 +54,8 @@ int camCopy(CamImage* source, CamImage* dest)
     int width,height;
     CAM_PIXEL *srcptr,*cpsrcptr;
     CAM_PIXEL_DST *dstptr,*cpdstptr;
-    CamROI roi,roi2,*tmp,*tmp2;
+    CamROI roi,roi2;
+    CamImage srccopy,dstcopy; // Headers with a per-channel ROI. The caller's images are left untouched
 #ifdef CAM_SATURATE
     int valpix;
     int valmin=0, valmax=255;
@@ -79,24 +80,26 @@ int camCopy(CamImage* source, CamImage* dest)
             ((dest->roi==NULL)||(dest->roi->coi==0))) special=2;
     }
     if (special) {
-        tmp=dest->roi;
         if (dest->roi) {
-            roi=*tmp;
+            roi=*dest->roi;
         } else {
             camSetMaxROI(&roi,dest);
         }
-        dest->roi=&roi;
+        dstcopy=*dest;
+        dstcopy.roi=&roi;
+        dest=&dstcopy;
         roi.coi=1;
         n=dest->nChannels;
         if (n==4) n=3; // Doesn't copy to the alpha channel
         if (special==2) {
-            tmp2=source->roi;
             if (source->roi) {
-                roi2=*tmp2;
+                roi2=*source->roi;
             } else {
                 camSetMaxROI(&roi2,source);
             }
-            source->roi=&roi2;
+            srccopy=*source;
+            srccopy.roi=&roi2;
+            source=&srccopy;
             roi2.coi=1;
         }
     } else n=1;
@@ -261,8 +264,6 @@ int camCopy(CamImage* source, CamImage* dest)
             roi.coi=4;
             camSet(dest,0); // Fill the alpha channel. All pixels are set transparent
         }
-        dest->roi=tmp; // Restore roi
-        if (special==2) source->roi=tmp2;
     }
 
     return 1;
@@ -201,8 +201,9 @@ int camWarpingSuperSampling(CamImage *source, CamImage *dest, CamWarpingParams *
     int xp,yp; // Position of the current point
     int xpp,ypp; // Position of the previous point
     int incxp,incyp; // Increment for the current point 
-    int xpl[CAM_MAX_SCANLINE+1],ypl[CAM_MAX_SCANLINE+1]; // (x,y) points for the previous scanline
-    CAM_PIXEL scanline[CAM_MAX_SCANLINE+1],valpix1,valpixp;
+    int *xpl,*ypl; // (x,y) points for the previous scanline
+    int plStack[2][CAM_MAX_SCANLINE+1],*plBuffer;
+    CAM_PIXEL scanlineStack[CAM_MAX_SCANLINE+1],*scanline,valpix1,valpixp;
     CAM_PIXEL *dstptr,*srcptr1,*cpdstptr;
     int xptr1,yptr1=0xdead; // Special value. Generally inaccessible.
     int result,xx,yy;
@@ -228,6 +229,18 @@ int camWarpingSuperSampling(CamImage *source, CamImage *dest, CamWarpingParams *
 	width=dest->width;
 	height=dest->height;
     }
+
+    // Scanline buffers (on the stack up to CAM_MAX_SCANLINE)
+    plBuffer=(int*)camInternalScratchAlloc(plStack,sizeof(plStack),2*(width+1)*sizeof(int));
+    scanline=(CAM_PIXEL*)camInternalScratchAlloc(scanlineStack,sizeof(scanlineStack),(width+1)*sizeof(CAM_PIXEL));
+    if ((plBuffer==NULL)||(scanline==NULL)) {
+        if (plBuffer) camInternalScratchFree(plStack,plBuffer);
+        if (scanline) camInternalScratchFree(scanlineStack,scanline);
+        camError("camWarpingSuperSampling","Memory allocation error");
+        return 0;
+    }
+    xpl=plBuffer;
+    ypl=plBuffer+width+1;
     
     xl=params->p[0].x;
     yl=params->p[0].y;
@@ -365,6 +378,9 @@ int camWarpingSuperSampling(CamImage *source, CamImage *dest, CamWarpingParams *
 	// Move the destination pointer
 	dstptr=(CAM_PIXEL*)(((char*)cpdstptr)+dest->widthStep);
     }
+
+    camInternalScratchFree(plStack,plBuffer);
+    camInternalScratchFree(scanlineStack,scanline);
     return 1;
 }
 
@@ -51,16 +51,17 @@
 
 // Fast yuv2rgb conversion
 
-static long int LUTYUV2RGB[256]={-1};
+static long int LUTYUV2RGB[256];
 static long int BU[256];
 static long int GU[256];
 static long int GV[256];
 static long int to76309[256];
 static unsigned char clip[1024]; // For clipping in CCIR601
+static CamInternalOnce camLUTYUV2RGBOnce=CAM_ONCE_INIT;
 
 static void camInitLUTYUV2RGB();
 
-int camYUV2RGB(CamImage* source, CamImage *dest)
+static int camYUV2RGBSerial(CamImage* source, CamImage *dest)
 {
     unsigned char *srcptr,*dstptr;
     int x,y;
@@ -89,9 +90,6 @@ int camYUV2RGB(CamImage* source, CamImage *dest)
     height=iROI.srcroi.height;
     INIT_MASK_MANAGEMENT;
 
-    // Initialize tables if need be
-    if (LUTYUV2RGB[0]==-1) camInitLUTYUV2RGB();
-    
     if (source->dataOrder==CAM_DATA_ORDER_PIXEL) {
         for (y = 0; y < height; y ++) { 
             srcptr=(unsigned char*)(iROI.srcptr+y*source->widthStep);
@@ -153,6 +151,18 @@ int camYUV2RGB(CamImage* source, CamImage *dest)
     return 1;
 }
 
+static int camYUV2RGBBand(CamImage *source, CamImage *dest, void *params)
+{
+    return camYUV2RGBSerial(source,dest);
+}
+
+int camYUV2RGB(CamImage* source, CamImage *dest)
+{
+    // Tables are initialized before the bands are dispatched
+    camInternalOnce(&camLUTYUV2RGBOnce,camInitLUTYUV2RGB);
+    return camInternalParallelBands(source,dest,NULL,camYUV2RGBBand,0);
+}
+
 void camInitLUTYUV2RGB()
 {
     long int crv,cbu,cgu,cgv;
@@ -181,11 +191,12 @@ void camInitLUTYUV2RGB()
 
 static int YR[256], YG[256], YB[256];
 static int UR[256], UG[256], UBVR[256];
-static int          VG[256], VB[256]={-1};
+static int          VG[256], VB[256];
+static CamInternalOnce camLUTRGB2YUVOnce=CAM_ONCE_INIT;
 
 static void camInitLUTRGB2YUV();
 
-int camRGB2YUV(CamImage *source, CamImage *dest)
+static int camRGB2YUVSerial(CamImage *source, CamImage *dest)
 {
     int x,y,width,height;
     unsigned char *r, *g, *b;
@@ -210,8 +221,6 @@ int camRGB2YUV(CamImage *source, CamImage *dest)
     CAM_CHECK_ARGS(camRGB2YUV,(*((int*)dest->colorModel)==*((int*)"YUV")));
     CAM_CHECK_ARGS(camRGB2YUV,(*((int*)source->colorModel)==*((int*)"RGB"))||(*((int*)source->colorModel)==*((int*)"RGBA")));
     
-    if (VB[0]==-1) camInitLUTRGB2YUV();
-    
     width=iROI.srcroi.width;
     height=iROI.srcroi.height;
 
@@ -269,7 +278,7 @@ int camRGB2YUV(CamImage *source, CamImage *dest)
     return 1;
 }
 
-int camRGB2Y(CamImage *source, CamImage *dest)
+static int camRGB2YSerial(CamImage *source, CamImage *dest)
 {
     int x,y,width,height;
     unsigned char *r, *g, *b;
@@ -292,8 +301,6 @@ int camRGB2Y(CamImage *source, CamImage *dest)
     CAM_CHECK_ARGS(camRGB2Y,dest->depth==CAM_DEPTH_8U);
     CAM_CHECK_ARGS(camRGB2Y,(*((int*)source->colorModel)==*((int*)"RGB"))||(*((int*)source->colorModel)==*((int*)"RGBA")));
     
-    if (VB[0]==-1) camInitLUTRGB2YUV();
-    
     width=iROI.srcroi.width;
     height=iROI.srcroi.height;
 
@@ -343,6 +350,29 @@ int camRGB2Y(CamImage *source, CamImage *dest)
     return 1;
 }
 
+static int camRGB2YUVBand(CamImage *source, CamImage *dest, void *params)
+{
+    return camRGB2YUVSerial(source,dest);
+}
+
+static int camRGB2YBand(CamImage *source, CamImage *dest, void *params)
+{
+    return camRGB2YSerial(source,dest);
+}
+
+// Tables are initialized before the bands are dispatched
+int camRGB2YUV(CamImage *source, CamImage *dest)
+{
+    camInternalOnce(&camLUTRGB2YUVOnce,camInitLUTRGB2YUV);
+    return camInternalParallelBands(source,dest,NULL,camRGB2YUVBand,0);
+}
+
+int camRGB2Y(CamImage *source, CamImage *dest)
+{
+    camInternalOnce(&camLUTRGB2YUVOnce,camInitLUTRGB2YUV);
+    return camInternalParallelBands(source,dest,NULL,camRGB2YBand,0);
+}
+
 void camInitLUTRGB2YUV()
 {
     int i;
@@ -149,6 +149,11 @@ bool CamImage::set_roi(const CamROI &roi) {
     return true;
 }
 
+bool CamImage::set_border(int mode, int value) {
+    for (int i=0;i<4;i++) borderMode[i]=mode;
+    return (camSetBorder(this,value))?true:false;
+}
+
 bool CamImage::alpha_composite(const CamImage& source2, CamImage& dest) const
 {
     return (camAlphaComposite((CamImage*)this,(CamImage*)&source2,&dest))?true:false;
@@ -333,6 +338,86 @@ int CamImage::morpho_gradient_circle7(CamImage &dest) const
     return camMorphoGradientCircle7((CamImage*)this,&dest);
 }
 
+int CamImage::erode_rect(int width, int height)
+{
+    return camErodeRect(this,this,width,height);
+}
+
+int CamImage::erode_rect(CamImage &dest, int width, int height) const
+{
+    return camErodeRect((CamImage*)this,&dest,width,height);
+}
+
+int CamImage::dilate_rect(int width, int height)
+{
+    return camDilateRect(this,this,width,height);
+}
+
+int CamImage::dilate_rect(CamImage &dest, int width, int height) const
+{
+    return camDilateRect((CamImage*)this,&dest,width,height);
+}
+
+int CamImage::morpho_gradient_rect(int width, int height)
+{
+    return camMorphoGradientRect(this,this,width,height);
+}
+
+int CamImage::morpho_gradient_rect(CamImage &dest, int width, int height) const
+{
+    return camMorphoGradientRect((CamImage*)this,&dest,width,height);
+}
+
+int CamImage::open_rect(int width, int height)
+{
+    return camOpenRect(this,this,width,height);
+}
+
+int CamImage::open_rect(CamImage &dest, int width, int height) const
+{
+    return camOpenRect((CamImage*)this,&dest,width,height);
+}
+
+int CamImage::close_rect(int width, int height)
+{
+    return camCloseRect(this,this,width,height);
+}
+
+int CamImage::close_rect(CamImage &dest, int width, int height) const
+{
+    return camCloseRect((CamImage*)this,&dest,width,height);
+}
+
+int CamImage::top_hat_rect(int width, int height)
+{
+    return camTopHatRect(this,this,width,height);
+}
+
+int CamImage::top_hat_rect(CamImage &dest, int width, int height) const
+{
+    return camTopHatRect((CamImage*)this,&dest,width,height);
+}
+
+int CamImage::black_top_hat_rect(int width, int height)
+{
+    return camBlackTopHatRect(this,this,width,height);
+}
+
+int CamImage::black_top_hat_rect(CamImage &dest, int width, int height) const
+{
+    return camBlackTopHatRect((CamImage*)this,&dest,width,height);
+}
+
+int CamImage::alternating_sequential_filter_rect(int order, int closingFirst)
+{
+    return camAlternatingSequentialFilterRect(this,this,order,closingFirst);
+}
+
+int CamImage::alternating_sequential_filter_rect(CamImage &dest, int order, int closingFirst) const
+{
+    return camAlternatingSequentialFilterRect((CamImage*)this,&dest,order,closingFirst);
+}
+
 int CamImage::morpho_maths(const CamMorphoMathsKernel &ker)
 {
     return camMorphoMaths(this,this,(CamMorphoMathsKernel*)&ker);
@@ -553,6 +638,36 @@ bool CamImage::fixed_filter(CamImage &dest, int filter) const
     return (camFixedFilter((CamImage*)this,(CamImage*)&dest,filter))?true:false;
 }
 
+bool CamImage::median_filter_3x3()
+{
+    return (camMedianFilter3x3(this,this))?true:false;
+}
+
+bool CamImage::median_filter_3x3(CamImage &dest) const
+{
+    return (camMedianFilter3x3((CamImage*)this,&dest))?true:false;
+}
+
+bool CamImage::median_filter_5x5()
+{
+    return (camMedianFilter5x5(this,this))?true:false;
+}
+
+bool CamImage::median_filter_5x5(CamImage &dest) const
+{
+    return (camMedianFilter5x5((CamImage*)this,&dest))?true:false;
+}
+
+bool CamImage::median_filter(int size)
+{
+    return (camMedianFilterNxN(this,this,size))?true:false;
+}
+
+bool CamImage::median_filter(CamImage &dest, int size) const
+{
+    return (camMedianFilterNxN((CamImage*)this,&dest,size))?true:false;
+}
+
 bool CamImage::draw_line(int x1, int y1, int x2, int y2, int color)
 {
     return (camDrawLine(this,x1,y1,x2,y2,color))?true:false;
@@ -739,6 +854,51 @@ bool CamImage::encode_threshold_inv(CamRLEImage& dest, int threshold) const
     return (camRLEEncodeThresholdInv((CamImage*)this,&dest,threshold))?true:false;
 }
 
+CamBlobs* CamImage::labeling_threshold(int threshold, const CamImage *original) const
+{
+    CamBlobs *res=new CamBlobs;
+    if (!camRLELabelingThreshold((CamImage*)this,threshold,(CamImage*)original,res)) {
+        delete res;
+        return NULL;
+    }
+    return res;
+}
+
+CamBlobs* CamImage::labeling_lut(const CamTable &LUT, const CamImage *original) const
+{
+    CamBlobs *res=new CamBlobs;
+    if (!camRLELabelingLUT((CamImage*)this,(CamTable*)&LUT,(CamImage*)original,res)) {
+        delete res;
+        return NULL;
+    }
+    return res;
+}
+
+bool CamImage::labeling_threshold(CamBlobs &results, int threshold, const CamImage *original) const
+{
+    return (camRLELabelingThreshold((CamImage*)this,threshold,(CamImage*)original,&results))?true:false;
+}
+
+bool CamImage::labeling_lut(CamBlobs &results, const CamTable &LUT, const CamImage *original) const
+{
+    return (camRLELabelingLUT((CamImage*)this,(CamTable*)&LUT,(CamImage*)original,&results))?true:false;
+}
+
+CamBlobs* CamImage::labeling(CamImage *dest, int connectivity, const CamImage *original) const
+{
+    CamBlobs *res=new CamBlobs;
+    if (!camLabelingUnionFind((CamImage*)this,dest,connectivity,(CamImage*)original,res)) {
+        delete res;
+        return NULL;
+    }
+    return res;
+}
+
+bool CamImage::labeling(CamBlobs &results, CamImage *dest, int connectivity, const CamImage *original) const
+{
+    return (camLabelingUnionFind((CamImage*)this,dest,connectivity,(CamImage*)original,&results))?true:false;
+}
+
 int CamImage::threshold(int threshold)
 {
     return camThreshold(this,this,threshold);
@@ -940,6 +1100,40 @@ int &CamTable::operator[](int n)
     return t[0];
 }
 
+CamBlobs::CamBlobs(int capacity)
+{
+    camBlobsAllocate(this,capacity);
+}
+
+CamBlobs::CamBlobs(const CamBlobs &blobs)
+{
+    nbBlobs=0; allocated=0; blobInfo=NULL; features=0; scratch=NULL; scratchSize=0;
+    *this=blobs;
+}
+
+CamBlobs::~CamBlobs()
+{
+    camBlobsDeallocate(this);
+}
+
+CamBlobs& CamBlobs::operator=(const CamBlobs &blobs)
+{
+    if (this!=&blobs) {
+        nbBlobs=0;
+        features=blobs.features;
+        if (camBlobsReserve(this,blobs.nbBlobs)) {
+            if (blobs.nbBlobs) memcpy(blobInfo,blobs.blobInfo,blobs.nbBlobs*sizeof(CamBlobInfo));
+            nbBlobs=blobs.nbBlobs;
+        }
+    }
+    return *this;
+}
+
+bool CamBlobs::reserve(int capacity)
+{
+    return (camBlobsReserve(this,capacity))?true:false;
+}
+
 CamBlobInfo& CamBlobs::operator[](int index)
 {
     if ((index>=0)&&(index<nbBlobs)) return blobInfo[index];
@@ -947,6 +1141,32 @@ CamBlobInfo& CamBlobs::operator[](int index)
     return blobInfo[0];
 }
 
+CamRLELabelingStream::CamRLELabelingStream(int width, int features)
+{
+    state=NULL;
+    camRLELabelingStreamAllocate(this,width,features);
+}
+
+CamRLELabelingStream::~CamRLELabelingStream()
+{
+    camRLELabelingStreamDeallocate(this);
+}
+
+bool CamRLELabelingStream::threshold(const CamImage &rows, int threshold, CamBlobs &closed, const CamImage *original)
+{
+    return (camRLELabelingStreamThreshold(this,(CamImage*)&rows,threshold,(CamImage*)original,&closed))?true:false;
+}
+
+bool CamRLELabelingStream::lut(const CamImage &rows, const CamTable &LUT, CamBlobs &closed, const CamImage *original)
+{
+    return (camRLELabelingStreamLUT(this,(CamImage*)&rows,(CamTable*)&LUT,(CamImage*)original,&closed))?true:false;
+}
+
+bool CamRLELabelingStream::end(CamBlobs &closed)
+{
+    return (camRLELabelingStreamEnd(this,&closed))?true:false;
+}
+
 CamRLEImage::CamRLEImage(int nbruns)
 {
     camRLEAllocate(this,nbruns);
@@ -1063,6 +1283,28 @@ bool CamRLEImage::inverse()
     return (camRLEInverse(this))?true:false;
 }
 
+bool CamRLEImage::arithm(const CamRLEImage &source2, CamRLEImage &dest, int operation) const
+{
+    return (camRLEDyadicArithm((CamRLEImage*)this,(CamRLEImage*)&source2,&dest,operation))?true:false;
+}
+
+CamRLEImage* CamRLEImage::arithm(const CamRLEImage &source2, int operation) const
+{
+    CamRLEImage *dest=new CamRLEImage(this->nbRuns+source2.nbRuns);
+    camRLEDyadicArithm((CamRLEImage*)this,(CamRLEImage*)&source2,dest,operation);
+    return dest;
+}
+
+int CamRLEImage::population_count() const
+{
+    return camRLEPopulationCount((CamRLEImage*)this);
+}
+
+int CamRLEImage::bounding_box(CamROI &box) const
+{
+    return camRLEBoundingBox((CamRLEImage*)this,&box);
+}
+
 bool CamRLEImage::erode_cross(CamRLEImage &dest) const
 {
     return (camRLEErodeCross((CamRLEImage*)this,&dest))?true:false;
@@ -1099,6 +1341,54 @@ CamRLEImage* CamRLEImage::erode_3x2() const
     return dest;
 }
 
+bool CamRLEImage::erode_rect(CamRLEImage &dest, int width, int height) const
+{
+    return (camRLEErodeRect((CamRLEImage*)this,&dest,width,height))?true:false;
+}
+
+CamRLEImage* CamRLEImage::erode_rect(int width, int height) const
+{
+    CamRLEImage *dest=new CamRLEImage(this->allocated);
+    camRLEErodeRect((CamRLEImage*)this,dest,width,height);
+    return dest;
+}
+
+bool CamRLEImage::dilate_rect(CamRLEImage &dest, int width, int height) const
+{
+    return (camRLEDilateRect((CamRLEImage*)this,&dest,width,height))?true:false;
+}
+
+CamRLEImage* CamRLEImage::dilate_rect(int width, int height) const
+{
+    CamRLEImage *dest=new CamRLEImage(this->allocated);
+    camRLEDilateRect((CamRLEImage*)this,dest,width,height);
+    return dest;
+}
+
+bool CamRLEImage::open_rect(CamRLEImage &dest, int width, int height) const
+{
+    return (camRLEOpenRect((CamRLEImage*)this,&dest,width,height))?true:false;
+}
+
+CamRLEImage* CamRLEImage::open_rect(int width, int height) const
+{
+    CamRLEImage *dest=new CamRLEImage(this->allocated);
+    camRLEOpenRect((CamRLEImage*)this,dest,width,height);
+    return dest;
+}
+
+bool CamRLEImage::close_rect(CamRLEImage &dest, int width, int height) const
+{
+    return (camRLECloseRect((CamRLEImage*)this,&dest,width,height))?true:false;
+}
+
+CamRLEImage* CamRLEImage::close_rect(int width, int height) const
+{
+    CamRLEImage *dest=new CamRLEImage(this->allocated);
+    camRLECloseRect((CamRLEImage*)this,dest,width,height);
+    return dest;
+}
+
 CamTableOfBasins::~CamTableOfBasins()
 {
     camFreeTableOfBasins(this);
@@ -1169,6 +1459,21 @@ int CamKeypoints::matchingKdTree(const CamKeypointsKdTree &kdTree, CamKeypointsM
     return camKeypointsMatchingKdTree((CamKeypoints*)this, kdTree.root, &matches, explore);
 } 
 
+bool CamKeypoints::quantize(int depth)
+{
+    return (camKeypointsQuantize(this, depth))?true:false;
+}
+
+int CamKeypoints::matchingDatabase(const CamKeypointsDatabase &db, CamKeypointsMatches &matches) const
+{
+    return camKeypointsMatchingDatabase((CamKeypoints*)this, (CamKeypointsDatabase*)&db, &matches);
+}
+
+int CamKeypoints::matchingIndex(const CamKeypointsIndex &index, CamKeypointsMatches &matches, int checks) const
+{
+    return camKeypointsMatchingIndex((CamKeypoints*)this, (CamKeypointsIndex*)&index, &matches, checks);
+}
+
 bool CamKeypoints::add(CamKeypoint &p)
 {
     if (nbPoints >= allocated) return false;
@@ -1177,6 +1482,58 @@ bool CamKeypoints::add(CamKeypoint &p)
     return true;
 }
 
+CamKeypointsDatabase::CamKeypointsDatabase(const CamKeypoints **models, int nbModels, int depth)
+{
+    nbPoints = 0; size = 0; this->depth = 0; descriptors = NULL; keypoint = NULL; id = NULL; buffer = NULL; file = NULL;
+    if (nbModels != 0) compile(models, nbModels, depth);
+}
+
+CamKeypointsDatabase::~CamKeypointsDatabase()
+{
+    camFreeKeypointsDatabase(this);
+}
+
+bool CamKeypointsDatabase::compile(const CamKeypoints **models, int nbModels, int depth)
+{
+    camFreeKeypointsDatabase(this);
+    return (camKeypointsCompileDatabase(this, (CamKeypoints**)models, nbModels, depth))?true:false;
+}
+
+bool CamKeypointsDatabase::save(const char *filename, const CamKeypointsIndex *index) const
+{
+    return (camKeypointsSaveDatabase((CamKeypointsDatabase*)this, (CamKeypointsIndex*)index, filename))?true:false;
+}
+
+bool CamKeypointsDatabase::map(const char *filename, CamKeypointsIndex *index)
+{
+    if (index) camFreeKeypointsIndex(index);
+    camFreeKeypointsDatabase(this);
+    return (camKeypointsMapDatabase(this, index, filename))?true:false;
+}
+
+CamKeypointsIndex::CamKeypointsIndex(const CamKeypointsDatabase *db, int nbTrees)
+{
+    this->nbTrees = 0; nbNodes = 0; nodes = NULL; trees = NULL; rows = NULL; this->db = NULL; buffer = NULL;
+    if (db) compile(*db, nbTrees);
+}
+
+CamKeypointsIndex::~CamKeypointsIndex()
+{
+    camFreeKeypointsIndex(this);
+}
+
+bool CamKeypointsIndex::compile(const CamKeypointsDatabase &db, int nbTrees)
+{
+    camFreeKeypointsIndex(this);
+    return (camKeypointsCompileIndex(this, (CamKeypointsDatabase*)&db, nbTrees))?true:false;
+}
+
+CamKeypoint *CamKeypointsIndex::find(const CamKeypoint *point, int checks, int *dist1, int *dist2) const
+{
+    int d1, d2;
+    return camFindKeypointIndex((CamKeypoint*)point, (CamKeypointsIndex*)this, checks, (dist1)?dist1:&d1, (dist2)?dist2:&d2);
+}
+
 CamKeypoint *CamKeypointsKdTree::find(const CamKeypoint *point, int explore, int *dist1, int *dist2) const
 {
     return camFindKeypointKdTree((CamKeypoint*)point, this->root, explore, dist1, dist2);
@@ -9,4 +9,19 @@ class TestArithm < Test::Unit::TestCase
     # resulting pixel sum should be 0
     assert_equal(n,0)
   end
+
+  def test_threads
+    source=CamImage.new
+    result=CamImage.new
+    source.load_pgm("resources/chess.pgm")
+    n=source.threshold(result,128)
+    expected=result.clone
+    # band parallel processing must give the same image
+    camSetNumThreads(4)
+    assert_equal(n,source.threshold(result,128))
+    assert_equal(0,result.arithm(expected,result,CAM_ARITHM_ABSDIFF))
+    assert_equal(n,source.threshold!(128))
+    assert_equal(0,source.arithm(expected,result,CAM_ARITHM_ABSDIFF))
+    camSetNumThreads(1)
+  end
 end
@@ -9,4 +9,33 @@ class TestCopy < Test::Unit::TestCase
     source.copy(dest)
     dest.save_bmp("output/copy_alfa156.bmp")
   end
+
+  def test_copy_channels
+    source=CamImage.new
+    source.load_bmp("resources/alfa156.bmp")
+    # the ROIs are kept in variables, as the images only point to them
+    roi=CamROI.new(0,10,20,100,50)
+    source.set_roi(roi)
+    # RGB to RGBA copy, which processes the channels one after the other
+    dest=CamImage.new(100,50,CAM_DEPTH_8U,CAM_COLORMODEL_RGBA)
+    source.copy(dest)
+    # the headers of the caller's images are left untouched
+    assert_equal(0,source.roi.coi)
+    assert_equal(10,source.roi.xOffset)
+    assert_nil(dest.roi)
+    # reference : copy of each channel, then transparent alpha channel
+    expected=CamImage.new(100,50,CAM_DEPTH_8U,CAM_COLORMODEL_RGBA)
+    channel_roi=CamROI.new(0,10,20,100,50)
+    expected_roi=CamROI.new(0,0,0,100,50)
+    source.set_roi(channel_roi)
+    expected.set_roi(expected_roi)
+    (1..3).each do |c|
+      channel_roi.coi=c
+      expected_roi.coi=c
+      source.copy(expected)
+    end
+    expected_roi.coi=4
+    expected.set!(0)
+    assert_equal(expected.to_s,dest.to_s)
+  end
 end
@@ -19,4 +19,155 @@ class TestFixedFilters < Test::Unit::TestCase
     # save the result
     result.save_pgm("output/ruby_chess_gaussian_7x7.pgm");
   end
+
+  def test_wide_image
+    # wider than CAM_MAX_SCANLINE
+    source=CamImage.new(2000,64)
+    result=CamImage.new(2000,64)
+    source.set!(10)
+    assert(source.fixed_filter(result,CAM_GAUSSIAN_7x7))
+    # a constant image remains constant
+    assert_equal(10*2000*64,result.erode_circle5!)
+  end
+
+  def test_threads
+    source=CamImage.new
+    result=CamImage.new
+    source.load_pgm("resources/chess.pgm")
+    # serial processing
+    sum=source.morpho_gradient_circle5(result)
+    expected=result.clone
+    assert(source.fixed_filter(result,CAM_GAUSSIAN_7x7))
+    expected_gaussian=result.clone
+    # band parallel processing must give the same images
+    assert_equal(4,camSetNumThreads(4))
+    assert_equal(sum,source.morpho_gradient_circle5(result))
+    assert_equal(0,result.arithm(expected,result,CAM_ARITHM_ABSDIFF))
+    assert(source.fixed_filter(result,CAM_GAUSSIAN_7x7))
+    assert_equal(0,result.arithm(expected_gaussian,result,CAM_ARITHM_ABSDIFF))
+    assert_equal(1,camSetNumThreads(1))
+  end
+
+  def test_morpho_rect
+    source=CamImage.new
+    result=CamImage.new
+    source.load_pgm("resources/chess.pgm")
+    # a 3x3 rectangle is the 3x3 square
+    source.erode_square3(result)
+    expected=result.clone
+    source.erode_rect(result,3,3)
+    assert_equal(0,result.arithm(expected,result,CAM_ARITHM_ABSDIFF))
+    # a constant image remains constant, whatever the size of the structuring element
+    source.set!(10)
+    assert_equal(10*source.width*source.height,source.close_rect(result,31,17))
+    assert_equal(0,source.top_hat_rect(result,8,8))
+    assert_equal(10*source.width*source.height,source.alternating_sequential_filter_rect(result,3))
+    # with a constant border, the opening goes above the source near the border : the top-hats must not wrap
+    source.set_border(CAM_BORDER_CONSTANT,255)
+    assert_equal(0,source.top_hat_rect(result,8,8))
+    source.set_border(CAM_BORDER_CONSTANT,0)
+    assert_equal(0,source.black_top_hat_rect(result,8,8))
+    zero=source.clone
+    zero.set!(0)
+    assert_equal(0,result.arithm(zero,result,CAM_ARITHM_ABSDIFF))
+  end
+
+  def test_alternating_sequential_filter_rect
+    source=CamImage.new
+    result=CamImage.new
+    source.load_pgm("resources/chess.pgm")
+    sums=[0,1].collect do |closing_first|
+      # the explicit sequence of openings and closings by 3x3, 5x5 and 7x7 squares
+      expected=source.clone
+      sum=0
+      [3,5,7].each do |size|
+        if closing_first==1
+          expected.close_rect!(size,size)
+          sum=expected.open_rect!(size,size)
+        else
+          expected.open_rect!(size,size)
+          sum=expected.close_rect!(size,size)
+        end
+      end
+      assert_equal(sum,source.alternating_sequential_filter_rect(result,3,closing_first))
+      assert_equal(0,result.arithm(expected,result,CAM_ARITHM_ABSDIFF))
+      sum
+    end
+    # the order of the openings and closings matters
+    assert_not_equal(sums[0],sums[1])
+  end
+
+  def test_median_filter
+    source=CamImage.new
+    result=CamImage.new
+    expected=CamImage.new
+    source.load_pgm("resources/chess.pgm")
+    # the image only points to its ROI, which is kept in a variable
+    roi=CamROI.new(0,16,16,source.width-32,source.height-32)
+    source.set_roi(roi)
+    # the NxN filter gives the same result as the 3x3 and 5x5 filters
+    assert(source.median_filter_3x3(expected))
+    assert(source.median_filter(result,3))
+    assert_equal(0,result.arithm(expected,result,CAM_ARITHM_ABSDIFF))
+    assert(source.median_filter_5x5(expected))
+    assert(source.median_filter(result,5))
+    assert_equal(0,result.arithm(expected,result,CAM_ARITHM_ABSDIFF))
+    # a larger neighbourhood, against a naive median of each pixel
+    size=9
+    half=size/2
+    naive_roi=CamROI.new(0,20,20,40,30)
+    source.set_roi(naive_roi)
+    result=CamImage.new
+    assert(source.median_filter(result,size))
+    pixels=source.to_s.unpack('C*')
+    filtered=result.to_s.unpack('C*')
+    errors=0
+    (0...30).each do |y|
+      (0...40).each do |x|
+        values=[]
+        (-half..half).each {|j| (-half..half).each {|i| values << pixels[(20+y+j)*source.widthStep+20+x+i]}}
+        errors+=1 if values.sort[values.size/2]!=filtered[y*result.widthStep+x]
+      end
+    end
+    assert_equal(0,errors)
+  end
+
+  def test_morpho_rect_binary
+    source=CamImage.new
+    source.load_pgm("resources/chess.pgm")
+    binary=CamImage.new(source.width,source.height,CAM_DEPTH_1U)
+    result=CamImage.new(source.width,source.height,CAM_DEPTH_1U)
+    source.threshold(binary,128)
+    # on binary images, the accumulator is the number of pixels set
+    n=binary.erode_rect(result,1,1)
+    eroded=binary.erode_rect(result,15,9)
+    dilated=binary.dilate_rect(result,15,9)
+    assert(eroded<=n)
+    assert(dilated>=n)
+    assert_equal(dilated-eroded,binary.morpho_gradient_rect(result,15,9))
+  end
+
+  def test_simd
+    source=CamImage.new
+    result=CamImage.new
+    source.load_pgm("resources/chess.pgm")
+    kernel=CamLinearFilterKernel.new
+    [[1,2,1],[0,0,0],[-1,-2,-1]].each_with_index {|l,y| l.each_with_index {|v,x| kernel.set(x,y,v)}}
+    sep_kernel=CamSepFilterKernel.new
+    [1,6,15,20,15,6,1].each_with_index {|v,i| sep_kernel.set_x(i,v); sep_kernel.set_y(i,v)}
+    sep_kernel.coeff2=12
+    features=camGetCPUFeatures
+    # C code
+    assert_equal(0,camSetCPUFeatures(0))
+    sum=source.linear_filter_abs_3x3(result,kernel)
+    expected=result.clone
+    sep_sum=source.sep_filter_7x7(result,sep_kernel)
+    sep_expected=result.clone
+    # the SIMD code path (if any) must give the same result
+    assert_equal(features,camSetCPUFeatures(features))
+    assert_equal(sum,source.linear_filter_abs_3x3(result,kernel))
+    assert_equal(0,result.arithm(expected,result,CAM_ARITHM_ABSDIFF))
+    assert_equal(sep_sum,source.sep_filter_7x7(result,sep_kernel))
+    assert_equal(0,result.arithm(sep_expected,result,CAM_ARITHM_ABSDIFF))
+  end
 end
@@ -4,6 +4,28 @@ require 'gnuplot'
 
 class TestKeypoints < Test::Unit::TestCase
 
+  # Keypoints of the 15 normal faces of the Yale database (the id of subject i is first_id + i)
+  # Each test gets its own models, as they may be quantized or renumbered
+  def yale_models(threshold, first_id = 0)
+    (1..15).collect do |i|
+      image = CamImage.new
+      image.load_pgm("resources/yalefaces/subject#{'%02d' % i}.normal.pgm")
+      points = CamKeypoints.new(10000)
+      points.id = first_id + i
+      image.fast_hessian_detector(points, threshold, CAM_UPRIGHT)
+      points
+    end
+  end
+
+  # Keypoints of a face of the Yale database (e.g. "subject07.surprised")
+  def yale_target(name, threshold)
+    image = CamImage.new
+    image.load_pgm("resources/yalefaces/#{name}.pgm")
+    points = CamKeypoints.new(10000)
+    image.fast_hessian_detector(points, threshold, CAM_UPRIGHT)
+    points
+  end
+
   def test_keypoints_scale
 
     puts "Keypoints detection :"
@@ -101,4 +123,173 @@ class TestKeypoints < Test::Unit::TestCase
 
   end
 
+  def test_keypoints_quantized
+
+    threshold = 100
+    models = yale_models(threshold)
+
+    targets = ["happy", "glasses", "sad"].collect { |feature| yale_target("subject04.#{feature}", threshold) }
+
+    # Brute force matching with the original descriptors, then with the 8-bit and 16-bit ones
+    matches = CamKeypointsMatches.new
+    reference = targets.collect { |points| points.matching(models, matches) }
+    [CAM_DEPTH_8U, CAM_DEPTH_16S].each do |depth|
+      models.each do |points|
+        assert(points.quantize(depth))
+        assert_equal(depth, points.qdepth)
+        assert_equal(points.nb_points, points.qnbPoints)
+      end
+      results = targets.collect { |points| points.matching(models, matches) }
+      puts "Best matches with quantized descriptors (depth #{depth & 0xff}) : #{results.join(' ')} (#{reference.join(' ')})"
+      assert_equal(reference, results)
+    end
+
+    # The kdTree uses the quantized descriptors of the models as well
+    kdTree = CamKeypointsKdTree.new(models)
+    targets.each do |points|
+      assert_equal(4, points.matchingKdTree(kdTree, matches, 100))
+    end
+    models.each do |points|
+      assert(points.quantize(0))
+      assert_equal(0, points.qdepth)
+    end
+
+    # Detecting the keypoints again makes the quantized descriptors outdated
+    image = CamImage.new
+    image.load_pgm("resources/yalefaces/subject01.normal.pgm")
+    points = models[0]
+    assert(points.quantize(CAM_DEPTH_8U))
+    assert(image.harris(points))
+    assert_equal(0, points.qnbPoints)
+    assert(points.quantize(CAM_DEPTH_8U))
+    image.fast_hessian_detector(points, threshold, CAM_UPRIGHT)
+    assert_equal(0, points.qnbPoints)
+
+  end
+
+  def test_keypoints_database
+
+    threshold = 100
+    models = yale_models(threshold)
+    target = yale_target("subject07.surprised", threshold)
+
+    # The compiled database gives the same matches as the brute force matching
+    matches = CamKeypointsMatches.new
+    reference = target.matching(models, matches)
+    nb_matches = matches.nb_matches
+    db = CamKeypointsDatabase.new(models, CAM_DEPTH_32S)
+    assert_equal(models.inject(0) { |sum, points| sum + points.nb_points }, db.nbPoints)
+    assert_equal(reference, target.matchingDatabase(db, matches))
+    assert_equal(nb_matches, matches.nb_matches)
+
+    # Quantized databases give the same matches as the quantized models
+    [CAM_DEPTH_8U, CAM_DEPTH_16S].each do |depth|
+      models.each { |points| points.quantize(depth) }
+      reference = target.matching(models, matches)
+      nb_matches = matches.nb_matches
+      assert(db.compile(models, depth))
+      assert_equal(reference, target.matchingDatabase(db, matches))
+      assert_equal(nb_matches, matches.nb_matches)
+      puts "Best match with a #{depth & 0xff}-bit database : #{reference} (#{nb_matches})"
+    end
+
+  end
+
+  def test_keypoints_matching_threads
+
+    threshold = 100
+    models = yale_models(threshold, 1000) # Ids are no more limited to 256
+    target = yale_target("subject07.surprised", threshold)
+
+    matches = CamKeypointsMatches.new
+    reference = target.matching(models, matches)
+    nb_matches = matches.nb_matches
+    assert_equal(1007, reference)
+
+    # The same matches are found with several threads
+    assert_equal(4,camSetNumThreads(4))
+    assert_equal(reference, target.matching(models, matches))
+    assert_equal(nb_matches, matches.nb_matches)
+    db = CamKeypointsDatabase.new(models, CAM_DEPTH_32S)
+    assert_equal(reference, target.matchingDatabase(db, matches))
+    assert_equal(nb_matches, matches.nb_matches)
+    assert_equal(1,camSetNumThreads(1))
+
+  end
+
+  def test_keypoints_matching_large_ids
+
+    threshold = 100
+    models = yale_models(threshold)
+    # Sparse ids, up to the largest int : the votes do not depend on their values
+    models.each_with_index { |points, i| points.id = (i + 1) * 1000000 }
+    models[14].id = 2147483647
+    target = yale_target("subject07.surprised", threshold)
+
+    matches = CamKeypointsMatches.new
+    assert_equal(7000000, target.matching(models, matches))
+    nb_matches = matches.nb_matches
+    db = CamKeypointsDatabase.new(models, CAM_DEPTH_8U)
+    assert_equal(7000000, target.matchingDatabase(db, matches))
+    index = CamKeypointsIndex.new(db, 4)
+    assert_equal(7000000, target.matchingIndex(index, matches, db.nbPoints))
+    kdTree = CamKeypointsKdTree.new(models)
+    assert_equal(7000000, target.matchingKdTree(kdTree, matches, 100))
+
+    # The model with the largest id is recognized as well
+    target = yale_target("subject15.happy", threshold)
+    assert_equal(2147483647, target.matching(models, matches))
+    assert_equal(2147483647, target.matchingDatabase(db, matches))
+
+  end
+
+  def test_keypoints_index
+
+    threshold = 100
+    models = yale_models(threshold)
+    target = yale_target("subject07.surprised", threshold)
+
+    db = CamKeypointsDatabase.new(models, CAM_DEPTH_8U)
+    index = CamKeypointsIndex.new(db, 4)
+    assert_equal(4, index.nbTrees)
+
+    # With as many checks as rows, the search is exact
+    matches = CamKeypointsMatches.new
+    reference = target.matchingDatabase(db, matches)
+    nb_matches = matches.nb_matches
+    assert_equal(reference, target.matchingIndex(index, matches, db.nbPoints))
+    assert_equal(nb_matches, matches.nb_matches)
+
+    # A few checks are enough to recognize the face
+    best = target.matchingIndex(index, matches, 128)
+    assert_equal(7, best)
+    puts "Best match with 128 checks : #{best} (#{matches.nb_matches} / #{nb_matches})"
+
+  end
+
+  def test_keypoints_database_file
+
+    threshold = 100
+    models = yale_models(threshold)
+    target = yale_target("subject07.surprised", threshold)
+
+    db = CamKeypointsDatabase.new(models, CAM_DEPTH_8U)
+    index = CamKeypointsIndex.new(db, 4)
+    assert(db.save("output/keypoints.db", index))
+    matches = CamKeypointsMatches.new
+    reference = target.matchingIndex(index, matches, 128)
+    nb_matches = matches.nb_matches
+
+    # The mapped database and index give the same results
+    mapped_db = CamKeypointsDatabase.new
+    mapped_index = CamKeypointsIndex.new
+    assert(mapped_db.map("output/keypoints.db", mapped_index))
+    assert_equal(db.nbPoints, mapped_db.nbPoints)
+    assert_equal(4, mapped_index.nbTrees)
+    assert_equal(reference, target.matchingIndex(mapped_index, matches, 128))
+    assert_equal(nb_matches, matches.nb_matches)
+    assert_equal(7, target.matchingDatabase(mapped_db, matches))
+
+  end
+
 end
@@ -26,4 +26,225 @@ class TestLabeling < Test::Unit::TestCase
     assert_equal(sorted[0].cy,128)
     assert_equal(sorted[0].surface,601)
   end
+
+  def test_many_blobs
+    # more blobs than the initial capacity of CamBlobs (CAM_LABEL_MAX_BLOBS)
+    image=CamImage.new(200,100)
+    image.set!(0)
+    (0...100).step(2) {|y| (0...200).step(2) {|x| image.draw_rectangle(x,y,x,y,255)}}
+    blobs=image.encode_threshold(128).labeling!
+    assert_equal(5000,blobs.nb_blobs)
+    assert(blobs.capacity>=5000)
+    assert_equal(1,blobs[4999].surface)
+  end
+
+  def test_many_runs
+    # 256 one pixel wide vertical stripes : 131073 runs, more than a 16 bits run index can address
+    image=CamImage.new(512,256)
+    image.set!(0)
+    (0...512).step(2) {|x| image.draw_line(x,0,x,255,255)}
+    rle=image.encode_threshold(128)
+    assert_equal(131073,rle.nb_runs)
+    blobs=CamBlobs.new
+    if CAM_RLE_MAX_INDEX>65535
+      # compiled with CAM_RLE_32BITS
+      assert(rle.labeling!(blobs))
+      assert_equal(256,blobs.nb_blobs)
+      assert_equal(256,blobs[255].surface)
+    else
+      # the overflow must be reported, not silently corrupt the runs
+      assert_raise(RuntimeError) {rle.labeling!(blobs)}
+      assert_equal(0,blobs.nb_blobs)
+    end
+  end
+
+  def test_threads
+    image=CamImage.new
+    image.load_bmp("resources/alfa156.bmp")
+    yuv=image.to_yuv
+    yuv.set_roi(CamROI.new(yuv,3))
+    serial=yuv.encode_threshold(150).labeling!
+    # labeling by strips must give the same blobs, in the same order
+    assert_equal(4,camSetNumThreads(4))
+    parallel=yuv.encode_threshold(150).labeling!
+    assert_equal(1,camSetNumThreads(1))
+    assert_equal(serial.nb_blobs,parallel.nb_blobs)
+    serial.each_with_index do |b,i|
+      p=parallel[i]
+      assert_equal([b.left,b.top,b.width,b.height,b.surface,b.cx,b.cy],[p.left,p.top,p.width,p.height,p.surface,p.cx,p.cy])
+    end
+  end
+
+  def test_encode_simd
+    # the SIMD encoder only runs on single-channel images without COI, 8 or 16 bits. The widths are
+    # not multiples of 32, so that every line ends with a partial vector
+    features=camGetCPUFeatures
+    lut=CamTable.new(4096)
+    (0...4096).each {|i| lut[i]=(i/7)%5}
+    srand(1)
+    [[CAM_DEPTH_8U,1,'C*',256],[CAM_DEPTH_16U,2,'S*',4096]].each do |depth,size,format,range|
+      [45,77].each do |width|
+        image=CamImage.new(width,20,depth)
+        # runs of random values and lengths, crossing the 32 pixels boundaries
+        pixels=(0...20).collect do |y|
+          line=[]
+          line+=[rand(range)]*(1+rand(40)) while line.size<width
+          line[0,width]+[0]*(image.widthStep/size-width)
+        end
+        image.set_pixels(pixels.flatten.pack(format))
+        encoders=[
+          lambda {image.encode_threshold(range/2)},
+          lambda {image.encode_threshold_inv(range/2)},
+          lambda {image.encode_lut(lut)}]
+        encoders.each do |encode|
+          # C code
+          assert_equal(0,camSetCPUFeatures(0))
+          encoded=encode.call
+          # the SIMD code path (if any) must give the same runs
+          assert_equal(features,camSetCPUFeatures(features))
+          simd=encode.call
+          assert_equal(encoded.nb_runs,simd.nb_runs)
+          (0...encoded.nb_runs).each do |i|
+            a,b=encoded[i],simd[i]
+            assert_equal([a.value,a.length,a.line,a.blob],[b.value,b.length,b.line,b.blob])
+          end
+        end
+      end
+    end
+  end
+
+  def test_moments
+    # a 20x10 frame, 2 pixels thick : one hole
+    image=CamImage.new(40,30)
+    image.set!(0)
+    image.draw_rectangle(10,10,29,19,255)
+    image.draw_rectangle(11,11,28,18,255)
+    blobs=CamBlobs.new
+    blobs.features=CAM_BLOB_MOMENTS
+    image.encode_threshold(128).labeling!(blobs)
+    assert_equal(1,blobs.nb_blobs)
+    b=blobs[0]
+    assert_equal(0,b.euler)
+    assert_equal(2*(20+10)+2*(16+6),b.perimeter)
+    assert_in_delta(0,b.orientation,1e-6)
+    assert(b.major>b.minor)
+    # same features with the single-pass labeling
+    fused=CamBlobs.new
+    fused.features=CAM_BLOB_MOMENTS
+    image.labeling_threshold(fused,128)
+    assert_equal([b.perimeter,b.euler],[fused[0].perimeter,fused[0].euler])
+    assert_in_delta(b.mu20,fused[0].mu20,1e-3)
+  end
+
+  def test_labeling_stream
+    image=CamImage.new
+    image.load_bmp("resources/alfa156.bmp")
+    yuv=image.to_yuv
+    roi=CamROI.new(yuv,3)
+    yuv.set_roi(roi)
+    blobs=yuv.labeling_threshold(150)
+    # the same image, delivered by chunks of 10 rows
+    stream=CamRLELabelingStream.new(yuv.width)
+    closed=CamBlobs.new
+    nb=0
+    surface=0
+    rows=nil
+    (0...yuv.height).step(10) do |y|
+      rows=CamROI.new(3,0,y,yuv.width,[10,yuv.height-y].min)
+      yuv.set_roi(rows)
+      assert(stream.threshold(yuv,150,closed))
+      closed.each {|b| assert(b.top+b.height<=y+10); nb+=1; surface+=b.surface}
+    end
+    assert_equal(yuv.height,stream.y)
+    assert_equal(nb,stream.nb_blobs)
+    assert(stream.end(closed))
+    closed.each {|b| nb+=1; surface+=b.surface}
+    assert_equal(blobs.nb_blobs,nb)
+    assert_equal(blobs.inject(0) {|s,b| s+b.surface},surface)
+  end
+
+  def test_labeling_threshold
+    image=CamImage.new
+    image.load_bmp("resources/alfa156.bmp")
+    yuv=image.to_yuv
+    yuv.set_roi(CamROI.new(yuv,3))
+    blobs=yuv.encode_threshold(150).labeling!
+    # single pass threshold + labeling + measures on the V plane
+    fused=yuv.labeling_threshold(150,yuv)
+    assert_equal(blobs.nb_blobs,fused.nb_blobs)
+    blobs.each_with_index do |b,i|
+      f=fused[i]
+      assert_equal([b.left,b.top,b.width,b.height,b.surface,b.cx,b.cy],[f.left,f.top,f.width,f.height,f.surface,f.cx,f.cy])
+      assert(f.min>=150)
+      assert(f.min<=f.value && f.value<=f.max)
+    end
+    # measured on a horizontal ramp, the min and max of a blob are given by its left and right sides
+    ramp=CamImage.new(yuv.width,yuv.height)
+    ramp.set_pixels(((0...ramp.widthStep).collect {|x| x/2}.pack('C*'))*ramp.height)
+    fused=yuv.labeling_threshold(150,ramp)
+    blobs.each_with_index do |b,i|
+      assert_equal([b.left/2,(b.left+b.width-1)/2],[fused[i].min,fused[i].max])
+    end
+  end
+
+  def test_rle_morpho_rect
+    image=CamImage.new
+    image.load_bmp("resources/alfa156.bmp")
+    yuv=image.to_yuv
+    yuv.set_roi(CamROI.new(yuv,3))
+    surface=lambda {|rle| rle.labeling!.inject(0) {|s,b| s+b.surface}}
+    n=surface.call(yuv.encode_threshold(150))
+    assert_equal(n,surface.call(yuv.encode_threshold(150).erode_rect(1,1)))
+    eroded=surface.call(yuv.encode_threshold(150).erode_rect(5,3))
+    opened=surface.call(yuv.encode_threshold(150).open_rect(5,3))
+    closed=surface.call(yuv.encode_threshold(150).close_rect(5,3))
+    dilated=surface.call(yuv.encode_threshold(150).dilate_rect(5,3))
+    assert(eroded<=opened && opened<=n && n<=closed && closed<=dilated)
+    assert(eroded<n && n<dilated)
+  end
+
+  def test_rle_arithm
+    image=CamImage.new
+    image.load_bmp("resources/alfa156.bmp")
+    yuv=image.to_yuv
+    yuv.set_roi(CamROI.new(yuv,3))
+    a=yuv.encode_threshold(150)
+    b=yuv.encode_threshold(170)
+    na=a.population_count
+    nb=b.population_count
+    assert(nb<=na)
+    # b is included in a
+    assert_equal(nb,a.arithm(b,CAM_RLE_AND).population_count)
+    assert_equal(na,a.arithm(b,CAM_RLE_OR).population_count)
+    assert_equal(na-nb,a.arithm(b,CAM_RLE_XOR).population_count)
+    assert_equal(na-nb,a.arithm(b,CAM_RLE_ANDNOT).population_count)
+    assert_equal(0,b.arithm(a,CAM_RLE_DIFF).population_count)
+    box=CamROI.new
+    assert_equal(na,a.bounding_box(box))
+    blobs=a.labeling!
+    assert_equal(blobs.map {|x| x.left}.min,box.xOffset)
+    assert_equal(blobs.map {|x| x.top}.min,box.yOffset)
+    assert_equal(blobs.map {|x| x.left+x.width}.max,box.xOffset+box.width)
+    assert_equal(blobs.map {|x| x.top+x.height}.max,box.yOffset+box.height)
+  end
+
+  def test_labeling_union_find
+    image=CamImage.new
+    image.load_bmp("resources/alfa156.bmp")
+    yuv=image.to_yuv
+    yuv.set_roi(CamROI.new(yuv,3))
+    binary=CamImage.new(yuv.width,yuv.height,CAM_DEPTH_8U)
+    yuv.threshold(binary,150)
+    blobs=yuv.encode_threshold(150).labeling!
+    # pixel-based labeling of the thresholded image, with a label image
+    labels=CamImage.new(yuv.width,yuv.height,CAM_DEPTH_32S)
+    pixels=binary.labeling(labels)
+    assert_equal(blobs.nb_blobs,pixels.nb_blobs)
+    blobs.each_with_index do |b,i|
+      p=pixels[i]
+      assert_equal([b.left,b.top,b.width,b.height,b.surface,b.cx,b.cy],[p.left,p.top,p.width,p.height,p.surface,p.cx,p.cy])
+    end
+    # 8-connectedness can only merge blobs
+    assert(binary.labeling(nil,8).nb_blobs<=pixels.nb_blobs)
+  end
 end